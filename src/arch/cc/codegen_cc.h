@@ -104,9 +104,16 @@ public:
     // bundle_start: clear groupInfo, which maintains the work that needs to be performed for bundle
     void bundle_start(std::string cmnt)
     {
-        // empty the matrix of signal values
-        size_t slotsUsed = ccSetup["slots"].size();
-        groupInfo.assign(slotsUsed, std::vector<tGroupInfo>(MAX_GROUPS, {"", 0, -1}));
+        // empty the signal values used by the previous bundle. NB: we only touch the slots actually used
+        for(int slotIdx : slotsUsed) {
+            for(size_t group=0; group<MAX_GROUPS; group++) {
+                if(groupsUsed[slotIdx] & (1U<<group)) {
+                    groupInfo[slotIdx][group] = {-1, 0, -1};
+                }
+            }
+            groupsUsed[slotIdx] = 0;
+        }
+        slotsUsed.clear();
 
         comment(cmnt);
     }
@@ -118,133 +125,100 @@ public:
             comment(SS2S(" # last bundle, will pad outputs to match durations"));
         }
 
-        const json &ccSetupSlots = ccSetup["slots"];
-        for(size_t slotIdx=0; slotIdx<groupInfo.size(); slotIdx++) {            // iterate over slot vector
-            // collect info from JSON
-            const json &ccSetupSlot = ccSetupSlots[slotIdx];
-            const json &instrument = ccSetupSlot["instrument"];
-            std::string instrumentName = instrument["name"];
-            int slot = ccSetupSlot["slot"];
+        // determine the slots to visit: the ones used, in slot order, or all of them if we need to pad
+        std::vector<int> slotsToVisit;
+        if(isLastBundle) {
+            for(size_t slotIdx=0; slotIdx<slotInfo.size(); slotIdx++) {
+                slotsToVisit.push_back(slotIdx);
+            }
+        } else {
+            slotsToVisit = slotsUsed;
+            std::sort(slotsToVisit.begin(), slotsToVisit.end());
+        }
+
+        for(int slotIdx : slotsToVisit) {
+            const tSlotInfo &si = slotInfo[slotIdx];
 
-            // collect info for all groups within slot, i.e. one connected instrummnt
-            bool isSlotUsed = false;
+            // collect info for all groups within slot, i.e. one connected instrument
             uint32_t digOut = 0;
             uint32_t digIn = 0;
             uint32_t slotDurationInCycles = 0;                                  // maximum duration over groups that are used
-            size_t nrGroups = groupInfo[slotIdx].size();
-            for(size_t group=0; group<nrGroups; group++) {                      // iterate over groups used within slot
-                if(groupInfo[slotIdx][group].signalValue != "") {
-                    isSlotUsed = true;
-
-                    // find control mode & bits
-                    std::string controlModeName = instrument["control_mode"];
-                    const json &controlMode = controlModes[controlModeName];    // the control mode definition for our instrument
-                    const json &controlBits = controlMode["control_bits"][group];
-
-                    // find or create codeword/mask fragment for this group
-                    DOUT("instrumentName=" << instrumentName <<
-                         ", slot=" << slot <<
-                         ", group=" << group <<
-                         ", control bits: " << controlBits);
-                    size_t nrControlBits = controlBits.size();
-                    if(nrControlBits == 1) {      // single bit, implying this is a mask (not code word)
-                        digOut |= 1<<(int)controlBits[0];     // NB: we assume the mask is active high, which is correct for VSM and UHF-QC
-                    } else {                // > 1 bit, implying code word
-                        // FIXME allow single code word for vector of groups
-                        // try to find code word
-                        uint32_t codeWord = 0;
-                        std::string signalValue = groupInfo[slotIdx][group].signalValue;
-
-                        if(JSON_EXISTS(codewordTable, instrumentName) &&                    // instrument exists
-                                        codewordTable[instrumentName].size() > group) {     // group exists
-                            bool cwFound = false;
-                            // try to find signalValue
-                            json &myCodewordArray = codewordTable[instrumentName][group];
-                            for(codeWord=0; codeWord<myCodewordArray.size() && !cwFound; codeWord++) {   // NB: JSON find() doesn't work for arrays
-                                if(myCodewordArray[codeWord] == signalValue) {
-                                    DOUT("signal value found at cw=" << codeWord);
-                                    cwFound = true;
-                                }
-                            }
-                            if(!cwFound) {
-                                DOUT("signal value '" << signalValue << "' not found in group " << group << ", which contains " << myCodewordArray);
-                                // NB: codeWord already contains last used value + 1
-                                // FIXME: check that number is available
-                                myCodewordArray[codeWord] = signalValue;                    // NB: structure created on demand
-                            }
-                        } else {    // new instrument or group
-                            codeWord = 1;
-                            codewordTable[instrumentName][group][0] = "";                   // code word 0 is empty
-                            codewordTable[instrumentName][group][codeWord] = signalValue;   // NB: structure created on demand
-                        }
-
-                        // convert codeWord to digOut
-                        for(size_t idx=0; idx<nrControlBits; idx++) {
-                            int codeWordBit = nrControlBits-1-idx;    // controlBits defines MSB..LSB
-                            if(codeWord & (1<<codeWordBit)) digOut |= 1<<(int)controlBits[idx];
-                        }
+            for(size_t group=0; group<MAX_GROUPS; group++) {                    // iterate over groups used within slot
+                if(!(groupsUsed[slotIdx] & (1U<<group))) continue;
+                const tGroupInfo &gi = groupInfo[slotIdx][group];
+
+                // find control bits
+                if(group >= si.controlBits.size()) {
+                    FATAL("JSON key '" << si.controlModeName << "/control_bits' does not define group " << group <<
+                          " used by instrument '" << si.instrumentName << "'");
+                }
+                const std::vector<int> &controlBits = si.controlBits[group];
+
+                // find or create codeword/mask fragment for this group
+                DOUT("instrumentName=" << si.instrumentName <<
+                     ", slot=" << si.slot <<
+                     ", group=" << group <<
+                     ", control bits: " << ql::utils::to_string(controlBits));
+                size_t nrControlBits = controlBits.size();
+                if(nrControlBits == 1) {      // single bit, implying this is a mask (not code word)
+                    digOut |= 1<<controlBits[0];     // NB: we assume the mask is active high, which is correct for VSM and UHF-QC
+                } else {                // > 1 bit, implying code word
+                    // FIXME allow single code word for vector of groups
+                    uint32_t codeWord = assignCodeword(slotIdx, group, gi.signalValueId);
+
+                    // convert codeWord to digOut
+                    for(size_t idx=0; idx<nrControlBits; idx++) {
+                        int codeWordBit = nrControlBits-1-idx;    // controlBits defines MSB..LSB
+                        if(codeWord & (1<<codeWordBit)) digOut |= 1<<controlBits[idx];
                     }
+                }
 
-                    // add trigger to digOut
-                    size_t nrTriggerBits = controlMode["trigger_bits"].size();
-                    if(nrTriggerBits == 0) {         // no trigger
-                        // do nothing
-                    } else if(nrTriggerBits == 1) {  // single trigger for all groups
-                        digOut |= 1 << (int)controlMode["trigger_bits"][0];
-                    } else {                        // trigger per group
-                        digOut |= 1 << (int)controlMode["trigger_bits"][group];
-                        // FIXME: check validity of nrTriggerBits
-                    }
+                // add trigger to digOut
+                size_t nrTriggerBits = si.triggerBits.size();
+                if(nrTriggerBits == 0) {         // no trigger
+                    // do nothing
+                } else if(nrTriggerBits == 1) {  // single trigger for all groups
+                    digOut |= 1 << si.triggerBits[0];
+                } else {                        // trigger per group
+                    digOut |= 1 << si.triggerBits[group];
+                    // FIXME: check validity of nrTriggerBits
+                }
 
-                    // compute slot duration
-                    size_t durationInCycles = groupInfo[slotIdx][group].duration / 20;   // FIXME: cycle time
-                    if(durationInCycles > slotDurationInCycles) slotDurationInCycles = durationInCycles;
-
-                    // handle readout
-                    // NB: this does not allow for readout without signal generation (by the same instrument), which might be needed in the future
-                    // FIXME: move out of this loop
-                    // FIXME: test for groupInfo[slotIdx][group].readoutCop >= 0
-                    if(JSON_EXISTS(controlMode, "result_bits")) {                               // this instrument mode produces results
-                        const json &resultBits = controlMode["result_bits"][group];
-                        size_t nrResultBits = resultBits.size();
-                        if(nrResultBits == 1) {                     // single bit
-                            digIn |= 1<<(int)resultBits[0];         // NB: we assume the result is active high, which is correct for UHF-QC
-
-#if 0
-                            // FIXME: save groupInfo[slotIdx][group].readoutCop in inputLut
-                            if(JSON_EXISTS(inputLutTable, instrumentName) &&                    // instrument exists
-                                            inputLutTable[instrumentName].size() > group) {     // group exists
-                            } else {    // new instrument or group
-                                codeWord = 1;
-                                inputLutTable[instrumentName][group][0] = "";                   // code word 0 is empty
-                                inputLutTable[instrumentName][group][codeWord] = signalValue;   // NB: structure created on demand
-                            }
-#endif
-                        } else {    // NB: nrResultBits==0 will not arrive at this point
-                            std::string controlModeName = controlMode;                          // convert to string
-                            FATAL("JSON key '" << controlModeName << "/result_bits' must have 1 bit per group");
-                        }
+                // compute slot duration
+                size_t durationInCycles = gi.duration / 20;   // FIXME: cycle time
+                if(durationInCycles > slotDurationInCycles) slotDurationInCycles = durationInCycles;
+
+                // handle readout
+                // NB: this does not allow for readout without signal generation (by the same instrument), which might be needed in the future
+                // FIXME: test for gi.readoutCop >= 0
+                if(si.hasResultBits) {                                              // this instrument mode produces results
+                    const std::vector<int> &resultBits = si.resultBits[group];
+                    if(resultBits.size() == 1) {                // single bit
+                        digIn |= 1<<resultBits[0];              // NB: we assume the result is active high, which is correct for UHF-QC
+                        // FIXME: save gi.readoutCop in inputLutTable
+                    } else {    // NB: nrResultBits==0 will not arrive at this point
+                        FATAL("JSON key '" << si.controlModeName << "/result_bits' must have 1 bit per group");
                     }
-                } // if signal defined
+                }
             } // for group
 
 
             // generate code for slot
-            if(isSlotUsed) {
-                DOUT("bundle_finish(): slot=" << slot <<
+            if(groupsUsed[slotIdx]) {
+                DOUT("bundle_finish(): slot=" << si.slot <<
                      ", lastStartCycle[slotIdx]=" << lastStartCycle[slotIdx] <<
                      ", start_cycle=" << start_cycle <<
                      ", slotDurationInCycles=" << slotDurationInCycles <<
-                     ", instrumentName=" << instrumentName);
+                     ", instrumentName=" << si.instrumentName);
 
-                padToCycle(lastStartCycle[slotIdx], start_cycle, slot, instrumentName);
+                padToCycle(lastStartCycle[slotIdx], start_cycle, si.slot, si.instrumentName);
 
                 // emit code for slot
                 emit("", "seq_out",
-                     SS2S(slot <<
+                     SS2S(si.slot <<
                           ",0x" << std::hex << std::setfill('0') << std::setw(8) << digOut << std::dec <<
                           "," << slotDurationInCycles),
-                     SS2S("# cycle " << start_cycle << "-" << start_cycle+slotDurationInCycles << ": code word/mask on '" << instrumentName+"'").c_str());
+                     SS2S("# cycle " << start_cycle << "-" << start_cycle+slotDurationInCycles << ": code word/mask on '" << si.instrumentName+"'").c_str());
 
                 // update lastStartCycle
                 lastStartCycle[slotIdx] = start_cycle + slotDurationInCycles;
@@ -263,7 +237,7 @@ public:
 
             // pad end of bundle to align durations
             if(isLastBundle) {
-                padToCycle(lastStartCycle[slotIdx], start_cycle+duration_in_cycles, slot, instrumentName);
+                padToCycle(lastStartCycle[slotIdx], start_cycle+duration_in_cycles, si.slot, si.instrumentName);
             }
         } // for(slotIdx)
 
@@ -288,16 +262,14 @@ public:
             DOUT("iname=" << iname << ", angle=" << angle);
         }
 #endif
-        bool isReadout = false;
+        const tInstructionInfo &ii = findInstructionInfo(iname, platform);
 
-        if("readout" == platform.find_instruction_type(iname))          // handle readout
+        if(ii.isReadout)                                                // handle readout
         /* FIXME: we only use the "readout" instruction_type and don't care about the rest because the terms "mw" and "flux" don't fully
          * cover gate functionality. It would be nice if custom gates could mimic ql::gate_type_t
          * We could also infer readout from cops/qops.size()
         */
         {
-            isReadout = true;
-
             if(cops.size() != 1) {
                 FATAL("Readout instruction requires exactly 1 classical operand, not " << cops.size());
                 // FIXME: CClight also seems to support nCoperands=0
@@ -319,77 +291,55 @@ public:
             comment(cmnt.str());
         }
 
-        // find signal definition for iname
-        const json &instruction = platform.find_instruction(iname);
-        const json *tmp;
-        if(JSON_EXISTS(instruction["cc"], "signal_ref")) {
-            std::string signalRef = instruction["cc"]["signal_ref"];
-            tmp = &signals[signalRef];  // poor man's JSON pointer
-            if(tmp->size() == 0) {
-                FATAL("Error in JSON definition of instruction '" << iname <<
-                      "': signal_ref '" << signalRef << "' does not resolve");
-            }
-        } else {
-            tmp = &instruction["cc"]["signal"];
-            DOUT("signal for '" << instruction << "': " << *tmp);
-        }
-        const json &signal = *tmp;
-
         // iterate over signals defined in instruction
-        for(size_t s=0; s<signal.size(); s++) {
+        for(const tInstructionSignal &is : ii.signals) {
             // get the qubit to work on
-            size_t operandIdx = signal[s]["operand_idx"];
-            if(operandIdx >= qops.size()) {
+            if(is.operandIdx >= qops.size()) {
                 FATAL("Error in JSON definition of instruction '" << iname <<
-                      "': illegal operand number " << operandIdx <<
+                      "': illegal operand number " << is.operandIdx <<
                       "' exceeds expected maximum of " << qops.size()-1)
             }
-            size_t qubit = qops[operandIdx];
+            size_t qubit = qops[is.operandIdx];
 
             // get the instrument and group that generates the signal
-            std::string instructionSignalType = signal[s]["type"];
-            const json &instructionSignalValue = signal[s]["value"];
-            tSignalInfo si = findSignalInfoForQubit(instructionSignalType, qubit);
-            const json &ccSetupSlot = ccSetup["slots"][si.slotIdx];
-            std::string instrumentName = ccSetupSlot["instrument"]["name"];
-            int slot = ccSetupSlot["slot"];
-
-            // expand macros in signalValue
-            std::string signalValueString = SS2S(instructionSignalValue);   // serialize instructionSignalValue into std::string
-            replace(signalValueString, std::string("{gateName}"), iname);
-            replace(signalValueString, std::string("{instrumentName}"), instrumentName);
-            replace(signalValueString, std::string("{instrumentGroup}"), std::to_string(si.group));
-            replace(signalValueString, std::string("{qubit}"), std::to_string(qubit));
-
-            comment(SS2S("  # slot=" << slot <<
-                         ", group=" << si.group <<
-                         ", instrument='" << instrumentName <<
-                         "', signal='" << signalValueString << "'"));
+            if(qubit >= is.routes.size() || is.routes[qubit].slotIdx < 0) {
+                FATAL("No instruments found driving qubit " << qubit << " for signal type '" << is.signalType << "'");     // FIXME: clarify for user
+            }
+            const tSignalRoute &route = is.routes[qubit];
+            const tSlotInfo &si = slotInfo[route.slotIdx];
+
+            comment(SS2S("  # slot=" << si.slot <<
+                         ", group=" << route.group <<
+                         ", instrument='" << si.instrumentName <<
+                         "', signal='" << signalValues[route.signalValueId] << "'"));
 
             // check and store signal value
-            if(groupInfo[si.slotIdx][si.group].signalValue == "") {                         // not yet used
-                groupInfo[si.slotIdx][si.group].signalValue = signalValueString;
-            } else if(groupInfo[si.slotIdx][si.group].signalValue == signalValueString) {   // unchanged
+            tGroupInfo &gi = groupInfo[route.slotIdx][route.group];
+            if(gi.signalValueId < 0) {                                      // not yet used
+                gi.signalValueId = route.signalValueId;
+                if(groupsUsed[route.slotIdx] == 0) slotsUsed.push_back(route.slotIdx);
+                groupsUsed[route.slotIdx] |= 1U<<route.group;
+            } else if(gi.signalValueId == route.signalValueId) {            // unchanged
                 // do nothing
             } else {
                 EOUT("Code so far:\n" << cccode.str());                    // FIXME: provide context to help finding reason
-                FATAL("Signal conflict on instrument='" << instrumentName <<
-                      "', group=" << si.group <<
-                      ", between '" << groupInfo[si.slotIdx][si.group].signalValue <<
-                      "' and '" << signalValueString << "'");
+                FATAL("Signal conflict on instrument='" << si.instrumentName <<
+                      "', group=" << route.group <<
+                      ", between '" << signalValues[gi.signalValueId] <<
+                      "' and '" << signalValues[route.signalValueId] << "'");
             }
 
-            if(isReadout) {
+            if(ii.isReadout) {
                 // remind the classical operand used
-                groupInfo[si.slotIdx][si.group].readoutCop = cops[0];
+                gi.readoutCop = cops[0];
             }
 
-            groupInfo[si.slotIdx][si.group].duration = duration;
+            gi.duration = duration;
 
             DOUT("custom_gate(): iname='" << iname <<
                  "', duration=" << duration <<
-                 "[ns], si.slotIdx=" << si.slotIdx <<
-                 ", si.group=" << si.group);
+                 "[ns], slotIdx=" << route.slotIdx <<
+                 ", group=" << route.group);
 
             // NB: code is generated in bundle_finish()
         }   // for(signal)
@@ -460,15 +410,44 @@ private:
         int group;
     } tSignalInfo;
 
+    // information on a CC slot, extracted once from cc_setup["slots"] and the control mode of its instrument
+    typedef struct {
+        int slot;                                       // CC slot number
+        std::string instrumentName;
+        std::string controlModeName;
+        std::vector<std::vector<int>> controlBits;      // [group][bit], bits ordered MSB..LSB
+        std::vector<int> triggerBits;
+        bool hasResultBits;
+        std::vector<std::vector<int>> resultBits;       // [group][bit]
+    } tSlotInfo;
+
     typedef struct {
-        std::string signalValue;
+        int slotIdx;            // index into slotInfo, -1 if no instrument drives the qubit
+        int group;
+        int signalValueId;      // index into signalValues
+    } tSignalRoute;
+
+    // a signal of an instruction, with its routing for every possible qubit
+    typedef struct {
+        size_t operandIdx;
+        std::string signalType;
+        std::vector<tSignalRoute> routes;               // indexed by qubit
+    } tInstructionSignal;
+
+    typedef struct {
+        bool isReadout;
+        std::vector<tInstructionSignal> signals;
+    } tInstructionInfo;
+
+    typedef struct {
+        int signalValueId;      // -1 if group is unused in bundle
         size_t duration;
         ssize_t readoutCop;     // NB: we use ssize_t iso size_t so we can encode 'unused' (-1)
     } tGroupInfo;
 
 private:
     static const int MAX_SLOTS = 12;
-    static const int MAX_GROUPS = 32;                                  // enough for VSM
+    static const size_t MAX_GROUPS = 32;                        // enough for VSM. NB: groupsUsed is a bit mask, so must be <= 32
 
     bool verboseCode = true;                                    // output extra comments in generated code
 
@@ -476,11 +455,21 @@ private:
 
     // codegen state
     std::vector<std::vector<tGroupInfo>> groupInfo;             // matrix[slotIdx][group]
+    std::vector<uint32_t> groupsUsed;                           // per slotIdx: bit mask of groups used in current bundle
+    std::vector<int> slotsUsed;                                 // slotIdx of slots used in current bundle
+    std::vector<std::vector<std::map<int, uint32_t>>> codewordMap;  // [slotIdx][group]: signalValueId -> code word
     json codewordTable;                                         // codewords versus signals per instrument group
     json inputLutTable;                                         // input LUT usage per instrument group
     size_t lastStartCycle[MAX_SLOTS];
 
-    // some JSON nodes we need access to. FIXME: use pointers for efficiency?
+    // routing tables, compiled from JSON
+    std::vector<tSlotInfo> slotInfo;                            // indexed by slotIdx
+    std::map<std::string, std::vector<tSignalInfo>> signalTypeRoutes;   // signal type -> routing, indexed by qubit
+    std::map<std::string, tInstructionInfo> instructionInfo;    // instruction name -> signals
+    std::vector<std::string> signalValues;                      // expanded signal values, indexed by signalValueId
+    std::map<std::string, int> signalValueIds;                  // expanded signal value -> signalValueId
+
+    // some JSON nodes we need access to
     json backendSettings;
     json instrumentDefinitions;
     json controlModes;
@@ -580,56 +569,182 @@ private:
 
             DOUT("found instrument: name='" << instrumentName << "', signal type='" << signalType << "'");
         }
+
+        compile_routing_tables(platform);
     }
 
 
-    // find instrument/group/slot providing instructionSignalType for qubit
-    tSignalInfo findSignalInfoForQubit(std::string instructionSignalType, size_t qubit)
+    // build the routing tables: slot information and, per signal type, the instrument/group/slot driving each qubit
+    void compile_routing_tables(const ql::quantum_platform& platform)
     {
-        tSignalInfo ret = {-1, -1};
-        bool signalTypeFound = false;
-        bool qubitFound = false;
-
-        // iterate over CC slots
         const json &ccSetupSlots = ccSetup["slots"];
+        if(ccSetupSlots.size() > MAX_SLOTS) {
+            FATAL("JSON key 'cc_setup/slots' defines " << ccSetupSlots.size() << " slots, maximum is " << int(MAX_SLOTS));
+        }
+
+        slotInfo.clear();
+        signalTypeRoutes.clear();
         for(size_t slotIdx=0; slotIdx<ccSetupSlots.size(); slotIdx++) {
             const json &ccSetupSlot = ccSetupSlots[slotIdx];
             const json &instrument = ccSetupSlot["instrument"];
-            std::string instrumentSignalType = instrument["signal_type"];
-            if(instrumentSignalType == instructionSignalType) {
-                signalTypeFound = true;
-                std::string instrumentName = instrument["name"];
-                const json &qubits = instrument["qubits"];
-                // FIXME: verify group size
-                // FIXME: verify signal dimensions
-
-                // anyone connected to qubit?
-                for(size_t group=0; group<qubits.size() && !qubitFound; group++) {
-                    for(size_t idx=0; idx<qubits[group].size() && !qubitFound; idx++) {
-                        if(qubits[group][idx] == qubit) {
-                            qubitFound = true;
-
-                            DOUT("qubit " << qubit <<
-                                 " signal type '" << instructionSignalType <<
-                                 "' driven by instrument '" << instrumentName <<
-                                 "' group " << group <<
-                                 " in CC slot " << ccSetupSlot["slot"]);
-
-                            ret.slotIdx = slotIdx;
-                            ret.group = group;
-                        }
+
+            tSlotInfo si;
+            si.slot = ccSetupSlot["slot"];
+            si.instrumentName = instrument["name"].get<std::string>();
+            si.controlModeName = instrument["control_mode"].get<std::string>();
+            if(!JSON_EXISTS(controlModes, si.controlModeName)) {
+                FATAL("JSON file: control mode '" << si.controlModeName << "' of instrument '" << si.instrumentName << "' not found");
+            }
+            const json &controlMode = controlModes[si.controlModeName];
+            for(const json &bits : controlMode["control_bits"]) {
+                si.controlBits.push_back(bits.get<std::vector<int>>());
+            }
+            si.triggerBits = controlMode["trigger_bits"].get<std::vector<int>>();
+            si.hasResultBits = JSON_EXISTS(controlMode, "result_bits");
+            if(si.hasResultBits) {
+                for(const json &bits : controlMode["result_bits"]) {
+                    si.resultBits.push_back(bits.get<std::vector<int>>());
+                }
+            }
+            slotInfo.push_back(si);
+
+            // remind which group of this instrument drives which qubit
+            std::string signalType = instrument["signal_type"];
+            std::vector<tSignalInfo> &routes = signalTypeRoutes[signalType];
+            const json &qubits = instrument["qubits"];
+            // FIXME: verify signal dimensions
+            if(qubits.size() > MAX_GROUPS) {
+                FATAL("Instrument '" << si.instrumentName << "' defines " << qubits.size() << " groups, maximum is " << size_t(MAX_GROUPS));
+            }
+            for(size_t group=0; group<qubits.size(); group++) {
+                for(size_t idx=0; idx<qubits[group].size(); idx++) {
+                    size_t qubit = qubits[group][idx];
+                    if(qubit >= routes.size()) {
+                        routes.resize(std::max(qubit+1, platform.qubit_number), {-1, -1});
+                    }
+                    if(routes[qubit].slotIdx < 0) {     // first instrument found wins
+                        routes[qubit] = {(int)slotIdx, (int)group};
+                        DOUT("qubit " << qubit <<
+                             " signal type '" << signalType <<
+                             "' driven by instrument '" << si.instrumentName <<
+                             "' group " << group <<
+                             " in CC slot " << si.slot);
                     }
                 }
             }
         }
-        if(!signalTypeFound) {
-            FATAL("No instruments found providing signal type '" << instructionSignalType << "'");     // FIXME: clarify for user
+
+        // codegen state sized after the slots
+        groupInfo.assign(slotInfo.size(), std::vector<tGroupInfo>(MAX_GROUPS, {-1, 0, -1}));
+        groupsUsed.assign(slotInfo.size(), 0);
+        slotsUsed.clear();
+        codewordMap.assign(slotInfo.size(), std::vector<std::map<int, uint32_t>>(MAX_GROUPS));
+        instructionInfo.clear();
+        signalValues.clear();
+        signalValueIds.clear();
+    }
+
+
+    // get the id of an expanded signal value, assigning a new one if needed
+    int getSignalValueId(const std::string &signalValue)
+    {
+        auto it = signalValueIds.find(signalValue);
+        if(it != signalValueIds.end()) {
+            return it->second;
         }
-        if(!qubitFound) {
-            FATAL("No instruments found driving qubit " << qubit << " for signal type '" << instructionSignalType << "'");     // FIXME: clarify for user
+        int id = signalValues.size();
+        signalValues.push_back(signalValue);
+        signalValueIds[signalValue] = id;
+        return id;
+    }
+
+
+    // find the signals of instruction iname, with their routing per qubit. Compiled once on first use
+    const tInstructionInfo &findInstructionInfo(const std::string &iname, const ql::quantum_platform& platform)
+    {
+        auto it = instructionInfo.find(iname);
+        if(it != instructionInfo.end()) {
+            return it->second;
         }
 
-        return ret;
+        tInstructionInfo ii;
+        ii.isReadout = ("readout" == platform.find_instruction_type(iname));
+
+        // find signal definition for iname
+        const json &instruction = platform.find_instruction(iname);
+        if(!JSON_EXISTS(instruction, "cc")) {
+            FATAL("Error in JSON definition of instruction '" << iname << "': key 'cc' not found");
+        }
+        const json *tmp;
+        if(JSON_EXISTS(instruction["cc"], "signal_ref")) {
+            std::string signalRef = instruction["cc"]["signal_ref"];
+            if(!JSON_EXISTS(signals, signalRef) || signals[signalRef].size() == 0) {    // poor man's JSON pointer
+                FATAL("Error in JSON definition of instruction '" << iname <<
+                      "': signal_ref '" << signalRef << "' does not resolve");
+            }
+            tmp = &signals[signalRef];
+        } else {
+            tmp = &instruction["cc"]["signal"];
+            DOUT("signal for '" << instruction << "': " << *tmp);
+        }
+        const json &signal = *tmp;
+
+        // iterate over signals defined in instruction
+        for(size_t s=0; s<signal.size(); s++) {
+            tInstructionSignal is;
+            is.operandIdx = signal[s]["operand_idx"];
+            is.signalType = signal[s]["type"].get<std::string>();
+            auto routesIt = signalTypeRoutes.find(is.signalType);
+            if(routesIt == signalTypeRoutes.end()) {
+                FATAL("No instruments found providing signal type '" << is.signalType << "'");     // FIXME: clarify for user
+            }
+            const std::vector<tSignalInfo> &routes = routesIt->second;
+
+            // expand macros in signalValue for every qubit we can drive
+            std::string signalValueTemplate = SS2S(signal[s]["value"]);     // serialize value into std::string
+            for(size_t qubit=0; qubit<routes.size(); qubit++) {
+                const tSignalInfo &route = routes[qubit];
+                if(route.slotIdx < 0) {
+                    is.routes.push_back({-1, -1, -1});
+                    continue;
+                }
+                std::string signalValueString = signalValueTemplate;
+                replace(signalValueString, std::string("{gateName}"), iname);
+                replace(signalValueString, std::string("{instrumentName}"), slotInfo[route.slotIdx].instrumentName);
+                replace(signalValueString, std::string("{instrumentGroup}"), std::to_string(route.group));
+                replace(signalValueString, std::string("{qubit}"), std::to_string(qubit));
+                is.routes.push_back({route.slotIdx, route.group, getSignalValueId(signalValueString)});
+            }
+            ii.signals.push_back(is);
+        }
+
+        return instructionInfo[iname] = ii;
+    }
+
+
+    // find the code word for signalValueId on slot/group, assigning a new one on first use
+    uint32_t assignCodeword(int slotIdx, size_t group, int signalValueId)
+    {
+        std::map<int, uint32_t> &codewords = codewordMap[slotIdx][group];
+        auto it = codewords.find(signalValueId);
+        if(it != codewords.end()) {
+            DOUT("signal value found at cw=" << it->second);
+            return it->second;
+        }
+
+        // new signal value. NB: code word 0 is empty
+        // FIXME: check that number is available
+        uint32_t codeWord = codewords.size() + 1;
+        codewords[signalValueId] = codeWord;
+        DOUT("signal value '" << signalValues[signalValueId] << "' assigned to cw=" << codeWord << " in group " << group);
+
+        // administrate in codewordTable for reporting
+        const std::string &instrumentName = slotInfo[slotIdx].instrumentName;
+        if(codeWord == 1) {
+            codewordTable[instrumentName][group][0] = "";                           // NB: structure created on demand
+        }
+        codewordTable[instrumentName][group][codeWord] = signalValues[signalValueId];
+        return codeWord;
     }
 
 }; // class
@@ -11,6 +11,8 @@
 
 #define OPT_CC_SCHEDULE_RC     0       // 1=use resource constraint scheduler
 
+#include <unordered_map>
+
 #include <platform.h>
 #include <ir.h>
 #include <circuit.h>
@@ -107,6 +109,9 @@ public:
         // generate program header
         codegen.program_start(prog_name);
 
+        // bundles by kernel structure, so kernels that only differ in name are scheduled once
+        std::unordered_map<std::string, ql::ir::bundles_t> scheduled;
+
         // generate code for all kernels
         for(auto &kernel : kernels) {
             IOUT("Compiling kernel: " << kernel.name);
@@ -114,16 +119,23 @@ public:
 
             ql::circuit& ckt = kernel.c;
             if (!ckt.empty()) {
-                auto creg_count = kernel.creg_count;                        // FIXME: also take platform into account. We get qubit_number from JSON
+                std::string structure = kernel.structure();
+                auto it = scheduled.find(structure);
+                if(it == scheduled.end()) {
+                    auto creg_count = kernel.creg_count;                    // FIXME: also take platform into account. We get qubit_number from JSON
 
 #if OPT_CC_SCHEDULE_RC
-                // schedule with platform resource constraints
-                ql::ir::bundles_t bundles = cc_light_schedule_rc(ckt, platform, qubit_number, creg_count);
+                    // schedule with platform resource constraints
+                    ql::ir::bundles_t bundles = cc_light_schedule_rc(ckt, platform, qubit_number, creg_count);
 #else
-                // schedule without resource constraints
-                ql::ir::bundles_t bundles = cc_light_schedule(ckt, platform, qubit_number, creg_count);
+                    // schedule without resource constraints
+                    ql::ir::bundles_t bundles = cc_light_schedule(ckt, platform, qubit_number, creg_count);
 #endif
-                codegen_bundles(bundles, platform);
+                    it = scheduled.emplace(structure, bundles).first;
+                } else {
+                    DOUT("Reusing bundles of identical kernel for: " << kernel.name);
+                }
+                codegen_bundles(it->second, platform);
             } else {
                 DOUT("Empty kernel: " << kernel.name);                      // NB: normal situation for kernels with classical control
             }
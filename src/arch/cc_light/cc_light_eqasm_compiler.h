@@ -9,12 +9,16 @@
 #ifndef QL_CC_LIGHT_EQASM_COMPILER_H
 #define QL_CC_LIGHT_EQASM_COMPILER_H
 
+#include <unordered_map>
+
 #include <utils.h>
 #include <platform.h>
 #include <kernel.h>
 #include <gate.h>
 #include <ir.h>
 #include <eqasm_compiler.h>
+#include <mapper.h>
+#include <equivalence.h>
 #include <arch/cc_light/cc_light_eqasm.h>
 #include <arch/cc_light/cc_light_scheduler.h>
 
@@ -405,12 +409,108 @@ std::string classical_instruction2qisa(ql::arch::classical_cc* classical_ins)
 }
 
 
+// registers used as temporaries by the loops generated by fold_repeated_bundles,
+// r28 is used by the decomposition of mov, r29, r30, r31 by the for loops of kernels
+#define LOOP_COUNTER_REG    "r25"
+#define LOOP_STEP_REG       "r26"
+#define LOOP_BOUND_REG      "r27"
+#define LOOP_MAX_CREG_COUNT 25     // loops are only generated when the cregs r0.. stay below LOOP_COUNTER_REG
+#define LOOP_MAX_BODY_SIZE  64     // max number of bundles in a loop body
+#define LOOP_MIN_BODY_CYCLES 8     // min duration of a loop body, to hide the add, cmp, nop and br of each iteration
+#define LOOP_OVERHEAD       8      // lines of qisa added per loop
+
+/*
+ * fold repeated sequences of bundles into loops. Each element of bundle_qisa is
+ * the qisa of one bundle, including the wait relative to the previous bundle,
+ * which is bundle_delta in cycles.
+ * A sequence is only folded when it is repeated back to back with identical qisa,
+ * so the expanded instruction stream is unchanged, and when it lasts at least
+ * LOOP_MIN_BODY_CYCLES, so that the loop instructions do not change its timing
+ */
+std::string fold_repeated_bundles(const std::vector<std::string> & bundle_qisa,
+    const std::vector<size_t> & bundle_delta, std::string label_prefix)
+{
+    // map the qisa of the bundles to ids, so sequences can be compared cheaply
+    std::map<std::string, size_t> qisa2id;
+    std::vector<size_t> ids;
+    for(auto & bq : bundle_qisa)
+    {
+        auto it = qisa2id.find(bq);
+        if(it == qisa2id.end())
+        {
+            size_t id = qisa2id.size();
+            qisa2id[bq] = id;
+            ids.push_back(id);
+        }
+        else
+        {
+            ids.push_back(it->second);
+        }
+    }
+
+    std::stringstream ssbundles;
+    size_t nbundles = ids.size();
+    size_t nloops = 0;
+    size_t i = 0;
+    while(i < nbundles)
+    {
+        // find the body length with the largest saving for a loop starting at bundle i
+        size_t best_length = 0;
+        size_t best_count = 1;
+        size_t body_cycles = 0;
+        for(size_t length=1; length<=LOOP_MAX_BODY_SIZE && i+2*length<=nbundles; length++)
+        {
+            body_cycles += bundle_delta[i+length-1];
+            if(body_cycles < LOOP_MIN_BODY_CYCLES)
+                continue;
+            size_t count = 1;
+            while(i+(count+1)*length <= nbundles &&
+                std::equal(ids.begin()+i, ids.begin()+i+length, ids.begin()+i+count*length))
+            {
+                count++;
+            }
+            if(length*(count-1) > best_length*(best_count-1))
+            {
+                best_length = length;
+                best_count = count;
+            }
+        }
+
+        if(best_count > 1 && best_length*(best_count-1) > LOOP_OVERHEAD)
+        {
+            std::string label = label_prefix + "_loop" + std::to_string(nloops++);
+            DOUT("folding " << best_count << " repetitions of " << best_length << " bundles into " << label);
+            ssbundles << "    ldi " << LOOP_COUNTER_REG << ", 0\n"
+                      << "    ldi " << LOOP_STEP_REG << ", 1\n"
+                      << "    ldi " << LOOP_BOUND_REG << ", " << best_count << "\n"
+                      << label << ":\n";
+            for(size_t b=i; b<i+best_length; b++)
+                ssbundles << bundle_qisa[b];
+            ssbundles << "    add " << LOOP_COUNTER_REG << ", " << LOOP_COUNTER_REG << ", " << LOOP_STEP_REG << "\n"
+                      << "    cmp " << LOOP_COUNTER_REG << ", " << LOOP_BOUND_REG << "\n"
+                      << "    nop\n"
+                      << "    br lt, " << label << "\n";
+            i += best_length*best_count;
+        }
+        else
+        {
+            ssbundles << bundle_qisa[i];
+            i++;
+        }
+    }
+
+    return ssbundles.str();
+}
+
 std::string bundles2qisa(ql::ir::bundles_t & bundles,
-    const ql::quantum_platform & platform, MaskManager & gMaskManager)
+    const ql::quantum_platform & platform, MaskManager & gMaskManager,
+    std::string label_prefix="bundles", size_t creg_count=0)
 {
     IOUT("Generating CC-Light QISA");
 
     std::stringstream ssbundles, sspre, ssinst;
+    std::vector<std::string> bundle_qisa;
+    std::vector<size_t> bundle_delta;
     size_t curr_cycle=0;
 
     // sort sections to get consistent output across multiple runs. The output
@@ -517,6 +617,7 @@ std::string bundles2qisa(ql::ir::bundles_t & bundles,
                 }
             }
         }
+        std::stringstream ssbundle;
         if(classical_bundle)
         {
             if(iname == "fmr")
@@ -525,30 +626,49 @@ std::string bundles2qisa(ql::ir::bundles_t & bundles,
                 // two extra instructions need to be added between meas and fmr
                 if(delta > 2)
                 {
-                    ssbundles << "    qwait " << 1 << "\n";
-                    ssbundles << "    qwait " << delta-1 << "\n";
+                    ssbundle << "    qwait " << 1 << "\n";
+                    ssbundle << "    qwait " << delta-1 << "\n";
                 }
                 else
                 {
-                    ssbundles << "    qwait " << 1 << "\n";
-                    ssbundles << "    qwait " << 1 << "\n";
+                    ssbundle << "    qwait " << 1 << "\n";
+                    ssbundle << "    qwait " << 1 << "\n";
                 }
             }
             else
             {
                 if(delta > 1)
-                    ssbundles << "    qwait " << delta << "\n";
+                    ssbundle << "    qwait " << delta << "\n";
             }
-            ssbundles << "    " << ssinst.str() << "\n";
+            ssbundle << "    " << ssinst.str() << "\n";
         }
         else
         {
-            // ssbundles << sspre.str() << ssinst.str() << "\t\t# @" << bcycle << "\n";
-            ssbundles << sspre.str() << ssinst.str() << "\n";
+            // ssbundle << sspre.str() << ssinst.str() << "\t\t# @" << bcycle << "\n";
+            ssbundle << sspre.str() << ssinst.str() << "\n";
         }
+        bundle_qisa.push_back(ssbundle.str());
+        bundle_delta.push_back(delta);
         curr_cycle+=delta;
     }
 
+    bool fold = (ql::options::get("compress_bundles") == "yes");
+    if(fold && creg_count > LOOP_MAX_CREG_COUNT)
+    {
+        WOUT("bundles of " << label_prefix << " not folded into loops: its " << creg_count
+            << " cregs overlap the loop registers from " << LOOP_COUNTER_REG);
+        fold = false;
+    }
+    if(fold)
+    {
+        ssbundles << fold_repeated_bundles(bundle_qisa, bundle_delta, label_prefix);
+    }
+    else
+    {
+        for(auto & bq : bundle_qisa)
+            ssbundles << bq;
+    }
+
     auto & lastBundle = bundles.back();
     int lbduration = lastBundle.duration_in_cycles;
     if(lbduration>1)
@@ -576,7 +696,7 @@ void WriteCCLightQisa(std::string prog_name, ql::quantum_platform & platform, Ma
 
     std::stringstream ssbundles;
     ssbundles << "start:" << "\n";
-    ssbundles << bundles2qisa(bundles, platform, gMaskManager);
+    ssbundles << bundles2qisa(bundles, platform, gMaskManager, prog_name);
     ssbundles << "    br always, start" << "\n"
               << "    nop \n"
               << "    nop" << endl;
@@ -874,6 +994,37 @@ public:
         return ss.str();
     }
 
+    /**
+     * merge each run of consecutive straight-line kernels into the first kernel
+     * of the run, so that the run is scheduled as one circuit and a qubit that is
+     * idle at the end of a kernel can start with the next kernel early;
+     * a kernel is straight-line when it is a static kernel that is not repeated;
+     * kernels with a prologue or epilogue (the phi nodes) keep their boundaries,
+     * and so do the kernels that are branch targets, because these are phi nodes
+     * or follow one
+     */
+    std::vector<quantum_kernel> merge_kernels(const std::vector<quantum_kernel> & kernels)
+    {
+        std::vector<quantum_kernel> merged;
+        bool mergeable = false;             // whether the last kernel in merged ends a straight-line run
+        for (auto & k : kernels)
+        {
+            bool straight = (k.type == kernel_type_t::STATIC && k.iterations == 1);
+            if (straight && mergeable)
+            {
+                quantum_kernel & run = merged.back();
+                DOUT("merging kernel " << k.name << " into " << run.name);
+                run.c.insert(run.c.end(), k.c.begin(), k.c.end());
+                run.creg_count = std::max(run.creg_count, k.creg_count);
+                continue;
+            }
+            merged.push_back(k);
+            mergeable = straight;
+        }
+        IOUT("merged " << kernels.size() << " kernels into " << merged.size());
+        return merged;
+    }
+
 
     void decompose_post_schedule(ql::ir::bundles_t & bundles_dst,
         const ql::quantum_platform& platform)
@@ -885,38 +1036,8 @@ public:
         {
             IOUT("decompose cz to cz+sqf...");
 
-            typedef std::pair<size_t,size_t> qubits_pair_t;
-            std::map< qubits_pair_t, size_t > qubitpair2edge;           // map: pair of qubits to edge (from grid configuration)
-            std::map<size_t, std::vector<size_t> > edge_detunes_qubits; // map: edge to vector of qubits that edge detunes (resource desc.)
-
-            // initialize qubitpair2edge map from json description; this is a constant map
-            for(auto & anedge : platform.topology["edges"])
-            {
-                size_t s = anedge["src"];
-                size_t d = anedge["dst"];
-                size_t e = anedge["id"];
-
-                qubits_pair_t aqpair(s,d);
-                auto it = qubitpair2edge.find(aqpair);
-                if( it != qubitpair2edge.end() )
-                {
-                    FATAL("re-defining edge " << s <<"->" << d << " !");
-                }
-                else
-                {
-                    qubitpair2edge[aqpair] = e;
-                }
-            }
-
-            // initialize edge_detunes_qubits map from json description; this is a constant map
-            auto & constraints = platform.resources["detuned_qubits"]["connection_map"];
-            for (auto it = constraints.begin(); it != constraints.end(); ++it)
-            {
-                size_t edgeNo = stoi( it.key() );
-                auto & detuned_qubits = it.value();
-                for(auto & q : detuned_qubits)
-                    edge_detunes_qubits[edgeNo].push_back(q);
-            }
+            // qubit pair to edge and edge to detuned qubits, precomputed by the platform
+            const ql::topology_tables_t & topology_tables = platform.get_topology_tables();
 
             for (
                 auto bundles_src_it = bundles_src.begin(), bundles_dst_it = bundles_dst.begin();
@@ -956,13 +1077,11 @@ public:
                                 auto & q0 = (*ins_src_it)->operands[0];
                                 auto & q1 = (*ins_src_it)->operands[1];
                                 DOUT("found 2 qubit flux gate on " << q0 << " and " << q1);
-                                qubits_pair_t aqpair(q0, q1);
-                                auto it = qubitpair2edge.find(aqpair);
-                                if( it != qubitpair2edge.end() )
+                                int edge_no = topology_tables.edge(q0, q1);
+                                if( edge_no >= 0 )
                                 {
-                                    auto edge_no = qubitpair2edge[aqpair];
                                     DOUT("add the following sqf gates for edge: " << edge_no << ":");
-                                    for( auto & q : edge_detunes_qubits[edge_no])
+                                    for( auto q : topology_tables.edge_detunes_qubits(edge_no))
                                     {
                                         DOUT("sqf q" << q);
                                         custom_gate* g = new custom_gate("sqf q"+std::to_string(q));
@@ -1008,6 +1127,27 @@ public:
         // generate_opcode_cs_files(platform);
         MaskManager mask_manager;
 
+        if (ql::options::get("scheduler_cross_kernel") == "yes")
+        {
+            kernels = merge_kernels(kernels);
+        }
+
+        // one placement for all kernels, since each starts and ends with it
+        std::vector<size_t> placement;
+        if (ql::options::get("mapper") == "yes" && ql::options::get("initial_placement") == "yes")
+        {
+            InteractionMatrix interactions(ql::circuit(), num_qubits);
+            for (auto & kernel : kernels)
+            {
+                interactions.add(kernel.c);
+            }
+            placement = ql::Placer(platform).place(interactions);
+        }
+
+        // bundles of the kernels compiled so far, by kernel structure, so that
+        // kernels that only differ in name are scheduled once
+        std::unordered_map<std::string, ql::ir::bundles_t> compiled;
+
         std::stringstream ssqasm, ssqisa, sskernels_qisa;
         sskernels_qisa << "start:" << std::endl;
         for(auto &kernel : kernels)
@@ -1020,12 +1160,31 @@ public:
             auto num_creg = kernel.creg_count;
             if (! ckt.empty())
             {
+                std::string structure = kernel.structure();
+                auto it = compiled.find(structure);
+                if (it != compiled.end())
+                {
+                    DOUT("reusing the bundles of an identical kernel for " << kernel.name);
+                    sskernels_qisa << bundles2qisa(it->second, platform, mask_manager, kernel.name, num_creg);
+                    ssqasm << ql::ir::qasm(it->second) << std::endl;
+                    sskernels_qisa << get_epilogue(kernel);
+                    continue;
+                }
+
+                // route two-qubit gates over the topology
+                if (ql::options::get("mapper") == "yes")
+                {
+                    ql::Mapper mapper(platform, placement);
+                    mapper.map(kernel);
+                }
+
                 // decompose meta-instructions
                 decompose_pre_schedule(ckt, decomp_ckt, platform);
+                ql::verify_pass("decompose_pre_schedule", kernel.name, ckt, decomp_ckt);
 
                 // schedule with platform resource constraints
                 ql::ir::bundles_t bundles = 
-                    cc_light_schedule_rc(decomp_ckt, platform, num_qubits, num_creg);
+                    cc_light_schedule_rc(*kernel.backend_sched_cache, decomp_ckt, platform, num_qubits, num_creg);
 
         std::stringstream sched_qasm;
         sched_qasm <<"qubits " << num_qubits << "\n\n"
@@ -1036,10 +1195,15 @@ public:
         ql::utils::write_file(fname, sched_qasm.str());
 
                 // decompose meta-instructions after scheduling
+                ql::ir::bundles_t scheduled;
+                if (ql::options::get("verify_passes") == "yes")
+                    scheduled = bundles;
                 decompose_post_schedule(bundles, platform);
+                ql::verify_pass("decompose_post_schedule", kernel.name, scheduled, bundles);
 
-                sskernels_qisa << bundles2qisa(bundles, platform, mask_manager);
+                sskernels_qisa << bundles2qisa(bundles, platform, mask_manager, kernel.name, num_creg);
                 ssqasm << ql::ir::qasm(bundles) << std::endl;
+                compiled[structure] = bundles;
             }
             sskernels_qisa << get_epilogue(kernel);
         }
@@ -13,7 +13,9 @@
 #include <fstream>
 #include <vector>
 #include <string>
+#include <memory>
 #include <json.h>
+#include <topology.h>
 #include <resource_manager.h>
 
 using json = nlohmann::json;
@@ -91,15 +93,11 @@ public:
     qwg_resource_t* clone() const & { return new qwg_resource_t(*this);}
     qwg_resource_t* clone() && { return new qwg_resource_t(std::move(*this)); }
 
-    std::vector<size_t> fromcycle;          // qwg is busy from cycle==fromcycle[qwg], inclusive
-    std::vector<size_t> tocycle;            // qwg is busy to cycle==tocycle[qwg], not inclusive
-
-    // there was a bug here: when qwg is busy from cycle i with operation x
-    // then a new x is ok when starting at i or later
-    // but a new y must wait until the last x has finished;
-    // the bug was that a new x was always ok (so also when starting earlier than cycle i)
-
-    std::vector<std::string> operations;    // with operation_name==operations[qwg]
+    // qwg is busy in each interval of state[qwg] with the operation_name of that interval;
+    // operations with the same name can share it: when qwg is busy from cycle i with operation x
+    // then a new x is ok when starting at i or later (fwd) but a new y must wait until x has finished;
+    // since all intervals are kept, a gate can also be fitted in an idle gap between them
+    std::vector<interval_set_t> state;
     std::map<size_t,size_t> qubit2qwg;      // on qwg==qubit2qwg[q]
 
     qwg_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : 
@@ -107,16 +105,8 @@ public:
     {
         // DOUT("... creating " << name << " resource");
         count = platform.resources[name]["count"];
-        fromcycle.resize(count);
-        tocycle.resize(count);
-        operations.resize(count);
+        state.resize(count);
 
-        for(size_t i=0; i<count; i++)
-        {
-            fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-            tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-            operations[i] = "";
-        }
         auto & constraints = platform.resources[name]["connection_map"];
         for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
         {
@@ -136,24 +126,12 @@ public:
         {
             for( auto q : ins->operands )
             {
-                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qubit2qwg[q] << " is busy from cycle: " << fromcycle[ qubit2qwg[q] ] << " to cycle: " << tocycle[qubit2qwg[q]] << " for operation: " << operations[ qubit2qwg[q] ]);
-                if (forward_scheduling == direction)
-                {
-                    if ( op_start_cycle < fromcycle[ qubit2qwg[q] ]
-                    || ( op_start_cycle < tocycle[qubit2qwg[q]] && operations[ qubit2qwg[q] ] != operation_name ) )
-                    {
-                        DOUT("    " << name << " resource busy ...");
-                        return false;
-                    }
-                }
-                else
+                auto qwg = qubit2qwg[q];
+                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  qwg: " << qwg << " is busy in:" << state[qwg].to_string() << " for operation: " << operation_name);
+                if ( !state[qwg].available(op_start_cycle, operation_duration, operation_name, interval_set_t::share_operation, direction) )
                 {
-                    if ( op_start_cycle + operation_duration > tocycle[ qubit2qwg[q] ]
-                    || ( op_start_cycle + operation_duration > fromcycle[qubit2qwg[q]] && operations[ qubit2qwg[q] ] != operation_name ) )
-                    {
-                        DOUT("    " << name << " resource busy ...");
-                        return false;
-                    }
+                    DOUT("    " << name << " resource busy ...");
+                    return false;
                 }
             }
             DOUT("    " << name << " resource available ...");
@@ -169,36 +147,20 @@ public:
         {
             for( auto q : ins->operands )
             {
-                if (forward_scheduling == direction)
-                {
-                    if (operations[ qubit2qwg[q] ] == operation_name)
-                    {
-                        tocycle[ qubit2qwg[q] ]  = std::max( tocycle[qubit2qwg[q]], op_start_cycle + operation_duration);
-                    }
-                    else
-                    {
-                        fromcycle[ qubit2qwg[q] ]  = op_start_cycle;
-                        tocycle[ qubit2qwg[q] ]  = op_start_cycle + operation_duration;
-                        operations[ qubit2qwg[q] ] = operation_name;
-                    }
-                }
-                else
-                {
-                    if (operations[ qubit2qwg[q] ] == operation_name)
-                    {
-                        fromcycle[ qubit2qwg[q] ]  = std::min( fromcycle[qubit2qwg[q]], op_start_cycle);
-                    }
-                    else
-                    {
-                        fromcycle[ qubit2qwg[q] ]  = op_start_cycle;
-                        tocycle[ qubit2qwg[q] ]  = op_start_cycle + operation_duration;
-                        operations[ qubit2qwg[q] ] = operation_name;
-                    }
-                }
-                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qubit2qwg[q] << " reserved from cycle: " << fromcycle[ qubit2qwg[q] ] << " to cycle: " << tocycle[qubit2qwg[q]] << " for operation: " << operations[ qubit2qwg[q] ]);
+                auto qwg = qubit2qwg[q];
+                state[qwg].reserve(op_start_cycle, operation_duration, operation_name);
+                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " qwg: " << qwg << " now busy in:" << state[qwg].to_string());
             }
         }
     }
+    void forget(size_t cycle)
+    {
+        for (auto & s : state)
+        {
+            s.forget(cycle);
+        }
+    }
+
     ~qwg_resource_t() {}
 };
 
@@ -208,8 +170,9 @@ public:
     meas_resource_t* clone() const & { return new meas_resource_t(*this);}
     meas_resource_t* clone() && { return new meas_resource_t(std::move(*this)); }
 
-    std::vector<size_t> fromcycle;  // last measurement start cycle
-    std::vector<size_t> tocycle;    // is busy till cycle
+    // measurement unit is busy in each interval of state[meas];
+    // measurements on the same unit can only overlap when they start in the same cycle
+    std::vector<interval_set_t> state;
     std::map<size_t,size_t> qubit2meas;
 
     meas_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : 
@@ -217,14 +180,8 @@ public:
     {
         // DOUT("... creating " << name << " resource");
         count = platform.resources[name]["count"];
-        fromcycle.resize(count);
-        tocycle.resize(count);
+        state.resize(count);
 
-        for(size_t i=0; i<count; i++)
-        {
-            fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-            tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-        }
         auto & constraints = platform.resources[name]["connection_map"];
         for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
         {
@@ -244,32 +201,12 @@ public:
         {
             for(auto q : ins->operands)
             {
-                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << qubit2meas[q] << " is busy from cycle: " << fromcycle[ qubit2meas[q] ] << " to cycle: " << tocycle[qubit2meas[q]] );
-                if (forward_scheduling == direction)
-                {
-	                if( op_start_cycle != fromcycle[ qubit2meas[q] ] )
-	                {
-	                    // If current measurement on same measurement-unit does not start in the
-	                    // same cycle, then it should wait for current measurement to finish
-	                    if( op_start_cycle < tocycle[ qubit2meas[q] ] )
-	                    {
-	                        DOUT("    " << name << " resource busy ...");
-	                        return false;
-	                    }
-	                }
-                }
-                else
+                auto meas = qubit2meas[q];
+                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << "  meas: " << meas << " is busy in:" << state[meas].to_string());
+                if( !state[meas].available(op_start_cycle, operation_duration, operation_type, interval_set_t::share_start, direction) )
                 {
-	                if( op_start_cycle != fromcycle[ qubit2meas[q] ] )
-	                {
-	                    // If current measurement on same measurement-unit does not start in the
-	                    // same cycle, then it should wait until it would finish at start of or earlier than current measurement
-	                    if( op_start_cycle + operation_duration > fromcycle[ qubit2meas[q] ] )
-	                    {
-	                        DOUT("    " << name << " resource busy ...");
-	                        return false;
-	                    }
-	                }
+                    DOUT("    " << name << " resource busy ...");
+                    return false;
                 }
             }
             DOUT("    " << name << " resource available ...");
@@ -285,12 +222,20 @@ public:
         {
             for(auto q : ins->operands)
             {
-                fromcycle[ qubit2meas[q] ] = op_start_cycle;
-                tocycle[ qubit2meas[q] ] = op_start_cycle + operation_duration;
-                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << qubit2meas[q] << " reserved from cycle: " << fromcycle[ qubit2meas[q] ] << " to cycle: " << tocycle[qubit2meas[q]] );
+                auto meas = qubit2meas[q];
+                state[meas].reserve(op_start_cycle, operation_duration, operation_type);
+                DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " meas: " << meas << " now busy in:" << state[meas].to_string());
             }
         }
     }
+    void forget(size_t cycle)
+    {
+        for (auto & s : state)
+        {
+            s.forget(cycle);
+        }
+    }
+
     ~meas_resource_t() {}
 };
 
@@ -303,9 +248,7 @@ public:
     // fwd: edge is busy till cycle=state[edge], i.e. all cycles < state[edge] it is busy, i.e. start_cycle must be >= state[edge]
     // bwd: edge is busy from cycle=state[edge], i.e. all cycles >= state[edge] it is busy, i.e. start_cycle+duration must be <= state[edge]
     std::vector<size_t> state;
-    typedef std::pair<size_t,size_t> qubits_pair_t;
-    std::map< qubits_pair_t, size_t > qubits2edge;
-    std::map<size_t, std::vector<size_t> > edge2edges;
+    std::shared_ptr<const ql::topology_tables_t> topology_tables;  // qubit pair to edge and edge to edges, shared with platform
 
     edge_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : resource_t("edges", dir)
     {
@@ -318,34 +261,8 @@ public:
             state[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
         }
 
-        for( auto & anedge : platform.topology["edges"] )
-        {
-            size_t s = anedge["src"];
-            size_t d = anedge["dst"];
-            size_t e = anedge["id"];
-
-            qubits_pair_t aqpair(s,d);
-            auto it = qubits2edge.find(aqpair);
-            if( it != qubits2edge.end() )
-            {
-                EOUT("re-defining edge " << s <<"->" << d << " !");
-                throw ql::exception("[x] Error : re-defining edge !",false);
-            }
-            else
-            {
-                qubits2edge[aqpair] = e;
-            }
-        }
-
-        auto & constraints = platform.resources[name]["connection_map"];
-        for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
-        {
-            // COUT(it.key() << " : " << it.value() << "\n");
-            size_t edgeNo = stoi( it.key() );
-            auto & connected_edges = it.value();
-            for(auto & e : connected_edges)
-                edge2edges[e].push_back(edgeNo);
-        }
+        platform.get_topology_tables();     // checks presence
+        topology_tables = platform.topology_tables;
     }
 
     bool available(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
@@ -365,36 +282,22 @@ public:
             {
                 auto q0 = ins->operands[0];
                 auto q1 = ins->operands[1];
-                qubits_pair_t aqpair(q0, q1);
-                auto it = qubits2edge.find(aqpair);
-                if( it != qubits2edge.end() )
+                int edge_no = topology_tables->edge(q0, q1);
+                if( edge_no >= 0 )
                 {
-                    auto edge_no = qubits2edge[aqpair];
-
                     DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle 
                         << ", edge: " << edge_no << " is busy till/from cycle : " << state[edge_no] 
                         << " for operation: " << ins->name);
 
-                    std::vector<size_t> edges2check(edge2edges[edge_no]);
-                    edges2check.push_back(edge_no);
-                    for(auto & e : edges2check)
+                    bool busy = is_busy(edge_no, op_start_cycle, operation_duration);
+                    for(auto e : topology_tables->edge2edges(edge_no))
                     {
-                        if (forward_scheduling == direction)
-                        {
-                            if( op_start_cycle < state[e] )
-                            {
-                                DOUT("    " << name << " resource busy ...");
-                                return false;
-                            }
-                        }
-                        else
-                        {
-                            if( op_start_cycle + operation_duration > state[e] )
-                            {
-                                DOUT("    " << name << " resource busy ...");
-                                return false;
-                            }
-                        }
+                        busy = busy || is_busy(e, op_start_cycle, operation_duration);
+                    }
+                    if (busy)
+                    {
+                        DOUT("    " << name << " resource busy ...");
+                        return false;
                     }
                     DOUT("    " << name << " resource available ...");
                 }
@@ -427,12 +330,11 @@ public:
             {
                 auto q0 = ins->operands[0];
                 auto q1 = ins->operands[1];
-                qubits_pair_t aqpair(q0, q1);
-                auto edge_no = qubits2edge[aqpair];
+                int edge_no = topology_tables->edge(q0, q1);
                 if (forward_scheduling == direction)
                 {
                     state[edge_no] = op_start_cycle + operation_duration;
-                    for(auto & e : edge2edges[edge_no])
+                    for(auto e : topology_tables->edge2edges(edge_no))
                     {
                         state[e] = op_start_cycle + operation_duration;
                     }
@@ -440,7 +342,7 @@ public:
                 else
                 {
                     state[edge_no] = op_start_cycle;
-                    for(auto & e : edge2edges[edge_no])
+                    for(auto e : topology_tables->edge2edges(edge_no))
                     {
                         state[e] = op_start_cycle;
                     }
@@ -456,6 +358,19 @@ public:
         }
     }
     ~edge_resource_t() {}
+
+private:
+    bool is_busy(size_t e, size_t op_start_cycle, size_t operation_duration)
+    {
+        if (forward_scheduling == direction)
+        {
+            return op_start_cycle < state[e];
+        }
+        else
+        {
+            return op_start_cycle + operation_duration > state[e];
+        }
+    }
 };
 
 // A two-qubit flux gate lowers the frequency of its source qubit to get near the freq of its target qubit.
@@ -472,75 +387,31 @@ public:
 // A two-qubit flux gate must set the qubits it would detune to detuned, busy with a flux gate.
 // A one-qubit rotation gate must set its operand qubit to busy, busy with a rotation.
 //
-// The resource state machine maintains:
-// - fromcycle[q]: qubit q is busy from cycle fromcycle[q]
-// - tocycle[q]: to cycle tocycle[q] with an operation of the current operation type ...
-// - operations[q]: a "flux" or a "mw" (note: "" is initial value different from these two)
-// The fromcycle and tocycle are needed since a qubit can be busy with multiple "flux"s (i.e. being the detuned qubit for several "flux"s),
-// so the second, third, etc. of these "flux"s can be scheduled in parallel to the first but not earlier than fromcycle[q],
-// since till that cycle is was likely to be busy with "mw", which doesn't allow a "flux" in parallel. Similar for backward scheduling.
-// The other members contain internal copies of the resource description and grid configuration of the json file.
+// The resource state maintains for each qubit q the intervals in which it is busy, state[q],
+// each with an operation type: a "flux" or a "mw".
+// A qubit can be busy with multiple "flux"s (i.e. being the detuned qubit for several "flux"s),
+// so the second, third, etc. of these "flux"s can be scheduled in parallel to the first but not earlier than its start,
+// since before that cycle is was likely to be busy with "mw", which doesn't allow a "flux" in parallel. Similar for backward scheduling.
+// Since all intervals are kept, a gate can also be fitted in an idle gap between them.
 class detuned_qubits_resource_t : public resource_t
 {
 public:
     detuned_qubits_resource_t* clone() const & { return new detuned_qubits_resource_t(*this);}
     detuned_qubits_resource_t* clone() && { return new detuned_qubits_resource_t(std::move(*this)); }
 
-    std::vector<size_t> fromcycle;                              // qubit q is busy from cycle fromcycle[q]
-    std::vector<size_t> tocycle;                                // till cycle tocycle[q]
-    std::vector<std::string> operations;                        // with an operation of operation_type==operations[q]
+    std::vector<interval_set_t> state;                          // qubit q is busy in the intervals of state[q]
 
-    typedef std::pair<size_t,size_t> qubits_pair_t;
-    std::map< qubits_pair_t, size_t > qubitpair2edge;           // map: pair of qubits to edge (from grid configuration)
-    std::map<size_t, std::vector<size_t> > edge_detunes_qubits; // map: edge to vector of qubits that edge detunes (resource desc.)
+    std::shared_ptr<const ql::topology_tables_t> topology_tables;  // qubit pair to edge and edge to detuned qubits, shared with platform
 
     detuned_qubits_resource_t(const ql::quantum_platform & platform, scheduling_direction_t dir) : 
         resource_t("detuned_qubits", dir)
     {
         // DOUT("... creating " << name << " resource");
         count = platform.resources[name]["count"];
-        fromcycle.resize(count);
-        tocycle.resize(count);
-        operations.resize(count);
-
-        // initialize resource state machine to be free for all qubits
-        for(size_t i=0; i<count; i++)
-        {
-            fromcycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-            tocycle[i] = (forward_scheduling == dir ? 0 : MAX_CYCLE);
-            operations[i] = "";
-        }
-
-        // initialize qubitpair2edge map from json description; this is a constant map
-        for(auto & anedge : platform.topology["edges"])
-        {
-            size_t s = anedge["src"];
-            size_t d = anedge["dst"];
-            size_t e = anedge["id"];
-
-            qubits_pair_t aqpair(s,d);
-            auto it = qubitpair2edge.find(aqpair);
-            if( it != qubitpair2edge.end() )
-            {
-                EOUT("re-defining edge " << s <<"->" << d << " !");
-                throw ql::exception("[x] Error : re-defining edge !",false);
-            }
-            else
-            {
-                qubitpair2edge[aqpair] = e;
-            }
-        }
+        state.resize(count);                // initially free for all qubits
 
-        // initialize edge_detunes_qubits map from json description; this is a constant map
-        auto & constraints = platform.resources[name]["connection_map"];
-        for (json::const_iterator it = constraints.begin(); it != constraints.end(); ++it)
-        {
-            // COUT(it.key() << " : " << it.value() << "\n");
-            size_t edgeNo = stoi( it.key() );
-            auto & detuned_qubits = it.value();
-            for(auto & q : detuned_qubits)
-                edge_detunes_qubits[edgeNo].push_back(q);
-        }
+        platform.get_topology_tables();     // checks presence
+        topology_tables = platform.topology_tables;
     }
 
     // When a two-qubit flux gate, check whether the qubits it would detune are not busy with a rotation.
@@ -560,34 +431,18 @@ public:
             }
             else if (nopers == 2)
             {
-	    	    auto q0 = ins->operands[0];
-            	auto q1 = ins->operands[1];
-            	qubits_pair_t aqpair(q0, q1);
-            	auto it = qubitpair2edge.find(aqpair);
-            	if( it != qubitpair2edge.end() )
-            	{
-                    auto edge_no = qubitpair2edge[aqpair];
-
-                    for( auto & q : edge_detunes_qubits[edge_no])
+                auto q0 = ins->operands[0];
+                auto q1 = ins->operands[1];
+                int edge_no = topology_tables->edge(q0, q1);
+                if( edge_no >= 0 )
+                {
+                    for( auto q : topology_tables->edge_detunes_qubits(edge_no))
                     {
-                        DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
-                        if (forward_scheduling == direction)
-                        {
-                            if ( op_start_cycle < fromcycle[q]
-                            || ( op_start_cycle < tocycle[q] && operations[q] != operation_type ) )
-                            {
-                                DOUT("    " << name << " resource busy for a two-qubit gate...");
-                                return false;
-                            }
-                        }
-                        else
+                        DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", edge: " << edge_no << " detuning qubit: " << q << " for operation: " << ins->name << " busy in:" << state[q].to_string() << " with operation_type: " << operation_type);
+                        if ( !state[q].available(op_start_cycle, operation_duration, operation_type, interval_set_t::share_operation, direction) )
                         {
-                            if ( op_start_cycle + operation_duration > tocycle[q]
-                            || ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type ) )
-                            {
-                                DOUT("    " << name << " resource busy for a two-qubit gate...");
-                                return false;
-                            }
+                            DOUT("    " << name << " resource busy for a two-qubit gate...");
+                            return false;
                         }
                     }	// for over edges
                 }   // edge found
@@ -596,8 +451,8 @@ public:
                     EOUT("Use of illegal edge: " << q0 << "->" << q1 << " in operation: " << ins->name << " !");
                     throw ql::exception("[x] Error : Use of illegal edge"+std::to_string(q0)+"->"+std::to_string(q1)+"in operation:"+ins->name+" !",false);
                 }
-	        }   // nopers 1 or 2
-	        else
+            }   // nopers 1 or 2
+            else
             {
                 FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
             }
@@ -608,32 +463,11 @@ public:
         {
             for( auto q : ins->operands )
             {
-                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy from: " << fromcycle[q] << " till: " << tocycle[q] << " with operation_type: " << operation_type);
-                if (forward_scheduling == direction)
+                DOUT(" available " << name << "? op_start_cycle: " << op_start_cycle << ", qubit: " << q << " for operation: " << ins->name << " busy in:" << state[q].to_string() << " with operation_type: " << operation_type);
+                if ( !state[q].available(op_start_cycle, operation_duration, operation_type, interval_set_t::share_operation, direction) )
                 {
-                    if ( op_start_cycle < fromcycle[q])
-                    {
-                        DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " < fromcycle[" << q << "] " << fromcycle[q] );
-                        return false;
-                    }
-                    if ( op_start_cycle < tocycle[q] && operations[q] != operation_type )
-                    {
-                        DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " < tocycle[" << q << "] " << tocycle[q] );
-                        return false;
-                    }
-                }
-                else
-                {
-                    if ( op_start_cycle + operation_duration > tocycle[q])
-                    {
-                        DOUT("    " << name << " busy for rotation: op_start cycle " << op_start_cycle << " + duration > tocycle[" << q << "] " << tocycle[q] );
-                        return false;
-                    }
-                    if ( op_start_cycle + operation_duration > fromcycle[q] && operations[q] != operation_type )
-                    {
-                        DOUT("    " << name << " busy for rotation with flux: op_start cycle " << op_start_cycle << " + duration > fromcycle[" << q << "] " << fromcycle[q] );
-                        return false;
-                    }
+                    DOUT("    " << name << " busy for rotation ...");
+                    return false;
                 }
             }
         }
@@ -659,45 +493,15 @@ public:
             {
                 auto q0 = ins->operands[0];
                 auto q1 = ins->operands[1];
-                qubits_pair_t aqpair(q0, q1);
-                auto edge_no = qubitpair2edge[aqpair];
+                int edge_no = topology_tables->edge(q0, q1);
 
-                for(auto & q : edge_detunes_qubits[edge_no])
+                for(auto q : topology_tables->edge_detunes_qubits(edge_no))
                 {
-                    if (forward_scheduling == direction)
-                    {
-                        if (operations[q] == operation_type)
-                        {
-                            tocycle[q] = std::max( tocycle[q], op_start_cycle + operation_duration);
-                            DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                        }
-                        else
-                        {
-                            fromcycle[q] = op_start_cycle;
-                            tocycle[q] = op_start_cycle + operation_duration;
-                            operations[q] = operation_type;
-                            DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                        }
-                    }
-                    else
-                    {
-                        if (operations[q] == operation_type)
-                        {
-                            fromcycle[q] = std::min( fromcycle[q], op_start_cycle);
-                            DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                        }
-                        else
-                        {
-                            fromcycle[q] = op_start_cycle;
-                            tocycle[q] = op_start_cycle + operation_duration;
-                            operations[q] = operation_type;
-                            DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                        }
-                    }
-                    DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " edge: " << edge_no << " detunes qubit: " << q << " reserved from cycle: " << fromcycle[q] << " till cycle: " << tocycle[q] << " for operation: " << ins->name);
+                    state[q].reserve(op_start_cycle, operation_duration, operation_type);
+                    DOUT("reserved " << name << ". op_start_cycle: " << op_start_cycle << " edge: " << edge_no << " detunes qubit: " << q << " now busy in:" << state[q].to_string() << " for operation: " << ins->name);
                 }
             }
-	    else
+            else
             {
                 FATAL("Incorrect number of operands used in operation: " << ins->name << " !");
             }
@@ -707,40 +511,19 @@ public:
         {
             for( auto q : ins->operands )
             {
-                if (forward_scheduling == direction)
-                {
-                    if (operations[q] == operation_type)
-                    {
-                        tocycle[q] = std::max( tocycle[q], op_start_cycle + operation_duration);
-                        DOUT("reserving " << name << ". for qubit: " << q << " reusing cycle: " << fromcycle[q] << " to extending tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                    }
-                    else
-                    {
-                        fromcycle[q] = op_start_cycle;
-                        tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
-                        DOUT("reserving " << name << ". for qubit: " << q << " from fromcycle: " << fromcycle[q] << " to new tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                    }
-                }
-                else
-                {
-                    if (operations[q] == operation_type)
-                    {
-                        fromcycle[q] = std::min( fromcycle[q], op_start_cycle);
-                        DOUT("reserving " << name << ". for qubit: " << q << " from extended cycle: " << fromcycle[q] << " reusing tocycle: " << tocycle[q] << " for old operation: " << ins->name);
-                    }
-                    else
-                    {
-                        fromcycle[q] = op_start_cycle;
-                        tocycle[q] = op_start_cycle + operation_duration;
-                        operations[q] = operation_type;
-                        DOUT("reserving " << name << ". for qubit: " << q << " from new cycle: " << fromcycle[q] << " to tocycle: " << tocycle[q] << " for new operation: " << ins->name);
-                    }
-                }
-                DOUT("... reserved " << name << ". op_start_cycle: " << op_start_cycle << " for qubit: " << q << " reserved from cycle: " << fromcycle[q] << " till cycle: " << tocycle[q] << " for operation: " << ins->name);
+                state[q].reserve(op_start_cycle, operation_duration, operation_type);
+                DOUT("... reserved " << name << ". op_start_cycle: " << op_start_cycle << " for qubit: " << q << " now busy in:" << state[q].to_string() << " for operation: " << ins->name);
             }
         }
     }
+    void forget(size_t cycle)
+    {
+        for (auto & s : state)
+        {
+            s.forget(cycle);
+        }
+    }
+
     ~detuned_qubits_resource_t() {}
 };
 
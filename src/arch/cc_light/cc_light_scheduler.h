@@ -57,22 +57,28 @@ std::string get_cc_light_instruction_name(std::string & id, const ql::quantum_pl
 }
 
 
-ql::ir::bundles_t cc_light_schedule(ql::circuit & ckt,
+// sched keeps the dependence graph of ckt, which is extended when ckt was
+// scheduled before with sched and has grown since
+ql::ir::bundles_t cc_light_schedule(Scheduler & sched, ql::circuit & ckt,
     const ql::quantum_platform & platform, size_t nqubits, size_t ncreg = 0)
 {
     IOUT("Scheduling CC-Light instructions ...");
-    Scheduler sched;
-    sched.init(ckt, platform, nqubits, ncreg);
-
     ql::ir::bundles_t bundles1;
     std::string schedopt = ql::options::get("scheduler");
     std::string dot;    
-    if ("ASAP" == schedopt)
+    size_t window_size = Scheduler::get_window_size();
+    if ("ASAP" == schedopt && window_size > 0)
+    {
+        bundles1 = sched.schedule_asap_window(ckt, platform, nqubits, ncreg, window_size);
+    }
+    else if ("ASAP" == schedopt)
     {
+        sched.update(ckt, platform, nqubits, ncreg);
         bundles1 = sched.schedule_asap(dot);
     }
     else if ("ALAP" == schedopt)
     {
+        sched.update(ckt, platform, nqubits, ncreg);
         bundles1 = sched.schedule_alap(dot);
     }
     else
@@ -144,8 +150,17 @@ ql::ir::bundles_t cc_light_schedule(ql::circuit & ckt,
     return bundles2;
 }
 
+ql::ir::bundles_t cc_light_schedule(ql::circuit & ckt,
+    const ql::quantum_platform & platform, size_t nqubits, size_t ncreg = 0)
+{
+    Scheduler sched;
+    return cc_light_schedule(sched, ckt, platform, nqubits, ncreg);
+}
 
-ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt,
+
+// sched keeps the dependence graph of ckt, which is extended when ckt was
+// scheduled before with sched and has grown since
+ql::ir::bundles_t cc_light_schedule_rc(Scheduler & sched, ql::circuit & ckt,
     const ql::quantum_platform & platform, size_t nqubits, size_t ncreg = 0)
 {
     IOUT("Resource constraint scheduling of CC-Light instructions ...");
@@ -167,16 +182,21 @@ ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt,
     }
     cc_light_resource_manager_t rm(platform, direction);
 
-    Scheduler sched;
-    sched.init(ckt, platform, nqubits, ncreg);
     ql::ir::bundles_t bundles1;
     std::string dot;
-    if ("ASAP" == schedopt)
+    size_t window_size = Scheduler::get_window_size();
+    if ("ASAP" == schedopt && window_size > 0)
     {
+        bundles1 = sched.schedule_asap_window(ckt, platform, nqubits, ncreg, window_size, rm);
+    }
+    else if ("ASAP" == schedopt)
+    {
+        sched.update(ckt, platform, nqubits, ncreg);
         bundles1 = sched.schedule_asap(rm, platform, dot);
     }
     else if ("ALAP" == schedopt)
     {
+        sched.update(ckt, platform, nqubits, ncreg);
         bundles1 = sched.schedule_alap(rm, platform, dot);
     }
     else
@@ -250,6 +270,13 @@ ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt,
     return bundles2;
 }
 
+ql::ir::bundles_t cc_light_schedule_rc(ql::circuit & ckt,
+    const ql::quantum_platform & platform, size_t nqubits, size_t ncreg = 0)
+{
+    Scheduler sched;
+    return cc_light_schedule_rc(sched, ckt, platform, nqubits, ncreg);
+}
+
 
 
 } // end of namespace arch
@@ -39,6 +39,81 @@ public:
         }
         IOUT("Loading circuit (" <<  c.size() << " gates)...");
 
+        load_hw_settings(platform);
+
+        // schedule
+        ql::ir::bundles_t bundles = quantumsim_schedule(prog_name, num_qubits, c, platform);
+
+        // write scheduled bundles for quantumsim
+        std::stringstream ssgates;
+        write_bundles(ssgates, bundles, 0, false);
+        write_quantumsim_program(prog_name, num_qubits, ssgates.str(), platform);
+    }
+
+    /*
+     * compile kernels to quantumsim, kernels with iterations are emitted
+     * as python loops instead of being unrolled
+     */
+    void compile(std::string prog_name, std::vector<quantum_kernel> kernels, const ql::quantum_platform& platform)
+    {
+        IOUT("Compiling " << kernels.size() << " kernels to quantumsim ...");
+
+        load_hw_settings(platform);
+
+        std::stringstream ssgates;
+        size_t kernel_start = 0;        // cycle at which the current kernel starts
+        bool empty_program = true;
+        for(auto & k : kernels)
+        {
+            ql::circuit & c = k.get_circuit();
+            if (c.empty() || k.iterations == 0)
+                continue;
+
+            IOUT("Loading kernel " << k.name << " (" <<  c.size() << " gates, " << k.iterations << " iterations)...");
+            ql::ir::bundles_t bundles = quantumsim_schedule(prog_name, num_qubits, c, platform);
+
+            // kernel length, iterations are executed back to back; waits are
+            // not in the bundles but take time, a kernel with only waits has no bundles
+            size_t kernel_length = circuit_length(c, platform.cycle_time);
+            if (bundles.empty())
+            {
+                DOUT("kernel " << k.name << " has no bundles, only its " << k.iterations << " x " << kernel_length << " cycles are counted");
+                kernel_start += k.iterations * kernel_length;
+                continue;
+            }
+            empty_program = false;
+
+            if (k.iterations > 1)
+            {
+                ssgates << "\n# kernel " << k.name << ": " << k.iterations << " iterations of " << kernel_length << " cycles\n";
+                ssgates << "for i in range(" << k.iterations << "):\n";
+                ssgates << "    t = " << kernel_start << " + i*" << kernel_length << "\n";
+                write_bundles(ssgates, bundles, kernel_start, true);
+            }
+            else
+            {
+                write_bundles(ssgates, bundles, kernel_start, false);
+            }
+            kernel_start += k.iterations * kernel_length;
+        }
+
+        if (empty_program)
+        {
+            EOUT("empty circuit, eqasm compilation aborted !");
+            return;
+        }
+
+        write_quantumsim_program(prog_name, num_qubits, ssgates.str(), platform);
+    }
+
+    bool supports_loops()
+    {
+        return true;
+    }
+
+private:
+    void load_hw_settings(const ql::quantum_platform & platform)
+    {
         std::string params[] = { "qubit_number", "cycle_time" };
         size_t p = 0;
         try
@@ -50,17 +125,10 @@ public:
         {
             throw ql::exception("[x] error : ql::eqasm_compiler::compile() : error while reading hardware settings : parameter '"+params[p-1]+"'\n\t"+ std::string(e.what()),false);
         }
-
-        // schedule
-        ql::ir::bundles_t bundles = quantumsim_schedule(prog_name, num_qubits, c, platform);
-
-        // write scheduled bundles for quantumsim
-        write_quantumsim_program(prog_name, num_qubits, bundles, platform);
     }
 
-private:
     ql::ir::bundles_t quantumsim_schedule(  std::string prog_name, size_t nqubits,
-            ql::circuit & ckt, ql::quantum_platform & platform)
+            ql::circuit & ckt, const ql::quantum_platform & platform)
     {
         IOUT("Scheduling Quantumsim instructions ...");
         Scheduler sched;
@@ -72,8 +140,76 @@ private:
         return bundles;
     }
 
+    /*
+     * number of cycles from the start of the first gate of the scheduled
+     * circuit to the end of its last one, waits included
+     */
+    size_t circuit_length(ql::circuit & c, size_t cycle_time)
+    {
+        size_t start = size_t(-1);
+        size_t end = 0;
+        for (auto g : c)
+        {
+            start = std::min(start, g->cycle);
+            end = std::max(end, g->cycle + (g->duration + cycle_time - 1) / cycle_time);
+        }
+        return (end > start ? end - start : 0);
+    }
+
+    /*
+     * write the gates of the bundles, shifted by offset cycles. In a loop
+     * the gates are indented and timed relative to the loop variable t
+     */
+    void write_bundles( std::stringstream & ssbundles, ql::ir::bundles_t & bundles,
+        size_t offset, bool in_loop)
+    {
+        std::string indent = (in_loop ? "    " : "");
+        for ( ql::ir::bundle_t & abundle : bundles)
+        {
+            std::stringstream sstime;
+            if (in_loop)
+                sstime << "t+" << abundle.start_cycle;
+            else
+                sstime << offset + abundle.start_cycle;
+            std::string bcycle = sstime.str();
+
+            for( auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt )
+            {
+                for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
+                {
+                    auto & iname = (*insIt)->name;
+                    auto & operands = (*insIt)->operands;
+                    if( iname == "measure")
+                    {
+                        auto op = operands.back();
+                        ssbundles << "\n" << indent << "sampler = uniform_noisy_sampler(readout_error=0.03, seed=42)\n";
+                        ssbundles << indent << "c.add_qubit(\"m" << op <<"\")\n";
+                        ssbundles << indent << "c.add_measurement("
+                                  << "\"q" << op <<"\", "
+                                  << "time=" << bcycle << ", "
+                                  << "output_bit=\"m" << op <<"\", "
+                                  << "sampler=sampler"
+                                  << ")\n" ;
+                    }
+                    else
+                    {
+                        ssbundles << indent << "c.add_"<< iname << "(" ;
+                        size_t noperands = operands.size();
+                        if( noperands > 0 )
+                        {
+                            for(auto opit = operands.begin(); opit != operands.end()-1; opit++ )
+                                ssbundles << "\"q" << *opit <<"\", ";
+                            ssbundles << "\"q" << operands.back()<<"\"";
+                        }
+                        ssbundles << ", time=" << bcycle << ")" << endl;
+                    }
+                }
+            }
+        }
+    }
+
     void write_quantumsim_program( std::string prog_name, size_t num_qubits,
-        ql::ir::bundles_t & bundles, ql::quantum_platform & platform)
+        std::string gates, const ql::quantum_platform & platform)
     {
         IOUT("Writing scheduled Quantumsim program");
         ofstream fout;
@@ -99,7 +235,7 @@ private:
 
         DOUT("Adding qubits to Quantumsim program");
         fout << "\n# add qubits\n";
-        for (json::iterator it = platform.resources.begin(); it != platform.resources.end(); ++it)
+        for (auto it = platform.resources.begin(); it != platform.resources.end(); ++it)
         {
             std::string n = it.key();
             if( n == "qubits")
@@ -124,45 +260,7 @@ private:
 
         DOUT("Adding Gates to Quantumsim program");
         fout << "\n# add gates\n";
-        for ( ql::ir::bundle_t & abundle : bundles)
-        {
-            auto bcycle = abundle.start_cycle;
-
-            std::stringstream ssbundles;
-            for( auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt )
-            {
-                for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
-                {
-                    auto & iname = (*insIt)->name;
-                    auto & operands = (*insIt)->operands;
-                    if( iname == "measure")
-                    {
-                        auto op = operands.back();
-                        ssbundles << "\nsampler = uniform_noisy_sampler(readout_error=0.03, seed=42)\n";
-                        ssbundles << "c.add_qubit(\"m" << op <<"\")\n";
-                        ssbundles << "c.add_measurement("
-                                  << "\"q" << op <<"\", "
-                                  << "time=" << bcycle << ", "
-                                  << "output_bit=\"m" << op <<"\", "
-                                  << "sampler=sampler"
-                                  << ")\n" ;
-                    }
-                    else
-                    {
-                        ssbundles <<  "c.add_"<< iname << "(" ;
-                        size_t noperands = operands.size();
-                        if( noperands > 0 )
-                        {
-                            for(auto opit = operands.begin(); opit != operands.end()-1; opit++ )
-                                ssbundles << "\"q" << *opit <<"\", ";
-                            ssbundles << "\"q" << operands.back()<<"\"";
-                        }
-                        ssbundles << ", time=" << bcycle << ")" << endl;
-                    }
-                }
-            }
-            fout << ssbundles.str();
-        }
+        fout << gates;
 
         fout.close();
         IOUT("Writing scheduled Quantumsim program [Done]");
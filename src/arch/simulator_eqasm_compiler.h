@@ -0,0 +1,312 @@
+/**
+ * @file   simulator_eqasm_compiler.h
+ * @date   10/2018
+ * @brief  simulation backend common to the state-vector and stabilizer
+ *         simulators, runs the scheduled program natively on a simulator
+ *         state and writes a histogram of the measurement outcomes
+ */
+
+#ifndef QL_SIMULATOR_EQASM_COMPILER_H
+#define QL_SIMULATOR_EQASM_COMPILER_H
+
+#include <map>
+#include <fstream>
+
+#include <platform.h>
+#include <ir.h>
+#include <circuit.h>
+#include <scheduler.h>
+#include <statevector.h>
+#include <eqasm_compiler.h>
+
+namespace ql
+{
+namespace arch
+{
+
+/*
+ * State is the simulator state, with a constructor taking the number of
+ * qubits, reset(), apply(gate) and the outcomes of the last measurement
+ * of each qubit; the derived backend names itself and measures the final
+ * state when the measurements are deferred
+ */
+template<class State>
+class simulator_eqasm_compiler : public eqasm_compiler
+{
+public:
+    size_t num_qubits;
+    size_t shots;
+    std::vector<size_t> measured_qubits;        // in descending order
+    std::map<std::string, size_t> histogram;   // outcome of the measured qubits: count
+
+protected:
+    std::string backend;        // in the name of the shots option and of the results file
+    std::string description;    // in the messages
+
+    simulator_eqasm_compiler(std::string backend, std::string description) : backend(backend), description(description)
+    {
+    }
+
+    /*
+     * measure the qubits in measured_qubits on the final state of the
+     * program for every shot and count the outcomes in histogram
+     */
+    virtual void sample(State & state) = 0;
+
+private:
+    // kernels that are executed one after the other, the whole block for a number of iterations
+    typedef std::pair<std::vector<ql::ir::bundles_t>, size_t> scheduled_block_t;
+
+public:
+    /*
+     * simulate the circuit
+     */
+    void compile(std::string prog_name, ql::circuit& c, ql::quantum_platform& platform)
+    {
+        IOUT("Simulating circuit (" << c.size() << " gates) ...");
+        if (c.empty())
+        {
+            EOUT("empty circuit, simulation aborted !");
+            return;
+        }
+        load_hw_settings(platform);
+        std::vector<scheduled_block_t> program(1, scheduled_block_t({}, 1));
+        program.back().first.push_back(schedule(c, platform, creg_count(c)));
+        simulate(program, max_operand(c) + 1);
+        write_histogram(prog_name);
+    }
+
+    /*
+     * simulate the kernels; the kernels of a for loop, between its FOR_START
+     * and FOR_END kernels, are repeated for the iterations of the loop;
+     * classical control flow (if, else, do while) is not supported
+     */
+    void compile(std::string prog_name, std::vector<quantum_kernel> kernels, const ql::quantum_platform& platform)
+    {
+        IOUT("Simulating " << kernels.size() << " kernels ...");
+        load_hw_settings(platform);
+        std::vector<scheduled_block_t> program;
+        size_t nqubits = 0;
+        bool in_loop = false;
+        for(auto & k : kernels)
+        {
+            if (k.type == kernel_type_t::FOR_START)
+            {
+                program.push_back(scheduled_block_t({}, k.iterations));
+                in_loop = true;
+                continue;
+            }
+            if (k.type == kernel_type_t::FOR_END)
+            {
+                in_loop = false;
+                continue;
+            }
+            if (k.type != kernel_type_t::STATIC)
+            {
+                FATAL("kernel " << k.name << " has classical control flow, which the " << description << " simulator does not support");
+            }
+
+            ql::circuit & c = k.get_circuit();
+            if (c.empty())
+                continue;
+            DOUT("Scheduling kernel " << k.name << " (" << c.size() << " gates)...");
+            if (!in_loop)
+            {
+                program.push_back(scheduled_block_t({}, 1));
+            }
+            program.back().first.push_back(schedule(c, platform, k.creg_count));
+            nqubits = std::max(nqubits, max_operand(c) + 1);
+        }
+        program.erase(std::remove_if(program.begin(), program.end(),
+            [](const scheduled_block_t & b) { return b.first.empty() || b.second == 0; }), program.end());
+        if (program.empty())
+        {
+            EOUT("empty circuit, simulation aborted !");
+            return;
+        }
+        simulate(program, nqubits);
+        write_histogram(prog_name);
+    }
+
+    bool supports_loops()
+    {
+        return true;
+    }
+
+private:
+    void load_hw_settings(const ql::quantum_platform & platform)
+    {
+        try
+        {
+            num_qubits = platform.hardware_settings["qubit_number"];
+        }
+        catch (json::exception &e)
+        {
+            throw ql::exception("[x] error : ql::eqasm_compiler::compile() : error while reading hardware settings : parameter 'qubit_number'\n\t"+ std::string(e.what()),false);
+        }
+
+        std::string s = ql::options::get(backend + "_shots");
+        try
+        {
+            shots = std::stoul(s);
+        }
+        catch (std::exception &e)
+        {
+            throw ql::exception("[x] error : ql::" + backend + "_eqasm_compiler : invalid number of shots '" + s + "' !",false);
+        }
+    }
+
+    size_t max_operand(ql::circuit & c)
+    {
+        size_t max = 0;
+        for (auto g : c)
+        {
+            // the operands of classical instructions are registers
+            if (g->type() == __classical_gate__)
+                continue;
+            for (auto q : g->operands)
+                max = std::max(max, q);
+        }
+        if (max >= num_qubits)
+        {
+            throw ql::exception("[x] error : ql::" + backend + "_eqasm_compiler : qubit " + std::to_string(max) + " exceeds the qubit_number of the platform !",false);
+        }
+        return max;
+    }
+
+    // a circuit outside a kernel has no creg count of its own
+    size_t creg_count(ql::circuit & c)
+    {
+        size_t count = 0;
+        for (auto g : c)
+        {
+            for (auto r : g->creg_operands)
+                count = std::max(count, r + 1);
+            if (g->type() == __classical_gate__)
+                for (auto r : g->operands)
+                    count = std::max(count, r + 1);
+        }
+        return count;
+    }
+
+    ql::ir::bundles_t schedule(ql::circuit & ckt, const ql::quantum_platform & platform, size_t creg_count)
+    {
+        Scheduler sched;
+        sched.init(ckt, platform, num_qubits, creg_count);
+        std::string dot;
+        return sched.schedule_asap(dot);
+    }
+
+    template<typename F>
+    static void for_each_gate(std::vector<scheduled_block_t> & program, size_t max_iterations, F f)
+    {
+        for (auto & b : program)
+        {
+            size_t iterations = std::min(b.second, max_iterations);
+            for (size_t i = 0; i < iterations; i++)
+                for (auto & bundles : b.first)
+                    for (auto & abundle : bundles)
+                        for (auto & section : abundle.parallel_sections)
+                            for (auto g : section)
+                                f(*g);
+        }
+    }
+
+    /*
+     * when no qubit is operated on after being measured and no qubit is
+     * reset after being operated on, the program is unitary up to the
+     * final measurements, which can then be deferred to the end: the
+     * program is simulated once and the shots are measured on the final
+     * state, otherwise it is simulated once per shot, because a reset of
+     * an entangled qubit collapses it like a measurement. Qubits that are
+     * never measured are not part of the outcome, and when no qubit is
+     * measured at all every qubit is
+     */
+    void simulate(std::vector<scheduled_block_t> & program, size_t nqubits)
+    {
+        std::vector<bool> measured(nqubits, false);
+        std::vector<bool> used(nqubits, false);
+        bool deferred = true;
+        // two iterations show whether a loop operates on a qubit it measured or resets a qubit it used
+        for_each_gate(program, 2, [&](ql::gate & g)
+        {
+            if (ql::state_vector::is_idle(g))
+                return;
+            bool measurement = ql::state_vector::is_measurement(g);
+            bool reset = ql::state_vector::is_reset(g);
+            for (auto q : g.operands)
+            {
+                if (measured[q] && !measurement)
+                    deferred = false;
+                if (used[q] && reset)
+                    deferred = false;
+                if (measurement)
+                    measured[q] = true;
+                used[q] = true;
+            }
+        });
+        if (std::find(measured.begin(), measured.end(), true) == measured.end())
+        {
+            measured.assign(nqubits, true);
+        }
+
+        measured_qubits.clear();
+        for (size_t q = nqubits; q-- > 0; )
+            if (measured[q])
+                measured_qubits.push_back(q);
+
+        IOUT("Simulating " << nqubits << " qubits, " << shots << " shots" << (deferred ? " measured on the final state" : "") << " ...");
+        histogram.clear();
+        State state(nqubits);
+        if (deferred)
+        {
+            for_each_gate(program, size_t(-1), [&](ql::gate & g)
+            {
+                if (!ql::state_vector::is_measurement(g))
+                    state.apply(g);
+            });
+            sample(state);
+        }
+        else
+        {
+            for (size_t shot = 0; shot < shots; shot++)
+            {
+                state.reset();
+                for_each_gate(program, size_t(-1), [&](ql::gate & g)
+                {
+                    state.apply(g);
+                });
+                std::string outcome;
+                for (auto q : measured_qubits)
+                    outcome += (state.outcomes[q] == 1 ? '1' : '0');
+                histogram[outcome]++;
+            }
+        }
+        IOUT("Simulating [Done]");
+    }
+
+    void write_histogram(std::string prog_name)
+    {
+        std::string fname = ql::options::get("output_dir") + "/" + prog_name + "_" + backend + ".txt";
+        IOUT("Writing simulation results to " << fname);
+        std::ofstream fout(fname);
+        if (!fout.is_open())
+        {
+            EOUT("opening file " << fname << std::endl
+                     << "Make sure the output directory ("<< ql::options::get("output_dir") << ") exists");
+            return;
+        }
+        fout << "# " << description << " simulation of " << prog_name << ", " << shots << " shots\n";
+        fout << "# outcome of";
+        for (auto q : measured_qubits)
+            fout << " q" << q;
+        fout << ", count\n";
+        for (auto & h : histogram)
+            fout << h.first << " " << h.second << "\n";
+    }
+};
+
+} // arch
+} // ql
+
+#endif // QL_SIMULATOR_EQASM_COMPILER_H
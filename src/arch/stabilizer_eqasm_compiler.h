@@ -0,0 +1,48 @@
+/**
+ * @file   stabilizer_eqasm_compiler.h
+ * @date   10/2018
+ * @brief  stabilizer simulation backend, runs the scheduled Clifford
+ *         program natively and writes a histogram of the measurement outcomes
+ */
+
+#ifndef QL_STABILIZER_EQASM_COMPILER_H
+#define QL_STABILIZER_EQASM_COMPILER_H
+
+#include <random>
+
+#include <stabilizer.h>
+#include <arch/simulator_eqasm_compiler.h>
+
+namespace ql
+{
+namespace arch
+{
+
+class stabilizer_eqasm_compiler : public simulator_eqasm_compiler<ql::stabilizer_state>
+{
+public:
+    stabilizer_eqasm_compiler() : simulator_eqasm_compiler("stabilizer", "stabilizer")
+    {
+    }
+
+private:
+    // every shot measures a copy of the final state
+    void sample(ql::stabilizer_state & state)
+    {
+        std::mt19937_64 seeds(42);
+        for (size_t shot = 0; shot < shots; shot++)
+        {
+            ql::stabilizer_state final_state = state;
+            final_state.seed(seeds());
+            std::string outcome;
+            for (auto q : measured_qubits)
+                outcome += (final_state.measure(q) == 1 ? '1' : '0');
+            histogram[outcome]++;
+        }
+    }
+};
+
+} // arch
+} // ql
+
+#endif // QL_STABILIZER_EQASM_COMPILER_H
@@ -0,0 +1,43 @@
+/**
+ * @file   statevector_eqasm_compiler.h
+ * @date   10/2018
+ * @brief  state-vector simulation backend, runs the scheduled program
+ *         natively and writes a histogram of the measurement outcomes
+ */
+
+#ifndef QL_STATEVECTOR_EQASM_COMPILER_H
+#define QL_STATEVECTOR_EQASM_COMPILER_H
+
+#include <statevector.h>
+#include <arch/simulator_eqasm_compiler.h>
+
+namespace ql
+{
+namespace arch
+{
+
+class statevector_eqasm_compiler : public simulator_eqasm_compiler<ql::state_vector>
+{
+public:
+    statevector_eqasm_compiler() : simulator_eqasm_compiler("statevector", "state-vector")
+    {
+    }
+
+private:
+    // the shots are sampled from the final state
+    void sample(ql::state_vector & state)
+    {
+        for (auto i : state.sample(shots))
+        {
+            std::string outcome;
+            for (auto q : measured_qubits)
+                outcome += ((i >> q) & 1 ? '1' : '0');
+            histogram[outcome]++;
+        }
+    }
+};
+
+} // arch
+} // ql
+
+#endif // QL_STATEVECTOR_EQASM_COMPILER_H
@@ -0,0 +1,487 @@
+/**
+ * @file   clifford.h
+ * @date   10/2018
+ * @brief  clifford group tables and stabilizer tableau, used to generate
+ *         randomized benchmarking sequences with their recovery gates
+ */
+
+#ifndef QL_CLIFFORD_H
+#define QL_CLIFFORD_H
+
+#include <string>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "utils.h"
+#include "exception.h"
+
+namespace ql
+{
+
+const size_t clifford_count = 24;       // number of single qubit cliffords
+
+/**
+ * the single qubit cliffords, numbered as in quantum_kernel::clifford(), with
+ * their native pulses; their composition and inverse tables are computed once
+ * from the unitaries of the pulses, equal up to global phase
+ */
+class clifford_tables_t
+{
+public:
+    size_t h, s, x, z;                  // ids of the hadamard, phase, pauli x and pauli z gates
+
+    /**
+     * tables shared by all users, computed on first use
+     */
+    static const clifford_tables_t & get()
+    {
+        static const clifford_tables_t tables;
+        return tables;
+    }
+
+    /**
+     * clifford a followed by clifford b
+     */
+    size_t compose(size_t a, size_t b) const
+    {
+        return composition[a*clifford_count+b];
+    }
+
+    size_t inverse(size_t a) const
+    {
+        return inverses[a];
+    }
+
+    /**
+     * native pulses of clifford a, in the order in which they are applied
+     */
+    const std::vector<std::string> & pulses(size_t a) const
+    {
+        return native_pulses[a];
+    }
+
+    /**
+     * shortest sequence of 'h' and 's' gates implementing clifford a
+     */
+    const std::string & hs_word(size_t a) const
+    {
+        return hs_words[a];
+    }
+
+private:
+    typedef std::complex<double> cplx_t;
+    typedef std::vector<cplx_t> unitary_t;      // 2x2, row major
+
+    std::vector<std::vector<std::string>> native_pulses;
+    std::vector<unitary_t> unitaries;
+    std::vector<size_t> composition;
+    std::vector<size_t> inverses;
+    std::vector<std::string> hs_words;
+
+    clifford_tables_t()
+    {
+        native_pulses = {
+            {},                                 //  0: I
+            {"ry90", "rx90"},                   //  1
+            {"mrx90", "mry90"},                 //  2
+            {"rx180"},                          //  3
+            {"mry90", "mrx90"},                 //  4
+            {"rx90", "mry90"},                  //  5
+            {"ry180"},                          //  6
+            {"mry90", "rx90"},                  //  7
+            {"rx90", "ry90"},                   //  8
+            {"rx180", "ry180"},                 //  9
+            {"ry90", "mrx90"},                  // 10
+            {"mrx90", "ry90"},                  // 11
+            {"ry90", "rx180"},                  // 12
+            {"mrx90"},                          // 13
+            {"rx90", "mry90", "mrx90"},         // 14
+            {"mry90"},                          // 15
+            {"rx90"},                           // 16
+            {"rx90", "ry90", "rx90"},           // 17
+            {"mry90", "rx180"},                 // 18
+            {"rx90", "ry180"},                  // 19
+            {"rx90", "mry90", "rx90"},          // 20
+            {"ry90"},                           // 21
+            {"mrx90", "ry180"},                 // 22
+            {"rx90", "ry90", "mrx90"}           // 23
+        };
+
+        for (auto & seq : native_pulses)
+        {
+            unitary_t u = identity();
+            for (auto & p : seq)
+            {
+                u = multiply(pulse(p), u);
+            }
+            unitaries.push_back(normalize(u));
+        }
+
+        composition.resize(clifford_count*clifford_count);
+        inverses.resize(clifford_count);
+        for (size_t a=0; a<clifford_count; a++)
+        {
+            for (size_t b=0; b<clifford_count; b++)
+            {
+                composition[a*clifford_count+b] = find(multiply(unitaries[b], unitaries[a]));
+                if (composition[a*clifford_count+b] == 0)
+                {
+                    inverses[a] = b;
+                }
+            }
+        }
+
+        const double r = 1/std::sqrt(2.0);
+        h = find({ r, r, r, -r });
+        s = find({ 1, 0, 0, cplx_t(0,1) });
+        x = find({ 0, 1, 1, 0 });
+        z = find({ 1, 0, 0, -1 });
+
+        // breadth first over words of h and s, in order of length
+        hs_words.assign(clifford_count, "");
+        std::vector<bool> found(clifford_count, false);
+        std::vector<size_t> queue = { 0 };
+        found[0] = true;
+        for (size_t i=0; i<queue.size(); i++)
+        {
+            size_t a = queue[i];
+            for (auto g : { std::make_pair('h', h), std::make_pair('s', s) })
+            {
+                size_t b = compose(a, g.second);
+                if (!found[b])
+                {
+                    found[b] = true;
+                    hs_words[b] = hs_words[a] + g.first;
+                    queue.push_back(b);
+                }
+            }
+        }
+    }
+
+    static unitary_t identity()
+    {
+        return { 1, 0, 0, 1 };
+    }
+
+    static unitary_t multiply(const unitary_t & a, const unitary_t & b)
+    {
+        return { a[0]*b[0]+a[1]*b[2], a[0]*b[1]+a[1]*b[3],
+                 a[2]*b[0]+a[3]*b[2], a[2]*b[1]+a[3]*b[3] };
+    }
+
+    static unitary_t pulse(const std::string & name)
+    {
+        double angle = (name.substr(name.size()-3) == "180" ? M_PI : M_PI/2);
+        if (name[0] == 'm')
+        {
+            angle = -angle;
+        }
+        double c = std::cos(angle/2);
+        double s = std::sin(angle/2);
+        if (name.find("rx") != std::string::npos)
+        {
+            return { c, cplx_t(0,-s), cplx_t(0,-s), c };
+        }
+        return { c, -s, s, c };
+    }
+
+    // remove the global phase: the first non-zero element becomes real and positive
+    static unitary_t normalize(const unitary_t & u)
+    {
+        for (auto & e : u)
+        {
+            if (std::abs(e) > 1e-6)
+            {
+                cplx_t phase = std::conj(e)/std::abs(e);
+                unitary_t n;
+                for (auto & f : u)
+                {
+                    n.push_back(f*phase);
+                }
+                return n;
+            }
+        }
+        return u;
+    }
+
+    size_t find(const unitary_t & u) const
+    {
+        unitary_t n = normalize(u);
+        size_t a = 0;
+        for (; a<unitaries.size(); a++)
+        {
+            double d = 0;
+            for (size_t i=0; i<4; i++)
+            {
+                d += std::abs(n[i]-unitaries[a][i]);
+            }
+            if (d < 1e-6)
+            {
+                break;
+            }
+        }
+        if (a == unitaries.size())
+        {
+            FATAL("unitary is not one of the " << clifford_count << " single qubit cliffords");
+        }
+        return a;
+    }
+};
+
+
+/**
+ * stabilizer tableau of a clifford circuit on n qubits (Aaronson and Gottesman):
+ * rows 0..n-1 are the images of X on each qubit, rows n..2n-1 those of Z; the
+ * bits of each qubit column are packed over the rows so that a gate updates
+ * all rows with word operations
+ */
+class clifford_tableau_t
+{
+public:
+    /**
+     * gate of a synthesized circuit: "h", "s", "x" or "z" on q0, or "cnot" on q0, q1
+     */
+    struct gate_t
+    {
+        std::string name;
+        size_t q0;
+        size_t q1;
+    };
+
+    clifford_tableau_t(size_t n) : n(n), nwords((2*n+63)/64),
+        xs(n, std::vector<uint64_t>(nwords, 0)), zs(n, std::vector<uint64_t>(nwords, 0)),
+        r(nwords, 0)
+    {
+        for (size_t q=0; q<n; q++)
+        {
+            set(xs[q], q);
+            set(zs[q], n+q);
+        }
+    }
+
+    size_t qubit_count() const
+    {
+        return n;
+    }
+
+    void h(size_t a)
+    {
+        for (size_t w=0; w<nwords; w++)
+        {
+            r[w] ^= xs[a][w] & zs[a][w];
+            std::swap(xs[a][w], zs[a][w]);
+        }
+    }
+
+    void s(size_t a)
+    {
+        for (size_t w=0; w<nwords; w++)
+        {
+            r[w] ^= xs[a][w] & zs[a][w];
+            zs[a][w] ^= xs[a][w];
+        }
+    }
+
+    void x(size_t a)
+    {
+        for (size_t w=0; w<nwords; w++)
+        {
+            r[w] ^= zs[a][w];
+        }
+    }
+
+    void z(size_t a)
+    {
+        for (size_t w=0; w<nwords; w++)
+        {
+            r[w] ^= xs[a][w];
+        }
+    }
+
+    void cnot(size_t a, size_t b)
+    {
+        for (size_t w=0; w<nwords; w++)
+        {
+            r[w] ^= xs[a][w] & zs[b][w] & ~(xs[b][w] ^ zs[a][w]);
+            xs[b][w] ^= xs[a][w];
+            zs[a][w] ^= zs[b][w];
+        }
+    }
+
+    void cz(size_t a, size_t b)
+    {
+        h(b);
+        cnot(a, b);
+        h(b);
+    }
+
+    /**
+     * single qubit clifford id of clifford_tables_t on qubit a
+     */
+    void clifford(size_t id, size_t a)
+    {
+        for (char g : clifford_tables_t::get().hs_word(id))
+        {
+            if (g == 'h')
+                h(a);
+            else
+                s(a);
+        }
+    }
+
+    void apply(const gate_t & g)
+    {
+        if (g.name == "h")          h(g.q0);
+        else if (g.name == "s")     s(g.q0);
+        else if (g.name == "x")     x(g.q0);
+        else if (g.name == "z")     z(g.q0);
+        else if (g.name == "cnot")  cnot(g.q0, g.q1);
+        else FATAL("'" << g.name << "' is not a tableau gate");
+    }
+
+    /**
+     * true when the tableau is that of the identity, i.e. of the empty circuit up to global phase
+     */
+    bool is_identity() const
+    {
+        for (size_t w=0; w<nwords; w++)
+        {
+            if (r[w] != 0)
+                return false;
+        }
+        for (size_t q=0; q<n; q++)
+        {
+            for (size_t row=0; row<2*n; row++)
+            {
+                if (get(xs[q], row) != (row == q) || get(zs[q], row) != (row == n+q))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * circuit that undoes this one: applied after it, the tableau becomes the identity;
+     * it is found by reducing a copy of the tableau to the identity qubit by qubit
+     */
+    std::vector<gate_t> recovery() const
+    {
+        clifford_tableau_t t(*this);
+        std::vector<gate_t> gates;
+        auto add = [&](std::string name, size_t q0, size_t q1)
+        {
+            gates.push_back({ name, q0, q1 });
+            t.apply(gates.back());
+        };
+        auto swap = [&](size_t a, size_t b)
+        {
+            add("cnot", a, b);
+            add("cnot", b, a);
+            add("cnot", a, b);
+        };
+
+        for (size_t q=0; q<n; q++)
+        {
+            // destabilizer q gets an X on qubit q
+            if (!t.get(t.xs[q], q))
+            {
+                bool done = false;
+                for (size_t i=q+1; i<n && !done; i++)
+                {
+                    if (t.get(t.xs[i], q))
+                    {
+                        swap(i, q);
+                        done = true;
+                    }
+                }
+                for (size_t i=q; i<n && !done; i++)
+                {
+                    if (t.get(t.zs[i], q))
+                    {
+                        add("h", i, 0);
+                        if (i != q)
+                            swap(i, q);
+                        done = true;
+                    }
+                }
+            }
+
+            // clear the other X's and all Z's of destabilizer q
+            for (size_t i=q+1; i<n; i++)
+            {
+                if (t.get(t.xs[i], q))
+                    add("cnot", q, i);
+            }
+            bool has_z = false;
+            for (size_t i=q; i<n; i++)
+                has_z = has_z || t.get(t.zs[i], q);
+            if (has_z)
+            {
+                if (!t.get(t.zs[q], q))
+                    add("s", q, 0);
+                for (size_t i=q+1; i<n; i++)
+                {
+                    if (t.get(t.zs[i], q))
+                        add("cnot", i, q);
+                }
+                add("s", q, 0);
+            }
+
+            // stabilizer q becomes Z on qubit q
+            for (size_t i=q+1; i<n; i++)
+            {
+                if (t.get(t.zs[i], n+q))
+                    add("cnot", i, q);
+            }
+            bool has_x = false;
+            for (size_t i=q; i<n; i++)
+                has_x = has_x || t.get(t.xs[i], n+q);
+            if (has_x)
+            {
+                add("h", q, 0);
+                for (size_t i=q+1; i<n; i++)
+                {
+                    if (t.get(t.xs[i], n+q))
+                        add("cnot", q, i);
+                }
+                if (t.get(t.zs[q], n+q))
+                    add("s", q, 0);
+                add("h", q, 0);
+            }
+        }
+
+        // signs
+        for (size_t q=0; q<n; q++)
+        {
+            if (t.get(t.r, q))
+                add("z", q, 0);
+            if (t.get(t.r, n+q))
+                add("x", q, 0);
+        }
+        return gates;
+    }
+
+private:
+    size_t n;
+    size_t nwords;
+    std::vector<std::vector<uint64_t>> xs;     // [qubit]: bit per row, X part of the row on qubit
+    std::vector<std::vector<uint64_t>> zs;     // [qubit]: bit per row, Z part of the row on qubit
+    std::vector<uint64_t> r;                   // bit per row, sign of the row
+
+    static bool get(const std::vector<uint64_t> & bits, size_t row)
+    {
+        return (bits[row/64] >> (row%64)) & 1;
+    }
+
+    static void set(std::vector<uint64_t> & bits, size_t row)
+    {
+        bits[row/64] |= uint64_t(1) << (row%64);
+    }
+};
+
+} // namespace ql
+
+#endif // QL_CLIFFORD_H
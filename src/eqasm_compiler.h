@@ -45,6 +45,16 @@ namespace ql
         {
         }
 
+        /*
+         * returns true when the backend lowers kernel iterations to loops in
+         * compile(prog_name, kernels, plat); otherwise the kernels are
+         * unrolled into a single fused circuit for compile(prog_name, c, plat)
+         */
+        virtual bool supports_loops()
+        {
+            return false;
+        }
+
         /**
          * write eqasm code to file/stdout
          */
@@ -0,0 +1,234 @@
+/**
+ * @file   equivalence.h
+ * @date   10/2018
+ * @brief  equivalence checking of the circuits before and after a pass
+ */
+
+#ifndef QL_EQUIVALENCE_H
+#define QL_EQUIVALENCE_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+
+#include <utils.h>
+#include <options.h>
+#include <exception.h>
+#include <gate.h>
+#include <circuit.h>
+#include <ir.h>
+#include <statevector.h>
+
+namespace ql
+{
+
+/**
+ * checks whether two circuits implement the same operation up to a global
+ * phase, by simulating both on the qubits they use:
+ * - on up to exact_qubits qubits, on every computational basis state,
+ *   which compares their unitaries
+ * - on up to max_qubits qubits, on random_states random states
+ * Measurements after the last gate on a qubit and preparations before its
+ * first gate are left out of the simulation, but both circuits must have
+ * the same ones; circuits with other measurements or preparations, or with
+ * gates the simulator does not support, are not checked
+ */
+class equivalence_checker
+{
+public:
+    typedef enum { equivalent, not_equivalent, unknown } result_t;
+
+    static const size_t exact_qubits = 6;
+    static const size_t max_qubits = 16;
+    static const size_t random_states = 2;
+
+    std::string reason;     // why the result is not_equivalent or unknown
+
+    result_t check(const ql::circuit & c0, const ql::circuit & c1)
+    {
+        reason = "";
+
+        // the qubits used by either circuit, numbered from 0
+        std::map<size_t, size_t> qubits;
+        for (auto c : { &c0, &c1 })
+        {
+            for (auto g : *c)
+            {
+                if (!ql::state_vector::is_idle(*g))
+                    for (auto q : g->operands)
+                        qubits[q] = 0;
+            }
+        }
+        size_t nqubits = 0;
+        for (auto & q : qubits)
+            q.second = nqubits++;
+
+        if (nqubits > max_qubits)
+        {
+            reason = std::to_string(nqubits) + " qubits, at most " + std::to_string(max_qubits) + " are checked";
+            return unknown;
+        }
+
+        std::vector<std::string> boundary0, boundary1;
+        std::vector<ql::gate *> unitary0, unitary1;
+        if (!split(c0, unitary0, boundary0) || !split(c1, unitary1, boundary1))
+        {
+            reason = "measurement or preparation between gates";
+            return unknown;
+        }
+        if (boundary0 != boundary1)
+        {
+            reason = "the measurements or preparations differ";
+            return not_equivalent;
+        }
+
+        try
+        {
+            ql::state_vector s0(nqubits), s1(nqubits);
+            if (nqubits <= exact_qubits)
+            {
+                // columns of the unitaries, which must match with the same phase
+                std::complex<double> phase;
+                for (size_t i = 0; i < (size_t(1) << nqubits); i++)
+                {
+                    s0.set_basis_state(i);
+                    s1.set_basis_state(i);
+                    run(s0, unitary0, qubits);
+                    run(s1, unitary1, qubits);
+                    std::complex<double> overlap = s0.inner_product(s1);
+                    if (i == 0)
+                        phase = overlap;
+                    if (std::abs(overlap - phase) > 1e-6 || std::abs(std::abs(overlap) - 1.0) > 1e-6)
+                    {
+                        reason = "the circuits differ on basis state " + std::to_string(i);
+                        return not_equivalent;
+                    }
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < random_states; i++)
+                {
+                    s0.set_random_state();
+                    s1 = s0;
+                    run(s0, unitary0, qubits);
+                    run(s1, unitary1, qubits);
+                    double fidelity = std::abs(s0.inner_product(s1));
+                    if (std::abs(fidelity - 1.0) > 1e-6)
+                    {
+                        reason = "the circuits differ on a random state, fidelity " + std::to_string(fidelity);
+                        return not_equivalent;
+                    }
+                }
+            }
+        }
+        catch (ql::exception &e)
+        {
+            reason = "unsupported gate";
+            return unknown;
+        }
+        return equivalent;
+    }
+
+private:
+    /**
+     * separate the gates of c from its leading preparations and trailing
+     * measurements, which are listed in boundary; false when c measures or
+     * prepares a qubit in between gates on that qubit
+     */
+    bool split(const ql::circuit & c, std::vector<ql::gate *> & unitary, std::vector<std::string> & boundary)
+    {
+        std::map<size_t, bool> used, measured;
+        for (auto g : c)
+        {
+            if (ql::state_vector::is_idle(*g))
+                continue;
+            bool measurement = ql::state_vector::is_measurement(*g);
+            bool preparation = ql::state_vector::is_reset(*g);
+            for (auto q : g->operands)
+            {
+                if (measured[q] && !measurement)
+                    return false;
+                if (preparation && used[q])
+                    return false;
+                if (!preparation)
+                    used[q] = true;
+                if (measurement)
+                    measured[q] = true;
+            }
+            if (measurement || preparation)
+            {
+                std::string b = (measurement ? "measure" : "prepz");
+                for (auto q : g->operands)
+                    b += " " + std::to_string(q);
+                boundary.push_back(b);
+            }
+            else
+            {
+                unitary.push_back(g);
+            }
+        }
+        std::sort(boundary.begin(), boundary.end());
+        return true;
+    }
+
+    void run(ql::state_vector & s, std::vector<ql::gate *> & gates, std::map<size_t, size_t> & qubits)
+    {
+        std::vector<size_t> ops;
+        for (auto g : gates)
+        {
+            ops.clear();
+            for (auto q : g->operands)
+                ops.push_back(qubits[q]);
+            s.apply(*g, ops);
+        }
+    }
+};
+
+/**
+ * when the verify_passes option is set, check that pass did not change the
+ * operation of the circuit of kernel, and raise an error when it did
+ */
+void verify_pass(const std::string & pass, const std::string & kernel,
+                 const ql::circuit & before, const ql::circuit & after)
+{
+    if (ql::options::get("verify_passes") != "yes")
+        return;
+
+    equivalence_checker checker;
+    auto result = checker.check(before, after);
+    if (result == equivalence_checker::not_equivalent)
+    {
+        EOUT("pass " << pass << " changed the circuit of kernel " << kernel << ": " << checker.reason);
+        throw ql::exception("[x] error : ql::verify_pass : pass " + pass + " changed the circuit of kernel " + kernel + " !",false);
+    }
+    else if (result == equivalence_checker::unknown)
+    {
+        DOUT("pass " << pass << " not verified for kernel " << kernel << ": " << checker.reason);
+    }
+    else
+    {
+        DOUT("pass " << pass << " verified for kernel " << kernel);
+    }
+}
+
+void verify_pass(const std::string & pass, const std::string & kernel,
+                 const ql::ir::bundles_t & before, const ql::ir::bundles_t & after)
+{
+    if (ql::options::get("verify_passes") != "yes")
+        return;
+
+    ql::circuit c0, c1;
+    for (auto & abundle : before)
+        for (auto & section : abundle.parallel_sections)
+            c0.insert(c0.end(), section.begin(), section.end());
+    for (auto & abundle : after)
+        for (auto & section : abundle.parallel_sections)
+            c1.insert(c1.end(), section.begin(), section.end());
+    verify_pass(pass, kernel, c0, c1);
+}
+
+} // namespace ql
+
+#endif // QL_EQUIVALENCE_H
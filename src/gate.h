@@ -226,6 +226,7 @@ public:
 #endif
     virtual gate_type_t   type()       = 0;
     virtual cmat_t        mat()        = 0;  // to do : change cmat_t type to avoid stack smashing on 2 qubits gate operations
+    virtual ~gate() {}
 };
 
 
@@ -1353,6 +1354,41 @@ public:
     }
 };
 
+// dependence graph node that joins a group of commuting gates, see Scheduler
+class GROUP : public gate
+{
+public:
+    cmat_t m;
+
+    GROUP() : m(nop_c)
+    {
+        name = "GROUP";
+        duration = 0;
+    }
+
+    instruction_t qasm()
+    {
+        return instruction_t("GROUP");
+    }
+
+#if OPT_MICRO_CODE
+    instruction_t micro_code()
+    {
+        return ql::dep_instruction_map["GROUP"];
+    }
+#endif
+
+    gate_type_t type()
+    {
+        return __dummy_gate__;
+    }
+
+    cmat_t mat()
+    {
+        return m;
+    }
+};
+
 class display : public gate
 {
 public:
@@ -1402,6 +1438,7 @@ public:
     instruction_type_t  operation_type;   // operation type : rf/flux
     strings_t           used_hardware;    // used hardware
     std::string         arch_operation_name;  // name of instruction in the architecture (e.g. cc_light_instr)
+    strings_t           operand_access;   // access to each qubit operand for commutation: "W", "R" or "D"
 
 public:
 
@@ -1427,6 +1464,7 @@ public:
         operation_type = g.operation_type;
         duration  = g.duration;
         used_hardware.assign(g.used_hardware.begin(), g.used_hardware.end());
+        operand_access.assign(g.operand_access.begin(), g.operand_access.end());
         m.m[0] = g.m.m[0];
         m.m[1] = g.m.m[1];
         m.m[2] = g.m.m[2];
@@ -1541,6 +1579,32 @@ public:
             m.m[1] = complex_t(mat[1][0], mat[1][1]);
             m.m[2] = complex_t(mat[2][0], mat[2][1]);
             m.m[3] = complex_t(mat[3][0], mat[3][1]);
+            // optional, see Scheduler::add_node
+            if (instr.count("operand_access") > 0)
+            {
+                l_attr = "operand_access";
+                strings_t access = instr["operand_access"];
+                for (auto & a : access)
+                {
+                    if (a != "W" && a != "R" && a != "D")
+                    {
+                        EOUT("invalid access '" << a << "' in attribute 'operand_access' !");
+                        throw ql::exception("[x] error : ql::custom_gate() : error while loading instruction '" + name + "' : attribute 'operand_access' : invalid access '" + a + "', expected W, R or D !", false);
+                    }
+                }
+                // the accesses are per operand, so only an instruction with its qubits in "qubits" can have them
+                if (parameters == 0 && !access.empty())
+                {
+                    EOUT("attribute 'operand_access' on an instruction without attribute 'qubits' !");
+                    throw ql::exception("[x] error : ql::custom_gate() : error while loading instruction '" + name + "' : attribute 'operand_access' : the instruction has no qubits !", false);
+                }
+                if (access.size() != parameters)
+                {
+                    EOUT("attribute 'operand_access' does not have an access for each of the " << parameters << " qubits !");
+                    throw ql::exception("[x] error : ql::custom_gate() : error while loading instruction '" + name + "' : attribute 'operand_access' : number of accesses differs from number of qubits !", false);
+                }
+                operand_access = access;
+            }
         }
         catch (json::exception &e)
         {
@@ -0,0 +1,247 @@
+/**
+ * @file   gate_dispatch.h
+ * @date   10/2018
+ * @brief  gate dispatch table: resolution of a gate name and its operands
+ *         to a custom gate or a gate decomposition, precompiled per instruction map
+ */
+
+#ifndef QL_GATE_DISPATCH_H
+#define QL_GATE_DISPATCH_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <sstream>
+#include <iterator>
+#include <cctype>
+
+#include "utils.h"
+#include "exception.h"
+#include "gate.h"
+#include "instruction_map.h"
+
+namespace ql
+{
+
+/**
+ * the instruction map keys are strings combining a gate name and its operands:
+ * - "name q0 q1": specialized composite gate (gate decomposition)
+ * - "name %0 %1": parameterized composite gate
+ * - "name q0,q1": specialized custom gate
+ * - "name": parameterized custom gate
+ * quantum_kernel::gate() checks these in this order; instead of building each
+ * key string and looking it up, the keys are split once here into a table
+ * per gate name with the operand tuples; the decompositions are parsed into
+ * templates of sub instructions, each with its operand mapping and, when it
+ * can be known in advance, the custom gate it resolves to
+ */
+class gate_dispatch_t
+{
+public:
+    struct entry_t;
+
+    /**
+     * sub instruction of a decomposition
+     */
+    struct sub_gate_t
+    {
+        std::string name;
+        std::vector<size_t> operands;       // qubits when specialized, operand indices of the composite gate when parameterized
+        const entry_t * entry;              // dispatch entry of name, NULL when there is none
+        custom_gate * prototype;            // custom gate to clone when resolved at load, otherwise NULL
+    };
+
+    struct decomposition_t
+    {
+        std::vector<sub_gate_t> sub_gates;
+        std::string error;                  // when not empty, the decomposition can't be used
+    };
+
+    struct entry_t
+    {
+        entry_t() : prototype(NULL) {}
+
+        custom_gate * prototype;                                            // "name"
+        std::map<std::vector<size_t>, custom_gate *> specialized;            // "name q0,q1"
+        std::map<std::vector<size_t>, decomposition_t> spec_decompositions;  // "name q0 q1"
+        std::map<size_t, decomposition_t> param_decompositions;             // "name %0 %1", by number of operands
+    };
+
+    const instruction_map_t gate_definition;     // the instruction map the table was built from
+
+    gate_dispatch_t(const instruction_map_t & definitions) : gate_definition(definitions)
+    {
+        // every key is a parameterized custom gate for a gate name equal to it
+        for (auto & kv : gate_definition)
+        {
+            entries[kv.first].prototype = kv.second;
+        }
+
+        for (auto & kv : gate_definition)
+        {
+            const std::string & key = kv.first;
+            size_t pos = key.find(' ');
+            if (pos == std::string::npos || pos == 0)
+            {
+                continue;
+            }
+            std::string name = key.substr(0, pos);
+            std::string operands = key.substr(pos+1);
+
+            std::vector<size_t> ids;
+            if (__composite_gate__ == kv.second->type())
+            {
+                composite_gate * gptr = (composite_gate *)(kv.second);
+                if (parse_operands(operands, ' ', 'q', ids))
+                {
+                    entries[name].spec_decompositions[ids] = parse_decomposition(gate_definition, gptr, 0);
+                }
+                else if (parse_operands(operands, ' ', '%', ids) && is_identity(ids))
+                {
+                    entries[name].param_decompositions[ids.size()] = parse_decomposition(gate_definition, gptr, ids.size());
+                }
+            }
+            else if (parse_operands(operands, ',', 'q', ids))
+            {
+                entries[name].specialized[ids] = kv.second;
+            }
+        }
+
+        // link sub instructions to their entries; entries is not changed anymore
+        for (auto & e : entries)
+        {
+            for (auto & d : e.second.spec_decompositions)
+                link(d.second, true);
+            for (auto & d : e.second.param_decompositions)
+                link(d.second, false);
+        }
+    }
+
+    // entries point into each other
+    gate_dispatch_t(const gate_dispatch_t &) = delete;
+    gate_dispatch_t & operator=(const gate_dispatch_t &) = delete;
+
+    /**
+     * entry of gate name, NULL when the instruction map doesn't define it
+     */
+    const entry_t * find(const std::string & name) const
+    {
+        auto it = entries.find(name);
+        return (it == entries.end() ? NULL : &it->second);
+    }
+
+private:
+    std::unordered_map<std::string, entry_t> entries;
+
+    // operands must be formatted as the kernel formats them, i.e. <prefix><std::to_string(n)>
+    static bool parse_operands(const std::string & s, char separator, char prefix, std::vector<size_t> & ids)
+    {
+        ids.clear();
+        std::istringstream iss(s);
+        std::string token;
+        while (std::getline(iss, token, separator))
+        {
+            if (token.size() < 2 || token[0] != prefix)
+                return false;
+            std::string digits = token.substr(1);
+            if (!std::all_of(digits.begin(), digits.end(), ::isdigit))
+                return false;
+            size_t id = std::stoul(digits);
+            if (std::to_string(id) != digits)
+                return false;
+            ids.push_back(id);
+        }
+        return !ids.empty();
+    }
+
+    static bool is_identity(const std::vector<size_t> & ids)
+    {
+        for (size_t i=0; i<ids.size(); i++)
+        {
+            if (ids[i] != i)
+                return false;
+        }
+        return true;
+    }
+
+    // noperands: number of operands of a parameterized composite gate, 0 when specialized
+    static decomposition_t parse_decomposition(const instruction_map_t & gate_definition, composite_gate * gptr, size_t noperands)
+    {
+        decomposition_t d;
+        DOUT("composite ins: " << gptr->name);
+        for (auto & agate : gptr->gs)
+        {
+            std::string sub_ins = agate->name;
+            DOUT("  sub ins: " << sub_ins);
+            if (gate_definition.find(sub_ins) == gate_definition.end())
+            {
+                d.error = "[x] error : ql::kernel::gate() : gate decomposition not available for '"+sub_ins+"'' in the target platform !";
+                return d;
+            }
+
+            std::replace( sub_ins.begin(), sub_ins.end(), ',', ' ');
+            std::istringstream iss(sub_ins);
+            std::vector<std::string> tokens{ std::istream_iterator<std::string>{iss},
+                                             std::istream_iterator<std::string>{} };
+            if (tokens.empty())
+            {
+                d.error = "[x] error : ql::kernel::gate() : empty sub instruction in decomposition of '"+gptr->name+"' !";
+                return d;
+            }
+
+            sub_gate_t sub;
+            sub.name = tokens[0];
+            sub.entry = NULL;
+            sub.prototype = NULL;
+            for (size_t i=1; i<tokens.size(); i++)
+            {
+                std::string digits = tokens[i].substr(1);
+                if (digits.empty() || !std::all_of(digits.begin(), digits.end(), ::isdigit))
+                {
+                    d.error = "[x] error : ql::kernel::gate() : invalid operand '"+tokens[i]+"' of sub instruction '"+agate->name+"' in decomposition of '"+gptr->name+"' !";
+                    return d;
+                }
+                size_t id = std::stoul(digits);
+                if (noperands > 0 && id >= noperands)
+                {
+                    d.error = "[x] error : ql::kernel::gate() : operand '"+tokens[i]+"' of sub instruction '"+agate->name+"' out of range in decomposition of '"+gptr->name+"' !";
+                    return d;
+                }
+                sub.operands.push_back(id);
+            }
+            d.sub_gates.push_back(sub);
+        }
+        return d;
+    }
+
+    // resolve the custom gate of each sub instruction as far as its operands are known:
+    // in a specialized decomposition they are, in a parameterized one only when
+    // the sub instruction has no specialized custom gates
+    void link(decomposition_t & d, bool specialized)
+    {
+        for (auto & sub : d.sub_gates)
+        {
+            sub.entry = find(sub.name);
+            sub.prototype = NULL;
+            if (sub.entry == NULL)
+            {
+                continue;
+            }
+            if (specialized)
+            {
+                auto it = sub.entry->specialized.find(sub.operands);
+                sub.prototype = (it != sub.entry->specialized.end() ? it->second : sub.entry->prototype);
+            }
+            else if (sub.entry->specialized.empty())
+            {
+                sub.prototype = sub.entry->prototype;
+            }
+        }
+    }
+};
+
+} // namespace ql
+
+#endif // QL_GATE_DISPATCH_H
@@ -22,6 +22,7 @@
 #include <exception.h>
 #include <json.h>
 #include <gate.h>
+#include <platform_image.h>
 
 namespace ql
 {
@@ -50,7 +51,13 @@ public:
         json config;
         try
         {
-            config = load_json(config_file_name);
+            // a precompiled image, see platform_image.h, saves parsing the json text
+            loaded_from_image = (ql::options::get("use_platform_image") == "yes"
+                && ql::platform_image::load(ql::platform_image::image_file_name(config_file_name), config_file_name, config));
+            if (!loaded_from_image)
+            {
+                config = load_json(config_file_name);
+            }
         }
         catch (json::exception &e)
         {
@@ -257,6 +264,7 @@ public:
 
     std::string       config_file_name;
     std::string       eqasm_compiler_name;
+    bool              loaded_from_image = false;    // the configuration was read from its platform image
 
 private:
 
@@ -9,42 +9,103 @@
 #ifndef INTERACTIONMATRIX_H
 #define INTERACTIONMATRIX_H
 
+#include <unordered_map>
+#include <tuple>
+#include <algorithm>
+
 #include "utils.h"
 #include "gate.h"
 #include "circuit.h"
 
 using namespace std;
 
+/**
+ * number of interactions per pair of qubits, where every two-qubit unitary
+ * gate counts as an interaction of its qubits; measurements, preparations,
+ * waits, barriers, displays and classical gates don't count, also not when
+ * they have two qubits; only the pairs that interact are stored
+ */
 class InteractionMatrix
 {
 private:
-    vector<vector<size_t>> Matrix;
+    unordered_map<size_t, size_t> Pairs;    // q0*Size+q1 with q0 < q1: number of interactions
     size_t Size;
 
 public:
     InteractionMatrix(): Size(0) {}
-    InteractionMatrix(ql::circuit ckt, size_t nqubits)
+    InteractionMatrix(const ql::circuit & ckt, size_t nqubits) : Size(nqubits)
+    {
+        add(ckt);
+    }
+
+    /**
+     * add the interactions of the gates in ckt
+     */
+    void add(const ql::circuit & ckt)
     {
-        Size = nqubits;
-        Matrix.resize(Size, vector<size_t>(Size, 0));
         for( auto ins : ckt )
         {
-            string insName = ins->qasm();
-            if(insName.find("cnot") != std::string::npos ) // for now the interaction matrix only for cnot
+            if( !isInteraction(ins) )
+            {
+                continue;
+            }
+            auto & operands = ins->operands;
+            size_t q0 = std::min(operands[0], operands[1]);
+            size_t q1 = std::max(operands[0], operands[1]);
+            if (q0 != q1 && q1 < Size)
             {
-                auto operands = ins->operands;
-                if( 2 == operands.size() )
-                {
-                    size_t operand0 = operands[0];
-                    size_t operand1 = operands[1];
-                    Matrix[operand0][operand1] += 1;
-                    Matrix[operand1][operand0] += 1;
-                }
+                Pairs[q0*Size+q1] += 1;
             }
         }
     }
 
-    string getString()
+    size_t getSize() const
+    {
+        return Size;
+    }
+
+    // number of interactions between qubits q0 and q1
+    size_t getInteractions(size_t q0, size_t q1) const
+    {
+        if (q0 > q1)
+        {
+            std::swap(q0, q1);
+        }
+        auto it = Pairs.find(q0*Size+q1);
+        return (it == Pairs.end() ? 0 : it->second);
+    }
+
+    /**
+     * the pairs of qubits that interact, as (q0, q1, number of interactions)
+     * with q0 < q1, sorted by q0 and q1
+     */
+    vector<tuple<size_t, size_t, size_t>> getPairs() const
+    {
+        vector<tuple<size_t, size_t, size_t>> pairs;
+        pairs.reserve(Pairs.size());
+        for (auto & p : Pairs)
+        {
+            pairs.push_back(make_tuple(p.first / Size, p.first % Size, p.second));
+        }
+        sort(pairs.begin(), pairs.end());
+        return pairs;
+    }
+
+    /**
+     * the interacting pairs as comma separated values, one pair per line
+     */
+    string getCSV() const
+    {
+        std::stringstream ss;
+        ss << "qubit0,qubit1,interactions" << endl;
+        for (auto & p : getPairs())
+        {
+            ss << get<0>(p) << "," << get<1>(p) << "," << get<2>(p) << endl;
+        }
+        return ss.str();
+    }
+
+    string getString() const
     {
         std::stringstream ss;
 
@@ -69,7 +130,7 @@ public:
             ss << ALIGNMENT << "q" + to_string(p);
             for (size_t c=0; c<Size; c++)
             {
-                ss << ALIGNMENT << Matrix[p][c];
+                ss << ALIGNMENT << getInteractions(p, c);
             }
             ss<<endl;
         }
@@ -78,6 +139,32 @@ public:
         return ss.str();
     }
 
+private:
+    static bool isInteraction(ql::gate * ins)
+    {
+        if (ins->operands.size() != 2)
+        {
+            return false;
+        }
+        auto type = ins->type();
+        if (type == ql::__classical_gate__ || type == ql::__wait_gate__ ||
+            type == ql::__measure_gate__ || type == ql::__prepz_gate__ ||
+            type == ql::__display__ || type == ql::__display_binary__)
+        {
+            return false;
+        }
+        // the name of a specialized custom gate is followed by its operands
+        const string & name = ins->name;
+        for (const string prefix : { "wait", "barrier", "measure", "prepz", "display" })
+        {
+            if (name.compare(0, prefix.size(), prefix) == 0 &&
+                (name.size() == prefix.size() || name[prefix.size()] == ' '))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
 };
 
 #endif
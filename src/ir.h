@@ -30,13 +30,19 @@ namespace ql
 
         typedef std::list<bundle_t>bundles_t;           // note that subsequent bundles can overlap in time
 
-        std::string qasm(bundles_t & bundles)
+        /**
+         * writes bundles as qasm one by one, as they become available,
+         * with waits for the cycles in between them
+         */
+        class qasm_writer
         {
-            std::stringstream ssqasm;
-            size_t curr_cycle=1;
+        public:
+            qasm_writer(std::ostream & out) : ssqasm(out), curr_cycle(1), last_duration(0)
+            {
+                ssqasm << '\n';
+            }
 
-            ssqasm << '\n';
-            for (bundle_t & abundle : bundles)
+            void write(bundle_t & abundle)
             {
                 auto st_cycle = abundle.start_cycle;
                 auto delta = st_cycle - curr_cycle;
@@ -67,16 +73,31 @@ namespace ql
                 if (ngates > 1) ssqasm << " }";
                 curr_cycle+=delta;
                 ssqasm << "\n";
+                last_duration = abundle.duration_in_cycles;
             }
 
-            if( !bundles.empty() )
+            // after the last bundle
+            void finish()
             {
-                auto & last_bundle = bundles.back();
-                int lsduration = last_bundle.duration_in_cycles;
-                if( lsduration > 1 )
-                    ssqasm << "    wait " << lsduration -1 << '\n';
+                if( last_duration > 1 )
+                    ssqasm << "    wait " << last_duration -1 << '\n';
             }
 
+        private:
+            std::ostream & ssqasm;
+            size_t curr_cycle;
+            size_t last_duration;
+        };
+
+        std::string qasm(bundles_t & bundles)
+        {
+            std::stringstream ssqasm;
+            qasm_writer writer(ssqasm);
+            for (bundle_t & abundle : bundles)
+            {
+                writer.write(abundle);
+            }
+            writer.finish();
             return ssqasm.str();
         }
 
@@ -10,13 +10,18 @@
 #define QL_KERNEL_H
 
 #include <sstream>
+#include <cstdint>
 #include <algorithm>
 #include <iterator>
+#include <memory>
+#include <random>
 
 #include "json.h"
 #include "utils.h"
 #include "options.h"
 #include "gate.h"
+#include "gate_dispatch.h"
+#include "clifford.h"
 #include "classical.h"
 #include "optimizer.h"
 #include "ir.h"
@@ -46,15 +51,25 @@ class quantum_kernel
 public:
 
     quantum_kernel(std::string name) :
-        name(name), iterations(1), type(kernel_type_t::STATIC) {}
+        name(name), iterations(1), type(kernel_type_t::STATIC)
+    {
+#ifndef __disable_lemon__
+        sched_cache = std::make_shared<Scheduler>();
+        backend_sched_cache = std::make_shared<Scheduler>();
+#endif // __disable_lemon__
+    }
 
-    quantum_kernel(std::string name, ql::quantum_platform& platform,
+    quantum_kernel(std::string name, const ql::quantum_platform& platform,
                    size_t qcount, size_t ccount=0) :
         name(name), iterations(1), qubit_count(qcount),
         creg_count(ccount), type(kernel_type_t::STATIC)
     {
-        gate_definition = platform.instruction_map;     // FIXME: confusing name change
+        gate_dispatch = platform.gate_dispatch;         // shares platform.instruction_map
         cycle_time = platform.cycle_time;
+#ifndef __disable_lemon__
+        sched_cache = std::make_shared<Scheduler>();
+        backend_sched_cache = std::make_shared<Scheduler>();
+#endif // __disable_lemon__
     }
 
     void set_static_loop_count(size_t it)
@@ -245,102 +260,110 @@ public:
      */
     void clifford(int id, size_t qubit=0)
     {
-        switch (id)
-        {
-        case 0 :
-            break;              //  ['I']
-        case 1 :
-            ry90(qubit);
-            rx90(qubit);
-            break;              //  ['Y90', 'X90']
-        case 2 :
-            mrx90(qubit);
-            mry90(qubit);
-            break;              //  ['mX90', 'mY90']
-        case 3 :
-            rx180(qubit);
-            break;              //  ['X180']
-        case 4 :
-            mry90(qubit);
-            mrx90(qubit);
-            break;              //  ['mY90', 'mX90']
-        case 5 :
-            rx90(qubit);
-            mry90(qubit);
-            break;              //  ['X90', 'mY90']
-        case 6 :
-            ry180(qubit);
-            break;              //  ['Y180']
-        case 7 :
-            mry90(qubit);
-            rx90(qubit);
-            break;              //  ['mY90', 'X90']
-        case 8 :
-            rx90(qubit);
-            ry90(qubit);
-            break;              //  ['X90', 'Y90']
-        case 9 :
-            rx180(qubit);
-            ry180(qubit);
-            break;              //  ['X180', 'Y180']
-        case 10:
-            ry90(qubit);
-            mrx90(qubit);
-            break;              //  ['Y90', 'mX90']
-        case 11:
-            mrx90(qubit);
-            ry90(qubit);
-            break;              //  ['mX90', 'Y90']
-        case 12:
-            ry90(qubit);
-            rx180(qubit);
-            break;              //  ['Y90', 'X180']
-        case 13:
-            mrx90(qubit);
-            break;              //  ['mX90']
-        case 14:
-            rx90(qubit);
-            mry90(qubit);
-            mrx90(qubit);
-            break;              //  ['X90', 'mY90', 'mX90']
-        case 15:
-            mry90(qubit);
-            break;              //  ['mY90']
-        case 16:
-            rx90(qubit);
-            break;              //  ['X90']
-        case 17:
-            rx90(qubit);
-            ry90(qubit);
-            rx90(qubit);
-            break;              //  ['X90', 'Y90', 'X90']
-        case 18:
-            mry90(qubit);
-            rx180(qubit);
-            break;              //  ['mY90', 'X180']
-        case 19:
-            rx90(qubit);
-            ry180(qubit);
-            break;              //  ['X90', 'Y180']
-        case 20:
-            rx90(qubit);
-            mry90(qubit);
-            rx90(qubit);
-            break;              //  ['X90', 'mY90', 'X90']
-        case 21:
-            ry90(qubit);
-            break;              //  ['Y90']
-        case 22:
-            mrx90(qubit);
-            ry180(qubit);
-            break;              //  ['mX90', 'Y180']
-        case 23:
-            rx90(qubit);
-            ry90(qubit);
-            mrx90(qubit);
-            break;              //  ['X90', 'Y90', 'mX90']
-        default:
-            break;
+        if (id < 0 || id >= (int)clifford_count)
+        {
+            return;
+        }
+        for (auto & pulse : clifford_tables_t::get().pulses(id))
+        {
+            gate(pulse, qubit);
+        }
+    }
+
+    /**
+     * randomized benchmarking sequence: on each of the qubits num_cliffords random
+     * cliffords, followed by the recovery that undoes them; cz_qubits lists pairs
+     * of qubits on which a cz is interleaved after each round of cliffords;
+     * without these, the recovery of each qubit is a single clifford found with
+     * the composition table, otherwise it is synthesized from the stabilizer
+     * tableau of the sequence and, with merge, its single qubit gates are merged
+     * into cliffords of native pulses, else added as hadamard, s, x and z gates
+     */
+    void randomized_benchmarking(const std::vector<size_t> & qubits, size_t num_cliffords,
+                                 const std::vector<size_t> & cz_qubits = {}, size_t seed = 0, bool merge = true)
+    {
+        // position of each qubit in the tableau
+        std::map<size_t, size_t> index;
+        for (size_t i=0; i<qubits.size(); i++)
+        {
+            if (qubits[i] >= qubit_count || !index.insert(std::make_pair(qubits[i], i)).second)
+            {
+                EOUT("invalid qubits for randomized benchmarking: " << ql::utils::to_string(qubits,"qubits"));
+                throw ql::exception("[x] error : ql::kernel::randomized_benchmarking() : invalid "+ql::utils::to_string(qubits,"qubits")+" !",false);
+            }
+        }
+        std::vector<size_t> cz_index;
+        for (auto q : cz_qubits)
+        {
+            if (cz_qubits.size() % 2 != 0 || index.find(q) == index.end())
+            {
+                EOUT("invalid cz qubit pairs for randomized benchmarking: " << ql::utils::to_string(cz_qubits,"cz qubits"));
+                throw ql::exception("[x] error : ql::kernel::randomized_benchmarking() : invalid "+ql::utils::to_string(cz_qubits,"cz qubits")+" !",false);
+            }
+            cz_index.push_back(index[q]);
+        }
+
+        const clifford_tables_t & tables = clifford_tables_t::get();
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<size_t> random_clifford(0, clifford_count-1);
+        std::vector<size_t> total(qubits.size(), 0);
+        clifford_tableau_t tableau(cz_qubits.empty() ? 0 : qubits.size());
+        for (size_t i=0; i<num_cliffords; i++)
+        {
+            for (size_t j=0; j<qubits.size(); j++)
+            {
+                size_t id = random_clifford(rng);
+                clifford(id, qubits[j]);
+                total[j] = tables.compose(total[j], id);
+                if (!cz_qubits.empty())
+                {
+                    tableau.clifford(id, j);
+                }
+            }
+            for (size_t k=0; k<cz_index.size(); k+=2)
+            {
+                cz(cz_qubits[k], cz_qubits[k+1]);
+                tableau.cz(cz_index[k], cz_index[k+1]);
+            }
+        }
+
+        if (cz_qubits.empty())
+        {
+            for (size_t j=0; j<qubits.size(); j++)
+            {
+                clifford(tables.inverse(total[j]), qubits[j]);
+            }
+            return;
+        }
+
+        std::vector<size_t> pending(qubits.size(), 0);    // merged clifford per qubit, not yet added
+        auto flush = [&](size_t j)
+        {
+            clifford(pending[j], qubits[j]);
+            pending[j] = 0;
+        };
+        for (auto & g : tableau.recovery())
+        {
+            size_t q = qubits[g.q0];
+            if (g.name == "cnot")
+            {
+                flush(g.q0);
+                flush(g.q1);
+                cnot(q, qubits[g.q1]);
+            }
+            else if (merge)
+            {
+                size_t id = (g.name == "h" ? tables.h : g.name == "s" ? tables.s : g.name == "x" ? tables.x : tables.z);
+                pending[g.q0] = tables.compose(pending[g.q0], id);
+            }
+            else if (g.name == "h") hadamard(q);
+            else if (g.name == "s") s(q);
+            else if (g.name == "x") x(q);
+            else                    z(q);
+        }
+        for (size_t j=0; j<qubits.size(); j++)
+        {
+            flush(j);
         }
     }
 
@@ -546,273 +569,151 @@ public:
         return result;
     }
 
-    bool add_custom_gate_if_available(std::string & gname, std::vector<size_t> qubits,
-                                      std::vector<size_t> cregs = {}, size_t duration=0, double angle=0.0)
+    /**
+     * gate definitions (instruction map) with their dispatch table; they are
+     * shared with the platform until custom instructions are loaded into this kernel
+     */
+    const gate_dispatch_t & get_gate_dispatch()
     {
-        bool added = false;
-
-        // first check if a specialized custom gate is available
-        std::string instr = gname + " ";
-        if(qubits.size() > 0)
+        if (!gate_dispatch)
         {
-            for (size_t i=0; i<(qubits.size()-1); ++i)
-                instr += "q" + std::to_string(qubits[i]) + ",";
-            if(qubits.size() >= 1) // to make if work with gates without operands
-                instr += "q" + std::to_string(qubits[qubits.size()-1]);
+            gate_dispatch = std::make_shared<const gate_dispatch_t>(instruction_map_t());
         }
+        return *gate_dispatch;
+    }
 
-        std::map<std::string,custom_gate*>::iterator it = gate_definition.find(instr);
-        if (it != gate_definition.end())
-        {
-            custom_gate* g = new custom_gate(*(it->second));
-            for(auto & qubit : qubits)
-                g->operands.push_back(qubit);
-            for(auto & cop : cregs)
-                g->creg_operands.push_back(cop);
-            if(duration>0) g->duration = duration;
-            g->angle = angle;
-            added = true;
-            c.push_back(g);
-        }
-        else
+    bool add_custom_gate_if_available(std::string & gname, std::vector<size_t> qubits,
+                                      std::vector<size_t> cregs = {}, size_t duration=0, double angle=0.0)
+    {
+        return add_custom_gate_if_available(get_gate_dispatch().find(gname), gname, qubits, cregs, duration, angle);
+    }
+
+    // first check if a specialized custom gate is available,
+    // otherwise, check if there is a parameterized custom gate (i.e. not specialized for arguments)
+    bool add_custom_gate_if_available(const gate_dispatch_t::entry_t * entry, const std::string & gname,
+                                      const std::vector<size_t> & qubits, const std::vector<size_t> & cregs = {},
+                                      size_t duration=0, double angle=0.0)
+    {
+        custom_gate * prototype = NULL;
+        if (entry != NULL)
         {
-            // otherwise, check if there is a parameterized custom gate (i.e. not specialized for arguments)
-            std::map<std::string,custom_gate*>::iterator it = gate_definition.find(gname);
-            if (it != gate_definition.end())
-            {
-                custom_gate* g = new custom_gate(*(it->second));
-                for(auto & qubit : qubits)
-                    g->operands.push_back(qubit);
-                for(auto & cop : cregs)
-                    g->creg_operands.push_back(cop);
-                if(duration>0) g->duration = duration;
-                g->angle = angle;
-                added = true;
-                c.push_back(g);
+            prototype = entry->prototype;
+            if (qubits.size() > 0)
+            {
+                auto it = entry->specialized.find(qubits);
+                if (it != entry->specialized.end())
+                {
+                    prototype = it->second;
+                }
             }
         }
 
-        if(added)
-        {
-            DOUT("custom gate added for " << gname);
-        }
-        else
+        if (prototype == NULL)
         {
             DOUT("custom gate not added for " << gname);
+            return false;
         }
 
-        return added;
+        add_custom_gate(prototype, qubits, cregs, duration, angle);
+        DOUT("custom gate added for " << gname);
+        return true;
     }
 
-    void get_decomposed_ins( ql::composite_gate * gptr, std::vector<std::string> & sub_instructons )
+    void add_custom_gate(const custom_gate * prototype, const std::vector<size_t> & qubits,
+                         const std::vector<size_t> & cregs, size_t duration=0, double angle=0.0)
     {
-        auto & sub_gates = gptr->gs;
-        DOUT("composite ins: " << gptr->name);
-        for(auto & agate : sub_gates)
-        {
-            std::string & sub_ins = agate->name;
-            DOUT("  sub ins: " << sub_ins);
-            auto it = gate_definition.find(sub_ins);
-            if( it != gate_definition.end() )
-            {
-                sub_instructons.push_back(sub_ins);
-            }
-            else
-            {
-                throw ql::exception("[x] error : ql::kernel::gate() : gate decomposition not available for '"+sub_ins+"'' in the target platform !",false);
-            }
-        }
+        custom_gate* g = new custom_gate(*prototype);
+        g->operands = qubits;
+        g->creg_operands.insert(g->creg_operands.end(), cregs.begin(), cregs.end());
+        if(duration>0) g->duration = duration;
+        g->angle = angle;
+        c.push_back(g);
     }
 
-    bool add_spec_decomposed_gate_if_available(std::string gate_name,
-            std::vector<size_t> all_qubits, std::vector<size_t> cregs = {})
+    // check if specialized composite gate is available,
+    // if not, check if parameterized composite gate is available
+    bool add_decomposed_gate_if_available(const gate_dispatch_t::entry_t * entry, const std::string & gate_name,
+            const std::vector<size_t> & all_qubits, const std::vector<size_t> & cregs = {})
     {
-        bool added = false;
-        DOUT("Checking if specialized decomposition is available for " << gate_name);
-        std::string instr_parameterized = gate_name + " ";
-        size_t i;
-        if(all_qubits.size() > 0)
+        if (entry == NULL || all_qubits.empty())
         {
-            for(i=0; i<all_qubits.size()-1; i++)
-            {
-                instr_parameterized += "q" + std::to_string(all_qubits[i]) + " ";
-            }
-            if(all_qubits.size() >= 1)
-            {
-                instr_parameterized += "q" + std::to_string(all_qubits[i]);
-            }
+            return false;
         }
-        DOUT("decomposed specialized instruction name: " << instr_parameterized);
 
-        auto it = gate_definition.find(instr_parameterized);
-        if( it != gate_definition.end() )
+        bool specialized = true;
+        auto sit = entry->spec_decompositions.find(all_qubits);
+        const gate_dispatch_t::decomposition_t * decomposition = NULL;
+        if (sit != entry->spec_decompositions.end())
         {
-            DOUT("specialized composite gate found for " << instr_parameterized);
-            composite_gate * gptr = (composite_gate *)(it->second);
-            if( __composite_gate__ == gptr->type() )
-            {
-                DOUT("composite gate type");
-            }
-            else
+            decomposition = &sit->second;
+        }
+        else
+        {
+            auto pit = entry->param_decompositions.find(all_qubits.size());
+            if (pit == entry->param_decompositions.end())
             {
-                DOUT("Not a composite gate type");
+                DOUT("composite gate not found for " << gate_name);
                 return false;
             }
-
-
-            std::vector<std::string> sub_instructons;
-            get_decomposed_ins( gptr, sub_instructons );
-            for(auto & sub_ins : sub_instructons)
-            {
-                DOUT("Adding sub ins: " << sub_ins);
-                std::replace( sub_ins.begin(), sub_ins.end(), ',', ' ');
-                DOUT(" after comma removal, sub ins: " << sub_ins);
-                std::istringstream iss(sub_ins);
-
-                std::vector<std::string> tokens{ std::istream_iterator<std::string>{iss},
-                                                 std::istream_iterator<std::string>{} };
-
-                std::vector<size_t> this_gate_qubits;
-                std::string & sub_ins_name = tokens[0];
-
-                for(size_t i=1; i<tokens.size(); i++)
-                {
-                    DOUT("tokens[i] : " << tokens[i]);
-                    auto sub_str_token = tokens[i].substr(1);
-                    DOUT("sub_str_token[i] : " << sub_str_token);
-                    this_gate_qubits.push_back( stoi( tokens[i].substr(1) ) );
-                }
-
-                DOUT( ql::utils::to_string<size_t>(this_gate_qubits, "actual qubits of this gate:") );
-
-                // custom gate check
-                bool custom_added = add_custom_gate_if_available(sub_ins_name, this_gate_qubits, cregs);
-                if(!custom_added)
-                {
-                    if(ql::options::get("use_default_gates") == "yes")
-                    {
-                        // default gate check
-                        DOUT("adding default gate for " << sub_ins_name);
-                        bool default_available = add_default_gate_if_available(sub_ins_name, this_gate_qubits, cregs);
-                        if( default_available )
-                        {
-                            WOUT("added default gate '" << sub_ins_name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
-                        }
-                        else
-                        {
-                            EOUT("unknown gate '" << sub_ins_name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
-                            throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+sub_ins_name+"' with " +ql::utils::to_string(this_gate_qubits,"qubits")+" is not supported by the target platform !",false);
-                        }
-                    }
-                    else
-                    {
-                        EOUT("unknown gate '" << sub_ins_name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
-                        throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+sub_ins_name+"' with " +ql::utils::to_string(this_gate_qubits,"qubits")+" is not supported by the target platform !",false);
-                    }
-                }
-            }
-            added = true;
+            decomposition = &pit->second;
+            specialized = false;
         }
-        else
+        DOUT((specialized ? "specialized" : "parameterized") << " composite gate found for " << gate_name);
+        if (!decomposition->error.empty())
         {
-            DOUT("composite gate not found for " << instr_parameterized);
+            throw ql::exception(decomposition->error,false);
         }
 
-        return added;
-    }
-
-
-    bool add_param_decomposed_gate_if_available(std::string gate_name,
-            std::vector<size_t> all_qubits, std::vector<size_t> cregs = {})
-    {
-        bool added = false;
-        DOUT("Checking if parameterized decomposition is available for " << gate_name);
-        std::string instr_parameterized = gate_name + " ";
-        size_t i;
-        if(all_qubits.size() > 0)
+        std::vector<size_t> this_gate_qubits;
+        for(auto & sub : decomposition->sub_gates)
         {
-            for(i=0; i<all_qubits.size()-1; i++)
-            {
-                instr_parameterized += "%" + std::to_string(i) + " ";
-            }
-            if(all_qubits.size() >= 1)
+            if (specialized)
             {
-                instr_parameterized += "%" + std::to_string(i);
+                this_gate_qubits = sub.operands;
             }
-        }
-        DOUT("decomposed parameterized instruction name: " << instr_parameterized);
-
-        // check for composite ins
-        auto it = gate_definition.find(instr_parameterized);
-        if( it != gate_definition.end() )
-        {
-            DOUT("parameterized composite gate found for " << instr_parameterized);
-            composite_gate * gptr = (composite_gate *)(it->second);
-            if( __composite_gate__ == gptr->type() )
+            else
             {
-                DOUT("composite gate type");
+                this_gate_qubits.clear();
+                for(auto i : sub.operands)
+                {
+                    this_gate_qubits.push_back( all_qubits[i] );
+                }
             }
-            else
+            if (sub.prototype != NULL)
             {
-                DOUT("Not a composite gate type");
-                return false;
+                // custom gate resolved when the platform was loaded
+                add_custom_gate(sub.prototype, this_gate_qubits, cregs);
+                continue;
             }
+            DOUT("Adding sub ins: " << sub.name << " " << ql::utils::to_string<size_t>(this_gate_qubits, "actual qubits of this gate:") );
 
-            std::vector<std::string> sub_instructons;
-            get_decomposed_ins( gptr, sub_instructons );
-            for(auto & sub_ins : sub_instructons)
+            // custom gate check
+            bool custom_added = add_custom_gate_if_available(sub.entry, sub.name, this_gate_qubits, cregs);
+            if(!custom_added)
             {
-                DOUT("Adding sub ins: " << sub_ins);
-                std::replace( sub_ins.begin(), sub_ins.end(), ',', ' ');
-                DOUT(" after comma removal, sub ins: " << sub_ins);
-                std::istringstream iss(sub_ins);
-
-                std::vector<std::string> tokens{ std::istream_iterator<std::string>{iss},
-                                                 std::istream_iterator<std::string>{} };
-
-                std::vector<size_t> this_gate_qubits;
-                std::string & sub_ins_name = tokens[0];
-
-                for(size_t i=1; i<tokens.size(); i++)
-                {
-                    this_gate_qubits.push_back( all_qubits[ stoi( tokens[i].substr(1) ) ] );
-                }
-
-                DOUT( ql::utils::to_string<size_t>(this_gate_qubits, "actual qubits of this gate:") );
-
-                // custom gate check
-                bool custom_added = add_custom_gate_if_available(sub_ins_name, this_gate_qubits, cregs);
-                if(!custom_added)
+                if(ql::options::get("use_default_gates") == "yes")
                 {
-                    if(ql::options::get("use_default_gates") == "yes")
+                    // default gate check
+                    DOUT("adding default gate for " << sub.name);
+                    bool default_available = add_default_gate_if_available(sub.name, this_gate_qubits, cregs);
+                    if( default_available )
                     {
-                        // default gate check
-                        DOUT("adding default gate for " << sub_ins_name);
-                        bool default_available = add_default_gate_if_available(sub_ins_name, this_gate_qubits, cregs);
-                        if( default_available )
-                        {
-                            WOUT("added default gate '" << sub_ins_name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
-                        }
-                        else
-                        {
-                            EOUT("unknown gate '" << sub_ins_name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
-                            throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+sub_ins_name+"' with " +ql::utils::to_string(this_gate_qubits,"qubits")+" is not supported by the target platform !",false);
-                        }
+                        WOUT("added default gate '" << sub.name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
                     }
                     else
                     {
-                        EOUT("unknown gate '" << sub_ins_name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
-                        throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+sub_ins_name+"' with " +ql::utils::to_string(this_gate_qubits,"qubits")+" is not supported by the target platform !",false);
+                        EOUT("unknown gate '" << sub.name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
+                        throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+sub.name+"' with " +ql::utils::to_string(this_gate_qubits,"qubits")+" is not supported by the target platform !",false);
                     }
                 }
+                else
+                {
+                    EOUT("unknown gate '" << sub.name << "' with " << ql::utils::to_string(this_gate_qubits,"qubits") );
+                    throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+sub.name+"' with " +ql::utils::to_string(this_gate_qubits,"qubits")+" is not supported by the target platform !",false);
+                }
             }
-            added = true;
         }
-        else
-        {
-            DOUT("composite gate not found for " << instr_parameterized);
-        }
-        return added;
+        return true;
     }
 
 
@@ -867,44 +768,85 @@ public:
         str::lower_case(gname);
         DOUT("Adding gate : " << gname << " with " << ql::utils::to_string(qubits,"qubits"));
 
-        // specialized composite gate check
-        DOUT("trying to add specialized decomposed gate for: " << gname);
-        bool spec_decom_added = add_spec_decomposed_gate_if_available(gname, qubits);
-        if(spec_decom_added)
+        // all definitions of gname, found in one lookup
+        add_gate(get_gate_dispatch().find(gname), gname, qubits, cregs, duration, angle);
+        DOUT("");
+    }
+
+    /**
+     * add n gates in one call, e.g. from NumPy arrays; gate i is names[ids[i]]
+     * on qubit q0[i] and, when q1[i] is not negative, on qubit q1[i], with angle
+     * angles[i]; the arrays are read in place, the names are resolved once
+     */
+    void gates(const std::vector<std::string> & names, size_t n, const int64_t * ids,
+               const int64_t * q0, const int64_t * q1, const double * angles)
+    {
+        std::vector<std::string> gnames(names);
+        std::vector<const gate_dispatch_t::entry_t *> entries;
+        for (auto & gname : gnames)
         {
-            DOUT("specialized decomposed gates added for " << gname);
+            str::lower_case(gname);
+            entries.push_back(get_gate_dispatch().find(gname));
         }
-        else
+
+        // check all operands first so that nothing is added when one is out of range
+        for (size_t i=0; i<n; i++)
         {
-            // parameterized composite gate check
-            DOUT("trying to add parameterized decomposed gate for: " << gname);
-            bool param_decom_added = add_param_decomposed_gate_if_available(gname, qubits);
-            if(param_decom_added)
+            if (ids[i] < 0 || (size_t)ids[i] >= gnames.size())
             {
-                DOUT("decomposed gates added for " << gname);
+                EOUT("gate id " << ids[i] << " of gate " << i << " out of range, " << gnames.size() << " gate names given");
+                throw ql::exception("[x] error : ql::kernel::gates() : gate id "+std::to_string(ids[i])+" of gate "+std::to_string(i)+" out of range, "+std::to_string(gnames.size())+" gate names given !",false);
             }
-            else
+            if (q0[i] < 0 || q0[i] >= (int64_t)qubit_count || q1[i] >= (int64_t)qubit_count)
             {
-                // specialized/parameterized custom gate check
-                DOUT("adding custom gate for " << gname);
-                bool custom_added = add_custom_gate_if_available(gname, qubits, cregs, duration, angle);
-                if(!custom_added)
+                EOUT("Number of qubits in platform: " << std::to_string(qubit_count) << ", specified qubit numbers out of range for gate: '" << gnames[ids[i]] << "' with qubits " << q0[i] << ", " << q1[i]);
+                throw ql::exception("[x] error : ql::kernel::gates() : Number of qubits in platform: "+std::to_string(qubit_count)+", specified qubit numbers out of range for gate '"+gnames[ids[i]]+"' with qubits "+std::to_string(q0[i])+", "+std::to_string(q1[i])+" !",false);
+            }
+        }
+
+        c.reserve(c.size() + n);
+        std::vector<size_t> qubits;
+        for (size_t i=0; i<n; i++)
+        {
+            qubits.assign(1, q0[i]);
+            if (q1[i] >= 0)
+            {
+                qubits.push_back(q1[i]);
+            }
+            add_gate(entries[ids[i]], gnames[ids[i]], qubits, {}, 0, angles[i]);
+        }
+    }
+
+    /**
+     * add gate gname, with entry its dispatch table entry, after its operands have been checked
+     */
+    void add_gate(const gate_dispatch_t::entry_t * entry, const std::string & gname,
+                  const std::vector<size_t> & qubits, const std::vector<size_t> & cregs,
+                  size_t duration, double angle)
+    {
+        // specialized/parameterized composite gate check
+        DOUT("trying to add decomposed gate for: " << gname);
+        bool decom_added = add_decomposed_gate_if_available(entry, gname, qubits);
+        if(decom_added)
+        {
+            DOUT("decomposed gates added for " << gname);
+        }
+        else
+        {
+            // specialized/parameterized custom gate check
+            DOUT("adding custom gate for " << gname);
+            bool custom_added = add_custom_gate_if_available(entry, gname, qubits, cregs, duration, angle);
+            if(!custom_added)
+            {
+                if(ql::options::get("use_default_gates") == "yes")
                 {
-                    if(ql::options::get("use_default_gates") == "yes")
+                    // default gate check (which is always parameterized)
+                    DOUT("adding default gate for " << gname);
+
+                    bool default_available = add_default_gate_if_available(gname, qubits, cregs, duration, angle);
+                    if( default_available )
                     {
-                        // default gate check (which is always parameterized)
-                        DOUT("adding default gate for " << gname);
-
-                        bool default_available = add_default_gate_if_available(gname, qubits, cregs, duration);
-                        if( default_available )
-                        {
-                            WOUT("default gate added for " << gname);
-                        }
-                        else
-                        {
-                            EOUT("unknown gate '" << gname << "' with " << ql::utils::to_string(qubits,"qubits") );
-                            throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+gname+"' with " +ql::utils::to_string(qubits,"qubits")+" is not supported by the target platform !",false);
-                        }
+                        WOUT("default gate added for " << gname);
                     }
                     else
                     {
@@ -914,11 +856,15 @@ public:
                 }
                 else
                 {
-                    DOUT("custom gate added for " << gname);
+                    EOUT("unknown gate '" << gname << "' with " << ql::utils::to_string(qubits,"qubits") );
+                    throw ql::exception("[x] error : ql::kernel::gate() : the gate '"+gname+"' with " +ql::utils::to_string(qubits,"qubits")+" is not supported by the target platform !",false);
                 }
             }
+            else
+            {
+                DOUT("custom gate added for " << gname);
+            }
         }
-        DOUT("");
     }
 
     // FIXME: is this really QASM, or CC-light eQASM?
@@ -997,6 +943,23 @@ public:
         return  ss.str();
     }
 
+    /**
+     * structural key of the kernel: its classical register count and, per gate,
+     * the qasm, duration and angle; the name, type and iterations are left out,
+     * so kernels that only differ in those schedule to the same bundles
+     */
+    std::string structure()
+    {
+        std::stringstream ss;
+        ss.precision(17);
+        ss << creg_count << "\n";
+        for (auto g : c)
+        {
+            ss << g->qasm() << " " << g->duration << " " << g->angle << "\n";
+        }
+        return ss.str();
+    }
+
     void classical(creg& destination, operation & oper)
     {
         // check sanity of destination
@@ -1080,43 +1043,41 @@ public:
 
     }
 
+    /**
+     * decompose all toffoli gates in one pass over the circuit: each is replaced
+     * in place by the gates of the template of the decompose_toffoli option,
+     * resolved once for the whole circuit
+     */
     void decompose_toffoli()
     {
         DOUT("decompose_toffoli()");
-        for( auto cit = c.begin(); cit != c.end(); ++cit )
-        {
-            auto g = *cit;
-            ql::gate_type_t gtype = g->type();
-            std::vector<size_t> goperands = g->operands;
+        const gate_template_t & decomposition = toffoli_template(ql::options::get("decompose_toffoli"));
+        std::vector<const gate_dispatch_t::entry_t *> entries;
 
-            ql::quantum_kernel toff_kernel("toff_kernel");
-            toff_kernel.gate_definition = gate_definition;
-            toff_kernel.qubit_count = qubit_count;
-            toff_kernel.cycle_time = cycle_time;
+        size_t toffoli_count = std::count_if(c.begin(), c.end(),
+            [](ql::gate * g) { return __toffoli_gate__ == g->type(); });
+        if (toffoli_count == 0)
+        {
+            DOUT("decompose_toffoli() [Done] ");
+            return;
+        }
 
-            if( __toffoli_gate__ == gtype )
+        ql::circuit input;
+        input.swap(c);
+        c.reserve(input.size() + toffoli_count*(decomposition.size()-1));
+        for (auto g : input)
+        {
+            if (__toffoli_gate__ != g->type())
             {
-                size_t cq1 = goperands[0];
-                size_t cq2 = goperands[1];
-                size_t tq = goperands[2];
-                auto opt = ql::options::get("decompose_toffoli");
-                if ( opt == "AM" )
-                {
-                    toff_kernel.controlled_cnot_AM(tq, cq1, cq2);
-                }
-                else
-                {
-                    toff_kernel.controlled_cnot_NC(tq, cq1, cq2);
-                }
-                ql::circuit& toff_ckt = toff_kernel.get_circuit();
-                cit = c.erase(cit);
-                cit = c.insert(cit, toff_ckt.begin(), toff_ckt.end());
+                c.push_back(g);
+                continue;
             }
+            add_template(decomposition, g->operands, 0.0, entries);
         }
         DOUT("decompose_toffoli() [Done] ");
     }
 
-    void schedule(quantum_platform platform, std::string& sched_qasm,
+    void schedule(const quantum_platform & platform, std::string& sched_qasm,
         std::string & dot, std::string& sched_dot)
     {
         std::string scheduler = ql::options::get("scheduler");
@@ -1126,8 +1087,26 @@ public:
 #ifndef __disable_lemon__
         IOUT( scheduler << " scheduling the quantum kernel '" << name << "'...");
 
-        Scheduler sched;
-        sched.init(c, platform, qubit_count, creg_count);
+        size_t window_size = Scheduler::get_window_size();
+        if (window_size > 0)
+        {
+            if ("ASAP" == scheduler && "no" == scheduler_uniform)
+            {
+                // streaming, without creating the dependence graph;
+                // each bundle is written out when it is complete
+                Scheduler sched;
+                std::stringstream ssqasm;
+                ql::ir::qasm_writer writer(ssqasm);
+                sched.schedule_asap_window(c, platform, qubit_count, creg_count, window_size, nullptr,
+                    [&writer](ql::ir::bundle_t & abundle) { writer.write(abundle); });
+                writer.finish();
+                sched_qasm = get_prologue() + ssqasm.str() + get_epilogue();
+                return;
+            }
+            WOUT("scheduler_window only applies to non-uniform ASAP scheduling; scheduling on the dependence graph");
+        }
+        Scheduler & sched = *sched_cache;
+        sched.update(c, platform, qubit_count, creg_count);
 
         if(ql::options::get("print_dot_graphs") == "yes")
         {
@@ -1245,7 +1224,9 @@ public:
      */
     int load_custom_instructions(std::string file_name="instructions.json")
     {
+        instruction_map_t gate_definition(get_gate_dispatch().gate_definition);
         load_instructions(gate_definition,file_name);
+        gate_dispatch = std::make_shared<const gate_dispatch_t>(gate_definition);
         return 0;
     }
 
@@ -1254,7 +1235,8 @@ public:
      */
     void print_gates_definition()
     {
-        for (std::map<std::string,custom_gate*>::iterator i=gate_definition.begin(); i!=gate_definition.end(); i++)
+        auto & gate_definition = get_gate_dispatch().gate_definition;
+        for (auto i=gate_definition.begin(); i!=gate_definition.end(); i++)
         {
             COUT("[-] gate '" << i->first << "'");
 #if OPT_MICRO_CODE
@@ -1267,7 +1249,8 @@ public:
     {
         std::stringstream ss;
 
-        for (std::map<std::string,custom_gate*>::iterator i=gate_definition.begin(); i!=gate_definition.end(); i++)
+        auto & gate_definition = get_gate_dispatch().gate_definition;
+        for (auto i=gate_definition.begin(); i!=gate_definition.end(); i++)
         {
             ss << i->first << '\n';
         }
@@ -1294,43 +1277,206 @@ public:
     | Controlled gates
     \************************************************************************/
 
+    // gate of a fixed decomposition: its name, its operands as indices in the
+    // operands of the decomposed gate and, for rx, ry and rz, the factor of the
+    // angle of the decomposition that is its angle
+    struct template_gate_t
+    {
+        std::string name;
+        std::vector<size_t> operands;
+        double angle;
+    };
+    typedef std::vector<template_gate_t> gate_template_t;
+
+    /**
+     * toffoli decomposition on operands 0: first control, 1: second control, 2: target;
+     * AM from: https://arxiv.org/pdf/1210.0974.pdf, Quantum circuits of T-depth one;
+     * otherwise Neilsen and Chuang
+     */
+    static const gate_template_t & toffoli_template(const std::string & mode)
+    {
+        static const gate_template_t am = {
+            {"hadamard", {2}}, {"t", {0}}, {"t", {1}}, {"t", {2}},
+            {"cnot", {1, 0}}, {"cnot", {2, 1}}, {"cnot", {0, 2}},
+            {"tdag", {1}}, {"cnot", {0, 1}}, {"tdag", {0}}, {"tdag", {1}}, {"tdag", {2}},
+            {"cnot", {2, 1}}, {"cnot", {0, 2}}, {"cnot", {1, 0}}, {"hadamard", {2}}
+        };
+        static const gate_template_t nc = {
+            {"hadamard", {2}}, {"cnot", {1, 2}}, {"tdag", {2}}, {"cnot", {0, 2}},
+            {"t", {2}}, {"cnot", {1, 2}}, {"tdag", {2}}, {"cnot", {0, 2}},
+            {"tdag", {1}}, {"t", {2}}, {"cnot", {0, 1}}, {"hadamard", {2}},
+            {"tdag", {1}}, {"cnot", {0, 1}}, {"t", {0}}, {"s", {1}}
+        };
+        return (mode == "AM" ? am : nc);
+    }
+
+    /**
+     * controlled version of a gate, as template on 0: first operand of the gate,
+     * 1: its second operand, 2: control qubit, 3: ancilla qubit; its rotations
+     * are over the angle of the gate or over a fixed angle
+     */
+    struct controlled_template_t
+    {
+        gate_template_t gates;
+        bool gate_angle;
+        double angle;
+    };
+
+    /**
+     * controlled templates by gate type, except cnot, see controlled_cnot_template;
+     * from: https://arxiv.org/pdf/1206.0758v3.pdf, A meet-in-the-middle algorithm
+     * for fast synthesis of depth-optimal quantum circuits, for x, y, z, h, s, sdag,
+     * t and tdag, and from: https://arxiv.org/pdf/1210.0974.pdf, Quantum circuits
+     * of T-depth one, for swap
+     */
+    static const std::map<gate_type_t, controlled_template_t> & controlled_templates()
+    {
+        enum { T = 0, U = 1, C = 2, A = 3 };
+        static const gate_template_t cx = { {"cnot", {C, T}} };
+        static const gate_template_t cy = { {"sdag", {T}}, {"cnot", {C, T}}, {"s", {T}} };
+        static const gate_template_t crx = { {"rx", {T}, 0.5}, {"cz", {C, T}}, {"rx", {T}, -0.5}, {"cz", {C, T}} };
+        static const gate_template_t cry = { {"ry", {T}, 0.5}, {"cnot", {C, T}}, {"ry", {T}, -0.5}, {"cnot", {C, T}} };
+        static const gate_template_t crz = { {"rz", {T}, 0.5}, {"cnot", {C, T}}, {"rz", {T}, -0.5}, {"cnot", {C, T}} };
+        static const std::map<gate_type_t, controlled_template_t> templates = {
+            { __pauli_x_gate__, { cx, false, 0 } },
+            { __rx180_gate__, { cx, false, 0 } },
+            { __pauli_y_gate__, { cy, false, 0 } },
+            { __ry180_gate__, { cy, false, 0 } },
+            { __pauli_z_gate__, { {
+                {"hadamard", {T}}, {"cnot", {C, T}}, {"hadamard", {T}}
+            }, false, 0 } },
+            { __hadamard_gate__, { {
+                {"s", {T}}, {"hadamard", {T}}, {"t", {T}}, {"cnot", {C, T}},
+                {"tdag", {T}}, {"hadamard", {T}}, {"sdag", {T}}
+            }, false, 0 } },
+            { __identity_gate__, { {}, false, 0 } },
+            { __phase_gate__, { {
+                {"cnot", {T, C}}, {"tdag", {C}}, {"cnot", {T, C}}, {"t", {C}}, {"t", {T}}
+            }, false, 0 } },
+            { __phasedag_gate__, { {
+                {"tdag", {C}}, {"tdag", {T}}, {"cnot", {T, C}}, {"t", {C}}, {"cnot", {T, C}}
+            }, false, 0 } },
+            { __t_gate__, { {
+                {"cnot", {C, T}}, {"hadamard", {A}}, {"sdag", {C}}, {"cnot", {T, A}},
+                {"cnot", {A, C}}, {"t", {C}}, {"tdag", {A}}, {"cnot", {T, C}},
+                {"cnot", {T, A}}, {"t", {C}}, {"tdag", {A}}, {"cnot", {A, C}},
+                {"hadamard", {C}}, {"t", {C}}, {"hadamard", {C}}, {"cnot", {A, C}},
+                {"tdag", {C}}, {"t", {A}}, {"cnot", {T, A}}, {"cnot", {T, C}},
+                {"t", {A}}, {"tdag", {C}}, {"cnot", {A, C}}, {"s", {C}},
+                {"cnot", {T, A}}, {"cnot", {C, T}}, {"hadamard", {A}}
+            }, false, 0 } },
+            { __tdag_gate__, { {
+                {"hadamard", {A}}, {"cnot", {C, T}}, {"sdag", {C}}, {"cnot", {T, A}},
+                {"cnot", {A, C}}, {"t", {C}}, {"cnot", {T, C}}, {"tdag", {A}},
+                {"cnot", {T, A}}, {"t", {C}}, {"tdag", {A}}, {"cnot", {A, C}},
+                {"hadamard", {C}}, {"tdag", {C}}, {"hadamard", {C}}, {"cnot", {A, C}},
+                {"tdag", {C}}, {"t", {A}}, {"cnot", {T, A}}, {"cnot", {T, C}},
+                {"tdag", {C}}, {"t", {A}}, {"cnot", {A, C}}, {"s", {C}},
+                {"cnot", {T, A}}, {"cnot", {C, T}}, {"hadamard", {A}}
+            }, false, 0 } },
+            { __swap_gate__, { {
+                {"cnot", {U, T}}, {"cnot", {C, T}}, {"hadamard", {U}}, {"t", {C}},
+                {"tdag", {T}}, {"t", {U}}, {"cnot", {U, T}}, {"cnot", {C, U}},
+                {"t", {T}}, {"cnot", {C, T}}, {"tdag", {U}}, {"tdag", {T}},
+                {"cnot", {C, U}}, {"cnot", {U, T}}, {"t", {T}}, {"hadamard", {U}},
+                {"cnot", {U, T}}
+            }, false, 0 } },
+            { __rx_gate__, { crx, true, 0 } },
+            { __ry_gate__, { cry, true, 0 } },
+            { __rz_gate__, { crz, true, 0 } },
+            { __rx90_gate__, { crx, false, PI/2 } },
+            { __mrx90_gate__, { crx, false, -PI/2 } },
+            { __ry90_gate__, { cry, false, PI/4 } },
+            { __mry90_gate__, { cry, false, -PI/4 } }
+        };
+        return templates;
+    }
+
+    /**
+     * controlled cnot: the toffoli decomposition of the decompose_toffoli option, or a toffoli
+     */
+    static const gate_template_t & controlled_cnot_template(const std::string & mode)
+    {
+        // toffoli operands from the controlled template operands
+        static auto remap = [](const gate_template_t & toffoli)
+        {
+            gate_template_t gates(toffoli);
+            for (auto & tg : gates)
+            {
+                for (auto & o : tg.operands)
+                {
+                    o = (o == 0 ? 0 : o == 1 ? 2 : 1);
+                }
+            }
+            return gates;
+        };
+        static const gate_template_t am = remap(toffoli_template("AM"));
+        static const gate_template_t nc = remap(toffoli_template("NC"));
+        static const gate_template_t no = { {"toffoli", {0, 2, 1}} };
+        return (mode == "AM" ? am : mode == "NC" ? nc : no);
+    }
+
+    void add_template(const gate_template_t & decomposition, const std::vector<size_t> & operands, double angle = 0.0)
+    {
+        std::vector<const gate_dispatch_t::entry_t *> entries;
+        add_template(decomposition, operands, angle, entries);
+    }
+
+    // entries: dispatch entries of the gates of the template, resolved on first use;
+    // rx, ry, rz and toffoli are added as is, like their methods do
+    void add_template(const gate_template_t & decomposition, const std::vector<size_t> & operands, double angle,
+                      std::vector<const gate_dispatch_t::entry_t *> & entries)
+    {
+        if (entries.empty())
+        {
+            for (auto & tg : decomposition)
+            {
+                entries.push_back(get_gate_dispatch().find(tg.name));
+            }
+        }
+
+        std::vector<size_t> qubits;
+        for (size_t i=0; i<decomposition.size(); i++)
+        {
+            const template_gate_t & tg = decomposition[i];
+            qubits.clear();
+            for (auto o : tg.operands)
+            {
+                qubits.push_back(operands[o]);
+                if (qubits.back() >= qubit_count)
+                {
+                    EOUT("Number of qubits in platform: " << std::to_string(qubit_count) << ", specified qubit numbers out of range for gate: '" << tg.name << "' with " << ql::utils::to_string(qubits,"qubits") );
+                    throw ql::exception("[x] error : ql::kernel::gate() : Number of qubits in platform: "+std::to_string(qubit_count)+", specified qubit numbers out of range for gate '"+tg.name+"' with " +ql::utils::to_string(qubits,"qubits")+" !",false);
+                }
+            }
+            if (tg.name == "rx")
+                c.push_back(new ql::rx(qubits[0], tg.angle*angle));
+            else if (tg.name == "ry")
+                c.push_back(new ql::ry(qubits[0], tg.angle*angle));
+            else if (tg.name == "rz")
+                c.push_back(new ql::rz(qubits[0], tg.angle*angle));
+            else if (tg.name == "toffoli")
+                c.push_back(new ql::toffoli(qubits[0], qubits[1], qubits[2]));
+            else
+                add_gate(entries[i], tg.name, qubits, {}, 0, 0.0);
+        }
+    }
+
     void controlled_x(size_t tq, size_t cq)
     {
-        // from: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-        cnot(cq, tq);
+        add_template(controlled_templates().at(__pauli_x_gate__).gates, {tq, 0, cq, 0});
     }
     void controlled_y(size_t tq, size_t cq)
     {
-        // from: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-        sdag(tq);
-        cnot(cq, tq);
-        s(tq);
+        add_template(controlled_templates().at(__pauli_y_gate__).gates, {tq, 0, cq, 0});
     }
     void controlled_z(size_t tq, size_t cq)
     {
-        // from: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-        hadamard(tq);
-        cnot(cq, tq);
-        hadamard(tq);
+        add_template(controlled_templates().at(__pauli_z_gate__).gates, {tq, 0, cq, 0});
     }
     void controlled_h(size_t tq, size_t cq)
     {
-        // from: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-        s(tq);
-        hadamard(tq);
-        t(tq);
-        cnot(cq, tq);
-        tdag(tq);
-        hadamard(tq);
-        sdag(tq);
+        add_template(controlled_templates().at(__hadamard_gate__).gates, {tq, 0, cq, 0});
     }
     void controlled_i(size_t tq, size_t cq)
     {
@@ -1339,104 +1485,24 @@ public:
 
     void controlled_s(size_t tq, size_t cq)
     {
-        // cphase(cq, tq);
-
-        // from: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-
-        cnot(tq, cq);
-        tdag(cq);
-        cnot(tq, cq);
-        t(cq);
-        t(tq);
+        add_template(controlled_templates().at(__phase_gate__).gates, {tq, 0, cq, 0});
     }
 
     void controlled_sdag(size_t tq, size_t cq)
     {
-        // based on: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-
-        tdag(cq);
-        tdag(tq);
-        cnot(tq, cq);
-        t(cq);
-        cnot(tq, cq);
+        add_template(controlled_templates().at(__phasedag_gate__).gates, {tq, 0, cq, 0});
     }
 
     void controlled_t(size_t tq, size_t cq, size_t aq)
     {
         WOUT("Controlled-T implementation requires an ancilla");
-        WOUT("At the moment, Qubit 0 is used as ancilla");
-        WOUT("This will change when Qubit allocater is implemented");
-        // from: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-        cnot(cq, tq);
-        hadamard(aq);
-        sdag(cq);
-        cnot(tq, aq);
-        cnot(aq, cq);
-        t(cq);
-        tdag(aq);
-        cnot(tq, cq);
-        cnot(tq, aq);
-        t(cq);
-        tdag(aq);
-        cnot(aq, cq);
-        h(cq);
-        t(cq);
-        h(cq);
-        cnot(aq, cq);
-        tdag(cq);
-        t(aq);
-        cnot(tq, aq);
-        cnot(tq, cq);
-        t(aq);
-        tdag(cq);
-        cnot(aq, cq);
-        s(cq);
-        cnot(tq, aq);
-        cnot(cq, tq);
-        h(aq);
+        add_template(controlled_templates().at(__t_gate__).gates, {tq, 0, cq, aq});
     }
 
     void controlled_tdag(size_t tq, size_t cq, size_t aq)
     {
         WOUT("Controlled-Tdag implementation requires an ancilla");
-        WOUT("At the moment, Qubit 0 is used as ancilla");
-        WOUT("This will change when Qubit allocater is implemented");
-        // from: https://arxiv.org/pdf/1206.0758v3.pdf
-        // A meet-in-the-middle algorithm for fast synthesis
-        // of depth-optimal quantum circuits
-        h(aq);
-        cnot(cq, tq);
-        sdag(cq);
-        cnot(tq, aq);
-        cnot(aq, cq);
-        t(cq);
-        cnot(tq, cq);
-        tdag(aq);
-        cnot(tq, aq);
-        t(cq);
-        tdag(aq);
-        cnot(aq, cq);
-        h(cq);
-        tdag(cq);
-        h(cq);
-        cnot(aq, cq);
-        tdag(cq);
-        t(aq);
-        cnot(tq, aq);
-        cnot(tq, cq);
-        tdag(cq);
-        t(aq);
-        cnot(aq, cq);
-        s(cq);
-        cnot(tq, aq);
-        cnot(cq, tq);
-        hadamard(aq);
+        add_template(controlled_templates().at(__tdag_gate__).gates, {tq, 0, cq, aq});
     }
 
     void controlled_ix(size_t tq, size_t cq)
@@ -1447,250 +1513,89 @@ public:
         s(cq);
     }
 
-    // toffoli decomposition
-    // from: https://arxiv.org/pdf/1210.0974.pdf
-    // Quantum circuits of T-depth one
     void controlled_cnot_AM(size_t tq, size_t cq1, size_t cq2)
     {
-        h(tq);
-        t(cq1);
-        t(cq2);
-        t(tq);
-        cnot(cq2, cq1);
-        cnot(tq, cq2);
-        cnot(cq1, tq);
-        tdag(cq2);
-        cnot(cq1, cq2);
-        tdag(cq1);
-        tdag(cq2);
-        tdag(tq);
-        cnot(tq, cq2);
-        cnot(cq1, tq);
-        cnot(cq2, cq1);
-        h(tq);
-    }
-
-    // toffoli decomposition
-    // Neilsen and Chuang
+        add_template(toffoli_template("AM"), {cq1, cq2, tq});
+    }
+
     void controlled_cnot_NC(size_t tq, size_t cq1, size_t cq2)
     {
-        h(tq);
-        cnot(cq2,tq);
-        tdag(tq);
-        cnot(cq1,tq);
-        t(tq);
-        cnot(cq2,tq);
-        tdag(tq);
-        cnot(cq1,tq);
-        tdag(cq2);
-        t(tq);
-        cnot(cq1,cq2);
-        h(tq);
-        tdag(cq2);
-        cnot(cq1,cq2);
-        t(cq1);
-        s(cq2);
+        add_template(toffoli_template("NC"), {cq1, cq2, tq});
     }
 
     void controlled_swap(size_t tq1, size_t tq2, size_t cq)
     {
-        // from: https://arxiv.org/pdf/1210.0974.pdf
-        // Quantum circuits of T-depth one
-        cnot(tq2, tq1);
-        cnot(cq, tq1);
-        h(tq2);
-        t(cq);
-        tdag(tq1);
-        t(tq2);
-        cnot(tq2, tq1);
-        cnot(cq, tq2);
-        t(tq1);
-        cnot(cq, tq1);
-        tdag(tq2);
-        tdag(tq1);
-        cnot(cq, tq2);
-        cnot(tq2, tq1);
-        t(tq1);
-        h(tq2);
-        cnot(tq2, tq1);
+        add_template(controlled_templates().at(__swap_gate__).gates, {tq1, tq2, cq, 0});
     }
     void controlled_rx(size_t tq, size_t cq, double theta)
     {
-        rx(tq, theta/2);
-        cz(cq, tq);
-        rx(tq, -theta/2);
-        cz(cq, tq);
+        add_template(controlled_templates().at(__rx_gate__).gates, {tq, 0, cq, 0}, theta);
     }
     void controlled_ry(size_t tq, size_t cq, double theta)
     {
-        ry(tq, theta/2);
-        cnot(cq, tq);
-        ry(tq, -theta/2);
-        cnot(cq, tq);
+        add_template(controlled_templates().at(__ry_gate__).gates, {tq, 0, cq, 0}, theta);
     }
     void controlled_rz(size_t tq, size_t cq, double theta)
     {
-        rz(tq, theta/2);
-        cnot(cq, tq);
-        rz(tq, -theta/2);
-        cnot(cq, tq);
+        add_template(controlled_templates().at(__rz_gate__).gates, {tq, 0, cq, 0}, theta);
     }
 
 
+    /**
+     * add the controlled version of each gate of kernel k, expanding its template
+     * of controlled_templates; the dispatch entries of the templates are resolved
+     * once for the whole kernel
+     */
     void controlled_single(ql::quantum_kernel *k, size_t control_qubit, size_t ancilla_qubit)
     {
         ql::circuit& ckt = k->get_circuit();
+        const std::map<gate_type_t, controlled_template_t> & templates = controlled_templates();
+        const gate_template_t & cnot_template = controlled_cnot_template(ql::options::get("decompose_toffoli"));
+        std::map<const gate_template_t *, std::vector<const gate_dispatch_t::entry_t *>> entries;
+
+        // find the templates and their total size first, to add all gates at once
+        std::vector<std::pair<const gate_template_t *, double>> expansions;
+        size_t total = 0;
+        bool uses_ancilla = false;
         for( auto & g : ckt )
         {
-            std::string gname = g->name;
             ql::gate_type_t gtype = g->type();
-            std::vector<size_t> goperands = g->operands;
-            DOUT("Generating controlled gate for " << gname);
+            DOUT("Generating controlled gate for " << g->name);
             DOUT("Type : " << gtype);
-            if( __pauli_x_gate__ == gtype  || __rx180_gate__ == gtype )
+            if( __cnot_gate__ == gtype )
             {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_x(tq, cq);
+                expansions.push_back(std::make_pair(&cnot_template, 0.0));
             }
-            else if( __pauli_y_gate__ == gtype  || __ry180_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_y(tq, cq);
-            }
-            else if( __pauli_z_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_z(tq, cq);
-            }
-            else if( __hadamard_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_h(tq, cq);
-            }
-            else if( __identity_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_i(tq, cq);
-            }
-            else if( __t_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                size_t aq = ancilla_qubit;
-                controlled_t(tq, cq, aq);
-            }
-            else if( __tdag_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                size_t aq = ancilla_qubit;
-                controlled_tdag(tq, cq, aq);
-            }
-            else if( __phase_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_s(tq, cq);
-            }
-            else if( __phasedag_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_sdag(tq, cq);
-            }
-            else if( __cnot_gate__ == gtype )
+            else
             {
-                size_t cq1 = goperands[0];
-                size_t cq2 = control_qubit;
-                size_t tq = goperands[1];
-
-                auto opt = ql::options::get("decompose_toffoli");
-                if ( opt == "AM" )
-                {
-                    controlled_cnot_AM(tq, cq1, cq2);
-                }
-                else if ( opt == "NC" )
-                {
-                    controlled_cnot_NC(tq, cq1, cq2);
-                }
-                else
+                auto it = templates.find(gtype);
+                if( it == templates.end() )
                 {
-                    toffoli(cq1, cq2, tq);
+                    EOUT("Controlled version of gate '" << g->name << "' not defined !");
+                    throw ql::exception("[x] error : ql::kernel::controlled : Controlled version of gate '"+g->name+"' not defined ! ",false);
                 }
+                const controlled_template_t & ct = it->second;
+                expansions.push_back(std::make_pair(&ct.gates, ct.gate_angle ? g->angle : ct.angle));
+                uses_ancilla = uses_ancilla || __t_gate__ == gtype || __tdag_gate__ == gtype;
             }
-            else if( __swap_gate__ == gtype )
-            {
-                size_t tq1 = goperands[0];
-                size_t tq2 = goperands[1];
-                size_t cq = control_qubit;
-                controlled_swap(tq1, tq2, cq);
-            }
-            else if( __rx_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_rx(tq, cq, g->angle);
-            }
-            else if( __ry_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_ry(tq, cq, g->angle);
-            }
-            else if( __rz_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_rz(tq, cq, g->angle);
-            }
-            else if( __rx90_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_rx(tq, cq, PI/2);
-            }
-            else if( __mrx90_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_rx(tq, cq, -1*PI/2);
-            }
-            else if( __rx180_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_rx(tq, cq, PI);
-                // controlled_x(tq, cq);
-            }
-            else if( __ry90_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_ry(tq, cq, PI/4);
-            }
-            else if( __mry90_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_ry(tq, cq, -1*PI/4);
-            }
-            else if( __ry180_gate__ == gtype )
-            {
-                size_t tq = goperands[0];
-                size_t cq = control_qubit;
-                controlled_ry(tq, cq, PI);
-                // controlled_y(tq, cq);
-            }
-            else
-            {
-                EOUT("Controlled version of gate '" << gname << "' not defined !");
-                throw ql::exception("[x] error : ql::kernel::controlled : Controlled version of gate '"+gname+"' not defined ! ",false);
-            }
+            total += expansions.back().first->size();
+        }
+        if (uses_ancilla)
+        {
+            WOUT("Controlled-T and Controlled-Tdag implementations require an ancilla");
+        }
+
+        c.reserve(c.size() + total);
+        std::vector<size_t> operands(4);
+        for( size_t i=0; i<ckt.size(); i++ )
+        {
+            const std::vector<size_t> & goperands = ckt[i]->operands;
+            operands[0] = goperands[0];
+            operands[1] = (goperands.size() > 1 ? goperands[1] : 0);
+            operands[2] = control_qubit;
+            operands[3] = ancilla_qubit;
+            const gate_template_t * tmpl = expansions[i].first;
+            add_template(*tmpl, operands, expansions[i].second, entries[tmpl]);
         }
     }
 
@@ -1864,7 +1769,13 @@ public:
     size_t        cycle_time;
     kernel_type_t type;
     operation     br_condition;
-    std::map<std::string,custom_gate*> gate_definition;     // FIXME: consider using instruction_map_t
+    std::shared_ptr<const gate_dispatch_t> gate_dispatch;   // gate definitions preprocessed for gate(), see get_gate_dispatch
+#ifndef __disable_lemon__
+    // dependence graphs of the circuit when last scheduled, and of the circuit as decomposed by the backend;
+    // shared by the copies of the kernel, so that after appending gates only those are added, see Scheduler::update
+    std::shared_ptr<Scheduler> sched_cache;
+    std::shared_ptr<Scheduler> backend_sched_cache;
+#endif // __disable_lemon__
 };
 
 
@@ -0,0 +1,504 @@
+/**
+ * @file   mapper.h
+ * @date   10/2018
+ * @brief  mapping of the virtual qubits of a kernel to the physical qubits of
+ *         the platform, with swaps inserted where two-qubit gates need them,
+ *         and the initial placement of the virtual qubits
+ */
+
+#ifndef QL_MAPPER_H
+#define QL_MAPPER_H
+
+#include <vector>
+#include <string>
+
+#include <utils.h>
+#include <exception.h>
+#include <gate.h>
+#include <platform.h>
+#include <topology.h>
+#include <kernel.h>
+#include <interactionMatrix.h>
+
+namespace ql
+{
+
+/**
+ * routes the two-qubit gates of a kernel over the platform topology:
+ * - virtual qubit v starts on physical qubit placement[v], by default v
+ * - gates are taken in order; a two-qubit gate whose qubits are not neighbours
+ *   is preceded by swaps that each bring its qubits one edge closer, of these
+ *   the swap that minimizes the distances of the next two-qubit gates
+ * - at the end of the kernel, the virtual qubits are swapped back to where they
+ *   started, so that kernels can follow each other in any order
+ * the gates are re-resolved for their physical qubits, so that each becomes
+ * the custom gate the platform defines for these; swaps are added as the
+ * platform defines "swap" and otherwise as three cnots
+ */
+class Mapper
+{
+public:
+    Mapper(const ql::quantum_platform & platform, const std::vector<size_t> & initial_placement = {}) :
+        topology(platform.get_topology_tables()),
+        nq(topology.qubit_count),
+        placement(initial_placement)
+    {
+        if (placement.empty())
+        {
+            for (size_t q=0; q<nq; q++)
+                placement.push_back(q);
+        }
+        std::vector<size_t> sorted(placement);
+        std::sort(sorted.begin(), sorted.end());
+        for (size_t q=0; q<sorted.size(); q++)
+        {
+            if (sorted.size() != nq || sorted[q] != q)
+            {
+                EOUT("initial placement " << ql::utils::to_string(placement,"placement") << " is not a permutation of the " << nq << " platform qubits");
+                throw ql::exception("[x] error : ql::mapper : initial placement is not a permutation of the platform qubits !",false);
+            }
+        }
+    }
+
+    void map(ql::quantum_kernel & kernel)
+    {
+        IOUT("mapping kernel " << kernel.name << " ...");
+        if (kernel.qubit_count > nq)
+        {
+            EOUT("kernel '" << kernel.name << "' uses " << kernel.qubit_count << " qubits, the platform has " << nq);
+            throw ql::exception("[x] error : ql::mapper::map() : kernel '"+kernel.name+"' uses more qubits than the platform has !",false);
+        }
+
+        // the qubits the kernel doesn't use may hold state of other kernels, so all are mapped
+        v2p = placement;
+        p2v.resize(nq);
+        for (size_t v=0; v<nq; v++)
+        {
+            p2v[v2p[v]] = v;
+        }
+
+        ql::circuit input;
+        input.swap(kernel.c);
+        kernel.c.reserve(input.size());
+
+        // indices in input of the two-qubit gates, for the lookahead
+        std::vector<size_t> two_qubit_gates;
+        for (size_t i=0; i<input.size(); i++)
+        {
+            if (is_two_qubit_gate(input[i]))
+            {
+                two_qubit_gates.push_back(i);
+            }
+        }
+
+        size_t next = 0;                    // index in two_qubit_gates of the first gate not yet mapped
+        size_t nswaps = 0;
+        for (auto g : input)
+        {
+            if (is_two_qubit_gate(g))
+            {
+                next++;
+                size_t v0 = g->operands[0];
+                size_t v1 = g->operands[1];
+                size_t d = distance(v0, v1);
+                if (d >= nq)
+                {
+                    EOUT("qubits " << v0 << " and " << v1 << " of '" << g->qasm() << "' are not connected");
+                    throw ql::exception("[x] error : ql::mapper::map() : qubits of '"+g->qasm()+"' are not connected in the platform topology !",false);
+                }
+                for (; d > 1; d--)
+                {
+                    size_t p = nq, q = nq;
+                    select_swap(v0, v1, d, input, two_qubit_gates, next, p, q);
+                    add_swap(kernel, p, q);
+                    nswaps++;
+                }
+            }
+            add_mapped(kernel, g);
+        }
+        nswaps += restore(kernel);
+
+        IOUT("mapped kernel " << kernel.name << " with " << nswaps << " swaps");
+    }
+
+private:
+    const ql::topology_tables_t & topology;
+    size_t nq;                              // number of physical qubits
+    std::vector<size_t> placement;          // virtual to physical qubit at the start and end of each kernel
+    std::vector<size_t> v2p;                // virtual to physical qubit
+    std::vector<size_t> p2v;                // physical to virtual qubit
+
+    static const size_t lookahead = 16;     // number of next two-qubit gates that select a swap
+
+    // a gate that needs its two qubits to be neighbours; waits and barriers don't
+    static bool is_two_qubit_gate(ql::gate * g)
+    {
+        if (g->type() == __classical_gate__ || g->type() == __wait_gate__ || g->operands.size() != 2)
+            return false;
+        std::string name = g->name.substr(0, g->name.find(' '));
+        return name != "wait" && name != "barrier";
+    }
+
+    size_t distance(size_t v0, size_t v1) const
+    {
+        return topology.distance(v2p[v0], v2p[v1]);
+    }
+
+    void swap(size_t p, size_t q)
+    {
+        std::swap(p2v[p], p2v[q]);
+        v2p[p2v[p]] = p;
+        v2p[p2v[q]] = q;
+    }
+
+    // of the swaps on an edge of v0 or v1 that bring these from distance d to d-1,
+    // the one with the least total distance of the lookahead gates after it
+    void select_swap(size_t v0, size_t v1, size_t d, const ql::circuit & input,
+        const std::vector<size_t> & two_qubit_gates, size_t next, size_t & best_p, size_t & best_q)
+    {
+        size_t end = std::min(two_qubit_gates.size(), next+lookahead);
+        size_t best_cost = 0;
+        bool found = false;
+        for (size_t p : { v2p[v0], v2p[v1] })
+        {
+            for (size_t q : topology.neighbours(p))
+            {
+                swap(p, q);
+                if (distance(v0, v1) == d-1)
+                {
+                    size_t cost = 0;
+                    for (size_t i=next; i<end; i++)
+                    {
+                        auto & operands = input[two_qubit_gates[i]]->operands;
+                        cost += distance(operands[0], operands[1]);
+                    }
+                    if (!found || cost < best_cost)
+                    {
+                        found = true;
+                        best_cost = cost;
+                        best_p = p;
+                        best_q = q;
+                    }
+                }
+                swap(p, q);
+            }
+        }
+        if (!found)
+        {
+            EOUT("no swap brings qubits " << v0 << " and " << v1 << " closer than distance " << d);
+            throw ql::exception("[x] error : ql::mapper::map() : no swap brings qubits "+std::to_string(v0)+" and "+std::to_string(v1)+" closer !",false);
+        }
+        swap(best_p, best_q);
+        DOUT("swap q" << best_p << ", q" << best_q << " for qubits " << v0 << " and " << v1 << ", lookahead distance " << best_cost);
+    }
+
+    // swap of physical qubits p and q in kernel, as the platform defines it
+    void add_swap(ql::quantum_kernel & kernel, size_t p, size_t q)
+    {
+        auto & dispatch = kernel.get_gate_dispatch();
+        auto entry = dispatch.find("swap");
+        if (entry != NULL)
+        {
+            kernel.add_gate(entry, "swap", {p, q}, {}, 0, 0.0);
+            return;
+        }
+        entry = dispatch.find("cnot");
+        kernel.add_gate(entry, "cnot", {p, q}, {}, 0, 0.0);
+        kernel.add_gate(entry, "cnot", {q, p}, {}, 0, 0.0);
+        kernel.add_gate(entry, "cnot", {p, q}, {}, 0, 0.0);
+    }
+
+    // add gate g of the unmapped kernel to kernel, on the physical qubits of its operands
+    void add_mapped(ql::quantum_kernel & kernel, ql::gate * g)
+    {
+        if (g->type() == __classical_gate__ || g->operands.empty())
+        {
+            kernel.c.push_back(g);
+            return;
+        }
+
+        std::vector<size_t> qubits;
+        for (auto v : g->operands)
+        {
+            qubits.push_back(v2p[v]);
+        }
+        if (qubits == g->operands)
+        {
+            kernel.c.push_back(g);
+            return;
+        }
+
+        // as quantum_kernel::gate(), first a specialized then a parameterized custom
+        // gate, then a default gate; the name of a specialized custom gate includes its qubits
+        bool is_custom = (g->type() == __custom_gate__);
+        std::string name = g->name.substr(0, g->name.find(' '));
+        auto entry = kernel.get_gate_dispatch().find(name);
+        custom_gate * prototype = NULL;
+        if (entry != NULL)
+        {
+            auto it = entry->specialized.find(qubits);
+            prototype = (it != entry->specialized.end() ? it->second : entry->prototype);
+        }
+        if (prototype != NULL)
+        {
+            custom_gate * mg = new custom_gate(*prototype);
+            mg->operands = qubits;
+            mg->creg_operands = g->creg_operands;
+            mg->angle = g->angle;
+            if (is_custom && name == g->name)
+            {
+                mg->duration = g->duration;
+            }
+            kernel.c.push_back(mg);
+            return;
+        }
+        if ((!is_custom || ql::options::get("use_default_gates") == "yes") &&
+            kernel.add_default_gate_if_available(name, qubits, g->creg_operands, g->duration, g->angle))
+        {
+            return;
+        }
+
+        EOUT("the gate '" << g->name << "' is not supported by the target platform on " << ql::utils::to_string(qubits,"qubits"));
+        throw ql::exception("[x] error : ql::mapper::map() : the gate '"+g->name+"' with " +ql::utils::to_string(qubits,"qubits")+" is not supported by the target platform !",false);
+    }
+
+    // swap the virtual qubits back to the physical qubits they started on;
+    // the physical qubits are fixed one by one as leaves of a breadth first
+    // spanning tree, each after its virtual qubit is moved to it along the tree
+    size_t restore(ql::quantum_kernel & kernel)
+    {
+        std::vector<size_t> order, parent(nq, nq);
+        std::vector<bool> visited(nq, false);
+        for (size_t root=0; root<nq; root++)
+        {
+            if (visited[root])
+                continue;
+            visited[root] = true;
+            size_t first = order.size();
+            order.push_back(root);
+            for (size_t i=first; i<order.size(); i++)
+            {
+                for (auto n : topology.neighbours(order[i]))
+                {
+                    if (!visited[n])
+                    {
+                        visited[n] = true;
+                        parent[n] = order[i];
+                        order.push_back(n);
+                    }
+                }
+            }
+        }
+
+        std::vector<size_t> home(nq);       // physical to virtual qubit at the start
+        for (size_t v=0; v<nq; v++)
+        {
+            home[placement[v]] = v;
+        }
+
+        // the last qubit in breadth first order is a leaf of what is left of the
+        // tree, and the tree path between two qubits that are left stays in it;
+        // a virtual qubit is only swapped along edges, so it stays in its tree
+        size_t nswaps = 0;
+        for (size_t i=order.size(); i-- > 0; )
+        {
+            size_t leaf = order[i];
+            size_t src = v2p[home[leaf]];
+            if (src == leaf)
+                continue;
+
+            std::vector<size_t> up, down;   // tree path from src up to the common ancestor, from leaf up to below it
+            for (size_t a=src; a != nq; a = parent[a]) up.push_back(a);
+            size_t a = leaf;
+            for (; std::find(up.begin(), up.end(), a) == up.end(); a = parent[a]) down.push_back(a);
+            up.erase(std::find(up.begin(), up.end(), a)+1, up.end());
+            up.insert(up.end(), down.rbegin(), down.rend());
+
+            for (size_t j=0; j+1<up.size(); j++)
+            {
+                add_swap(kernel, up[j], up[j+1]);
+                swap(up[j], up[j+1]);
+                nswaps++;
+            }
+        }
+        return nswaps;
+    }
+};
+
+/**
+ * initial placement of the virtual qubits on the physical qubits that
+ * minimizes the sum over the pairs of interacting qubits of their number of
+ * interactions times their distance in the topology; from each physical
+ * qubit as seed in turn:
+ * - the qubit with the most interactions is placed on the seed, then one by
+ *   one the qubit with the most interactions with those placed so far, on the
+ *   free physical qubit that adds the least to the cost
+ * - then pairs of physical qubits exchange their virtual qubits as long as
+ *   that lowers the cost
+ * the cheapest of these and the identity placement is taken, the identity
+ * when none is cheaper
+ */
+class Placer
+{
+public:
+    Placer(const ql::quantum_platform & platform) :
+        topology(platform.get_topology_tables()),
+        nq(topology.qubit_count)
+    {
+    }
+
+    /**
+     * placement[v]: physical qubit of virtual qubit v, for all platform qubits
+     */
+    std::vector<size_t> place(const InteractionMatrix & interactions)
+    {
+        size_t n = interactions.getSize();
+        if (n > nq)
+        {
+            EOUT("interaction matrix of " << n << " qubits, the platform has " << nq);
+            throw ql::exception("[x] error : ql::placer::place() : more qubits than the platform has !",false);
+        }
+
+        weights.assign(nq*nq, 0);
+        std::vector<size_t> total(nq, 0);
+        for (auto & p : interactions.getPairs())
+        {
+            size_t v = std::get<0>(p), w = std::get<1>(p), count = std::get<2>(p);
+            weights[v*nq+w] = weights[w*nq+v] = count;
+            total[v] += count;
+            total[w] += count;
+        }
+
+        std::vector<size_t> best(nq);
+        for (size_t v=0; v<nq; v++)
+            best[v] = v;
+        size_t best_cost = cost(best);
+        size_t identity_cost = best_cost;
+
+        size_t first = std::max_element(total.begin(), total.end()) - total.begin();
+        if (total[first] > 0)
+        {
+            for (size_t seed=0; seed<nq; seed++)
+            {
+                std::vector<size_t> v2p = grow(first, seed, total);
+                improve(v2p);
+                size_t c = cost(v2p);
+                if (c < best_cost)
+                {
+                    best_cost = c;
+                    best = v2p;
+                }
+            }
+        }
+        IOUT("initial placement " << ql::utils::to_string(best,"placement") << ", weighted distance "
+            << best_cost << ", " << identity_cost << " without placement");
+        return best;
+    }
+
+private:
+    const ql::topology_tables_t & topology;
+    size_t nq;                              // number of physical qubits
+    std::vector<size_t> weights;            // [v*nq+w]: interactions between virtual qubits v and w
+
+    size_t cost(const std::vector<size_t> & v2p) const
+    {
+        size_t c = 0;
+        for (size_t v=0; v<nq; v++)
+            for (size_t w=v+1; w<nq; w++)
+                c += weights[v*nq+w] * topology.distance(v2p[v], v2p[w]);
+        return c;
+    }
+
+    // cost of virtual qubit v on physical qubit p, with respect to the placed qubits
+    size_t cost(size_t v, size_t p, const std::vector<size_t> & v2p) const
+    {
+        size_t c = 0;
+        for (size_t w=0; w<nq; w++)
+        {
+            if (w != v && v2p[w] < nq)
+                c += weights[v*nq+w] * topology.distance(p, v2p[w]);
+        }
+        return c;
+    }
+
+    std::vector<size_t> grow(size_t first, size_t seed, const std::vector<size_t> & total) const
+    {
+        std::vector<size_t> v2p(nq, nq);
+        std::vector<bool> used(nq, false);
+        std::vector<size_t> attached(nq, 0);    // interactions with the placed qubits
+        size_t v = first;
+        size_t p = seed;
+        for (size_t placed=0; ; )
+        {
+            v2p[v] = p;
+            used[p] = true;
+            placed++;
+            for (size_t w=0; w<nq; w++)
+                attached[w] += weights[w*nq+v];
+            if (placed == nq)
+                break;
+
+            // next: the most attached, then the most interacting unplaced qubit
+            v = nq;
+            for (size_t w=0; w<nq; w++)
+            {
+                if (v2p[w] == nq && (v == nq || attached[w] > attached[v] ||
+                    (attached[w] == attached[v] && total[w] > total[v])))
+                {
+                    v = w;
+                }
+            }
+            p = nq;
+            size_t pcost = 0;
+            for (size_t q=0; q<nq; q++)
+            {
+                if (used[q])
+                    continue;
+                size_t c = cost(v, q, v2p);
+                if (p == nq || c < pcost)
+                {
+                    p = q;
+                    pcost = c;
+                }
+            }
+        }
+        return v2p;
+    }
+
+    // exchange the virtual qubits of pairs of physical qubits while that lowers the cost
+    void improve(std::vector<size_t> & v2p) const
+    {
+        std::vector<size_t> p2v(nq);
+        for (size_t v=0; v<nq; v++)
+            p2v[v2p[v]] = v;
+
+        for (bool improved = true; improved; )
+        {
+            improved = false;
+            for (size_t p=0; p<nq; p++)
+            {
+                for (size_t q=p+1; q<nq; q++)
+                {
+                    size_t v = p2v[p];
+                    size_t w = p2v[q];
+                    size_t before = cost(v, p, v2p) + cost(w, q, v2p);
+                    std::swap(v2p[v], v2p[w]);
+                    size_t after = cost(v, q, v2p) + cost(w, p, v2p);
+                    if (after < before)
+                    {
+                        std::swap(p2v[p], p2v[q]);
+                        improved = true;
+                    }
+                    else
+                    {
+                        std::swap(v2p[v], v2p[w]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace ql
+
+#endif // QL_MAPPER_H
@@ -94,6 +94,16 @@ protected:
     {
         if (c.size()==1)
             return false;
+        // only unitary gates on one and the same qubit can be fused
+        for (auto g : c)
+        {
+            if (g->operands.size() != 1 || g->operands[0] != c[0]->operands[0])
+                return false;
+            auto t = g->type();
+            if (t == __measure_gate__ || t == __prepz_gate__ || t == __classical_gate__ ||
+                t == __wait_gate__ || t == __display__ || t == __display_binary__)
+                return false;
+        }
         ql::cmat_t m = c[0]->mat();
         for (size_t i=1; i<c.size(); ++i)
         {
@@ -35,9 +35,18 @@ namespace ql
           opt_name2opt_val["scheduler_uniform"] = "no";
           opt_name2opt_val["scheduler_commute"] = "no";
           opt_name2opt_val["scheduler_post179"] = "yes";
+          opt_name2opt_val["scheduler_cross_kernel"] = "no";
+          opt_name2opt_val["scheduler_window"] = "0";
+          opt_name2opt_val["mapper"] = "no";
+          opt_name2opt_val["initial_placement"] = "no";
           opt_name2opt_val["cz_mode"] = "manual";
           opt_name2opt_val["print_dot_graphs"] = "no";
           opt_name2opt_val["write_qasm_files"] = "no";
+          opt_name2opt_val["compress_bundles"] = "no";
+          opt_name2opt_val["use_platform_image"] = "no";
+          opt_name2opt_val["statevector_shots"] = "1024";
+          opt_name2opt_val["stabilizer_shots"] = "1";
+          opt_name2opt_val["verify_passes"] = "no";
 
           // add options with default values and list of possible values
           app->add_set_ignore_case("--log_level", opt_name2opt_val["log_level"], 
@@ -47,12 +56,21 @@ namespace ql
           app->add_set_ignore_case("--scheduler", opt_name2opt_val["scheduler"], {"ASAP", "ALAP"}, "scheduler type", true);
           app->add_set_ignore_case("--scheduler_uniform", opt_name2opt_val["scheduler_uniform"], {"yes", "no"}, "Do uniform scheduling or not", true);
           app->add_set_ignore_case("--scheduler_commute", opt_name2opt_val["scheduler_commute"], {"yes", "no"}, "Commute gates when possible, or not", true);
+          app->add_set_ignore_case("--scheduler_cross_kernel", opt_name2opt_val["scheduler_cross_kernel"], {"yes", "no"}, "Schedule consecutive straight-line kernels as one in cc-light, or not", true);
+          app->add_option("--scheduler_window", opt_name2opt_val["scheduler_window"], "Number of gates in the window of the streaming ASAP scheduler, 0 to schedule on the dependence graph of the whole circuit", true);
+          app->add_set_ignore_case("--mapper", opt_name2opt_val["mapper"], {"yes", "no"}, "Map qubits to the cc-light topology with swaps, or not", true);
+          app->add_set_ignore_case("--initial_placement", opt_name2opt_val["initial_placement"], {"yes", "no"}, "Place interacting qubits close together before mapping, or not", true);
           app->add_set_ignore_case("--use_default_gates", opt_name2opt_val["use_default_gates"], {"yes", "no"}, "Use default gates or not", true);
           app->add_set_ignore_case("--optimize", opt_name2opt_val["optimize"], {"yes", "no"}, "optimize or not", true);
-          app->add_set_ignore_case("--decompose_toffoli", opt_name2opt_val["decompose_toffoli"], {"no", "NC", "MA"}, "Type of decomposition used for toffoli", true);
+          app->add_set_ignore_case("--decompose_toffoli", opt_name2opt_val["decompose_toffoli"], {"no", "NC", "AM"}, "Type of decomposition used for toffoli", true);
           app->add_set_ignore_case("--cz_mode", opt_name2opt_val["cz_mode"], {"manual", "auto"}, "CZ mode", true);
           app->add_set_ignore_case("--print_dot_graphs", opt_name2opt_val["print_dot_graphs"], {"yes", "no"}, "print (un-)secheduled graphs in DOT format", true);
           app->add_set_ignore_case("--write_qasm_files", opt_name2opt_val["write_qasm_files"], {"yes", "no"}, "write (un-)secheduled (with and without resource-constraint) qasm files", true);
+          app->add_set_ignore_case("--compress_bundles", opt_name2opt_val["compress_bundles"], {"yes", "no"}, "fold repeated bundle sequences into loops in cc-light qisa", true);
+          app->add_set_ignore_case("--use_platform_image", opt_name2opt_val["use_platform_image"], {"yes", "no"}, "load a platform from its precompiled image when it is up to date", true);
+          app->add_option("--statevector_shots", opt_name2opt_val["statevector_shots"], "Number of shots of the state-vector simulation backend", true);
+          app->add_option("--stabilizer_shots", opt_name2opt_val["stabilizer_shots"], "Number of shots of the stabilizer simulation backend", true);
+          app->add_set_ignore_case("--verify_passes", opt_name2opt_val["verify_passes"], {"yes", "no"}, "check by simulation that optimization and decomposition passes preserve the circuits, or not", true);
       }
 
       void print_current_values()
@@ -9,9 +9,16 @@
 
 #include <string>
 #include <tuple>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <sstream>
 
 #include <circuit.h>
 #include <hardware_configuration.h>
+#include <topology.h>
+#include <gate_dispatch.h>
 
 namespace ql
 {
@@ -59,6 +66,9 @@ public:
     json                    resources;
     json                    topology;
     json                    aliases;                  // workaround the generic instruction composition
+    std::shared_ptr<const ql::topology_tables_t> topology_tables; // derived from topology and resources, shared by copies
+    std::shared_ptr<const ql::gate_dispatch_t> gate_dispatch;     // instruction_map preprocessed for quantum_kernel::gate()
+    bool                    loaded_from_image = false;  // the configuration was read from its platform image
 
     /**
      * quantum_platform constructor
@@ -77,6 +87,7 @@ public:
         // hwc.load(instruction_map, instruction_settings, hardware_settings, resources, topology);
         hwc.load(instruction_map, instruction_settings, hardware_settings, resources, topology, aliases);
         eqasm_compiler_name = hwc.eqasm_compiler_name;
+        loaded_from_image = hwc.loaded_from_image;
 
         if(hardware_settings.count("qubit_number") <=0)
         {
@@ -93,6 +104,9 @@ public:
         }
         else
             cycle_time = hardware_settings["cycle_time"];
+
+        topology_tables = std::make_shared<const ql::topology_tables_t>(topology, resources, qubit_number);
+        gate_dispatch = std::make_shared<const ql::gate_dispatch_t>(instruction_map);
     }
 
     /**
@@ -109,11 +123,55 @@ public:
             println("  |-- " << (*i).first);
     }
 
-    size_t get_qubit_number()
+    size_t get_qubit_number() const
     {
         return qubit_number;
     }
 
+    /**
+     * platform from the process-wide cache of loaded platforms;
+     * it is loaded when not yet in the cache or when the contents of its
+     * configuration file differ from those it was loaded from;
+     * the platform is shared by all users and therefore immutable
+     */
+    static std::shared_ptr<const quantum_platform> get(std::string name, std::string configuration_file_name)
+    {
+        typedef std::pair<std::string,std::string> key_t;                   // name, configuration file
+        static std::map<key_t, std::pair<std::string, std::shared_ptr<const quantum_platform>>> cache;  // contents, platform
+        static std::mutex cache_mutex;
+
+        // a file modification time can miss an edit, the contents cannot
+        std::ifstream fs(configuration_file_name, std::ios::in | std::ios::binary);
+        bool have_contents = fs.is_open();
+        std::ostringstream contents;
+        if (have_contents)
+        {
+            contents << fs.rdbuf();
+        }
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        key_t key(name, configuration_file_name);
+        auto it = cache.find(key);
+        if (have_contents && it != cache.end() && it->second.first == contents.str())
+        {
+            DOUT("platform '" << name << "' from cache");
+            return it->second.second;
+        }
+        auto platform = std::make_shared<const quantum_platform>(name, configuration_file_name);
+        cache[key] = std::make_pair(contents.str(), platform);
+        return platform;
+    }
+
+    // tables derived from topology["edges"] and the edge related resources
+    const ql::topology_tables_t & get_topology_tables() const
+    {
+        if (!topology_tables)
+        {
+            FATAL("platform '" << name << "' has no topology");
+        }
+        return *topology_tables;
+    }
+
 
     /**
      * @brief   Find architecture instruction name for a custom gate
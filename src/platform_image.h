@@ -0,0 +1,176 @@
+/**
+ * @file   platform_image.h
+ * @date   10/2018
+ * @brief  precompiled platform image: the parsed hardware configuration in binary form
+ */
+
+#ifndef QL_PLATFORM_IMAGE_H
+#define QL_PLATFORM_IMAGE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+
+#include "utils.h"
+#include "exception.h"
+#include "json.h"
+#include "instruction_map.h"
+
+namespace ql
+{
+namespace platform_image
+{
+
+/**
+ * an image is a header followed by the hardware configuration json, with its
+ * comments stripped, encoded in CBOR; it is valid for the json file with the
+ * hash in the header; the header has a fixed layout of little endian fields
+ * so that the file can be read in one go
+ *
+ * the image only saves parsing the json text: the json file is still read to
+ * check the hash, and the instruction map, gate dispatch and topology tables
+ * are built from the decoded configuration as from a parsed json file; the
+ * payload is decoded into a json object, it is not a memory-mappable layout
+ */
+const char     magic[8] = { 'O', 'Q', 'L', 'P', 'I', 'M', 'G', '\0' };
+const uint32_t version = 1;
+const size_t   header_size = 32;          // magic, version, reserved, json hash, payload size
+
+/**
+ * image file name for a hardware configuration file
+ */
+inline std::string image_file_name(const std::string & config_file_name)
+{
+    return config_file_name + ".img";
+}
+
+inline bool read_file(const std::string & file_name, std::string & bytes)
+{
+    std::ifstream fs(file_name, std::ios::in | std::ios::binary);
+    if (!fs.is_open())
+    {
+        return false;
+    }
+    std::ostringstream ss;
+    ss << fs.rdbuf();
+    bytes = ss.str();
+    return true;
+}
+
+/**
+ * 64 bit FNV-1a hash of the bytes of the json file
+ */
+inline uint64_t hash(const std::string & bytes)
+{
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : bytes)
+    {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+inline void put_u32(std::string & s, uint32_t v)
+{
+    for (int i=0; i<4; i++) s.push_back(char((v >> (8*i)) & 0xff));
+}
+
+inline void put_u64(std::string & s, uint64_t v)
+{
+    for (int i=0; i<8; i++) s.push_back(char((v >> (8*i)) & 0xff));
+}
+
+inline uint64_t get_u(const std::string & s, size_t offset, int nbytes)
+{
+    uint64_t v = 0;
+    for (int i=0; i<nbytes; i++) v |= uint64_t((unsigned char)s[offset+i]) << (8*i);
+    return v;
+}
+
+/**
+ * compile the json hardware configuration file into an image file
+ */
+inline void write(const std::string & config_file_name, const std::string & image_name)
+{
+    std::string bytes;
+    if (!read_file(config_file_name, bytes))
+    {
+        FATAL("cannot read hardware configuration file '" << config_file_name << "'");
+    }
+    json config = load_json(config_file_name);
+    std::vector<uint8_t> payload = json::to_cbor(config);
+
+    std::string image(magic, sizeof(magic));
+    put_u32(image, version);
+    put_u32(image, 0);
+    put_u64(image, hash(bytes));
+    put_u64(image, payload.size());
+    image.append(payload.begin(), payload.end());
+
+    std::ofstream fs(image_name, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!fs.is_open())
+    {
+        FATAL("cannot write platform image '" << image_name << "'");
+    }
+    fs.write(image.data(), image.size());
+    IOUT("platform image '" << image_name << "' written for '" << config_file_name << "'");
+}
+
+/**
+ * load the configuration from the image file when it is valid for the json file;
+ * returns false when there is no such image or when it is outdated or corrupt
+ */
+inline bool load(const std::string & image_name, const std::string & config_file_name, json & config)
+{
+    std::string image;
+    if (!read_file(image_name, image))
+    {
+        DOUT("no platform image '" << image_name << "'");
+        return false;
+    }
+    if (image.size() < header_size || memcmp(image.data(), magic, sizeof(magic)) != 0)
+    {
+        WOUT("'" << image_name << "' is not a platform image, ignored");
+        return false;
+    }
+    if (get_u(image, 8, 4) != version)
+    {
+        WOUT("platform image '" << image_name << "' has version " << get_u(image, 8, 4) << " instead of " << version << ", ignored");
+        return false;
+    }
+
+    std::string bytes;
+    if (!read_file(config_file_name, bytes) || get_u(image, 16, 8) != hash(bytes))
+    {
+        WOUT("platform image '" << image_name << "' doesn't match '" << config_file_name << "', ignored");
+        return false;
+    }
+
+    uint64_t payload_size = get_u(image, 24, 8);
+    if (image.size() != header_size + payload_size)
+    {
+        WOUT("platform image '" << image_name << "' is truncated, ignored");
+        return false;
+    }
+    try
+    {
+        std::vector<uint8_t> payload(image.begin()+header_size, image.end());
+        config = json::from_cbor(payload);
+    }
+    catch (json::exception &e)
+    {
+        WOUT("platform image '" << image_name << "' is corrupt, ignored: " << e.what());
+        return false;
+    }
+    DOUT("platform image '" << image_name << "' loaded");
+    return true;
+}
+
+} // namespace platform_image
+} // namespace ql
+
+#endif // QL_PLATFORM_IMAGE_H
@@ -9,15 +9,20 @@
 #ifndef QL_PROGRAM_H
 #define QL_PROGRAM_H
 
+#include <unordered_map>
+
 #include <utils.h>
 #include <options.h>
 #include <platform.h>
 #include <kernel.h>
 #include <interactionMatrix.h>
+#include <equivalence.h>
 #include <eqasm_compiler.h>
 #include <arch/cbox/cbox_eqasm_compiler.h>
 #include <arch/cc_light/cc_light_eqasm_compiler.h>
 #include <arch/quantumsim_eqasm_compiler.h>
+#include <arch/statevector_eqasm_compiler.h>
+#include <arch/stabilizer_eqasm_compiler.h>
 #include <arch/cc/eqasm_backend_cc.h>
 
 static unsigned long phi_node_count = 0;
@@ -48,7 +53,7 @@ class quantum_program
 
 
    public:
-      quantum_program(std::string n, quantum_platform platf, size_t nqubits, size_t ncregs = 0)
+      quantum_program(std::string n, const quantum_platform & platf, size_t nqubits, size_t ncregs = 0)
             : name(n), platform(platf), qubit_count(nqubits), creg_count(ncregs)
       {
          default_config = true;
@@ -79,6 +84,14 @@ class quantum_program
          {
             backend_compiler = new ql::arch::quantumsim_eqasm_compiler();
          }
+         else if (eqasm_compiler_name == "statevector_compiler" )
+         {
+            backend_compiler = new ql::arch::statevector_eqasm_compiler();
+         }
+         else if (eqasm_compiler_name == "stabilizer_compiler" )
+         {
+            backend_compiler = new ql::arch::stabilizer_eqasm_compiler();
+         }
          else if (eqasm_compiler_name == "eqasm_backend_cc" )
          {
             backend_compiler = new ql::arch::eqasm_backend_cc();
@@ -432,11 +445,20 @@ class quantum_program
             throw ql::exception("Error: compiling a program with no kernels !",false);
          }
 
+         // the circuits before a pass are only kept to verify the pass
+         bool verify = (ql::options::get("verify_passes") == "yes");
+
          if( ql::options::get("optimize") == "yes" )
          {
             IOUT("optimizing quantum kernels...");
             for (size_t k=0; k<kernels.size(); ++k)
+            {
+               ql::circuit before;
+               if (verify)
+                  before = kernels[k].get_circuit();
                kernels[k].optimize();
+               ql::verify_pass("rotations_merging", kernels[k].name, before, kernels[k].get_circuit());
+            }
          }
 
          auto tdopt = ql::options::get("decompose_toffoli");
@@ -444,7 +466,13 @@ class quantum_program
          {
             IOUT("Decomposing Toffoli ...");
             for (size_t k=0; k<kernels.size(); ++k)
+            {
+               ql::circuit before;
+               if (verify)
+                  before = kernels[k].get_circuit();
                kernels[k].decompose_toffoli();
+               ql::verify_pass("decompose_toffoli", kernels[k].name, before, kernels[k].get_circuit());
+            }
          }
          else if( tdopt == "no" )
          {
@@ -485,21 +513,30 @@ class quantum_program
                // - always call:  backend_compiler->compile(name, kernels, platform);
                // - remove from eqasm_compiler.h: compile(std::string prog_name, ql::circuit& c, ql::quantum_platform& p);
 
-               IOUT("fusing quantum kernels...");
-               ql::circuit fused;
-               for (size_t k=0; k<kernels.size(); ++k)
+               try
                {
-                  ql::circuit& kc = kernels[k].get_circuit();
-                  for(size_t i=0; i<kernels[k].iterations; i++)
+                  if (backend_compiler->supports_loops())
                   {
-                     fused.insert(fused.end(), kc.begin(), kc.end());
+                     // backend emits loops for kernel iterations, no need to unroll
+                     IOUT("compiling eqasm code...");
+                     backend_compiler->compile(name, kernels, platform);
+                  }
+                  else
+                  {
+                     IOUT("fusing quantum kernels...");
+                     ql::circuit fused;
+                     for (size_t k=0; k<kernels.size(); ++k)
+                     {
+                        ql::circuit& kc = kernels[k].get_circuit();
+                        for(size_t i=0; i<kernels[k].iterations; i++)
+                        {
+                           fused.insert(fused.end(), kc.begin(), kc.end());
+                        }
+                     }
+
+                     IOUT("compiling eqasm code...");
+                     backend_compiler->compile(name, fused, platform);
                   }
-               }
-
-               try
-               {
-                  IOUT("compiling eqasm code...");
-                  backend_compiler->compile(name, fused, platform);
                }
                catch (ql::exception &e)
                {
@@ -557,15 +594,33 @@ class quantum_program
          sched_qasm += "qubits " + std::to_string(qubit_count) + "\n";
 
          IOUT("scheduling the quantum program");
+         bool print_dot = (ql::options::get("print_dot_graphs") == "yes");
+         std::unordered_map<std::string, std::string> scheduled;    // kernel structure -> scheduled qasm of its body
          for (auto k : kernels)
          {
+            std::string structure = k.structure();
+            std::string prologue = k.get_prologue();
+            std::string epilogue = k.get_epilogue();
+            auto it = scheduled.find(structure);
+            if (!print_dot && it != scheduled.end())
+            {
+               DOUT("reusing the schedule of an identical kernel for '" << k.get_name() << "'");
+               sched_qasm += prologue + it->second + epilogue + '\n';
+               continue;
+            }
+
             std::string kernel_sched_qasm;
             std::string dot;
             std::string kernel_sched_dot;
             k.schedule(platform, kernel_sched_qasm, dot, kernel_sched_dot);
             sched_qasm += kernel_sched_qasm + '\n';
+            if (kernel_sched_qasm.size() >= prologue.size() + epilogue.size())
+            {
+               scheduled[structure] = kernel_sched_qasm.substr(prologue.size(),
+                  kernel_sched_qasm.size() - prologue.size() - epilogue.size());
+            }
 
-            if(ql::options::get("print_dot_graphs") == "yes")
+            if(print_dot)
             {
                string fname;
                fname = ql::options::get("output_dir") + "/" + k.get_name() + "_dependence_graph.dot";
@@ -591,7 +646,7 @@ class quantum_program
       {
          IOUT("printing interaction matrix...");
 
-         for (auto k : kernels)
+         for (auto & k : kernels)
          {
             InteractionMatrix imat( k.get_circuit(), qubit_count);
             string mstr = imat.getString();
@@ -601,7 +656,7 @@ class quantum_program
 
       void write_interaction_matrix()
       {
-         for (auto k : kernels)
+         for (auto & k : kernels)
          {
             InteractionMatrix imat( k.get_circuit(), qubit_count);
             string mstr = imat.getString();
@@ -609,6 +664,10 @@ class quantum_program
             string fname = ql::options::get("output_dir") + "/" + k.get_name() + "InteractionMatrix.dat";
             IOUT("writing interaction matrix to '" << fname << "' ...");
             ql::utils::write_file(fname, mstr);
+
+            fname = ql::options::get("output_dir") + "/" + k.get_name() + "InteractionMatrix.csv";
+            IOUT("writing interacting qubit pairs to '" << fname << "' ...");
+            ql::utils::write_file(fname, imat.getCSV());
          }
       }
 
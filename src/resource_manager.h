@@ -12,6 +12,10 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <sstream>
+#include <algorithm>
+#include <iterator>
 
 namespace ql
 {
@@ -22,11 +26,123 @@ namespace ql
 
     namespace arch
     {
+        class interval_set_t;
         class resource_t;
         class resource_manager_t;
     }
 }
 
+// occupation of a single resource unit over time: a set of disjoint intervals [start,end),
+// each busy with an operation, kept sorted on start cycle;
+// since all reservations are kept, not just the latest one,
+// availability can be asked for any start cycle in O(log n) for n intervals,
+// also for one in an idle gap before (fwd) or after (bwd) cycles that were reserved already
+class ql::arch::interval_set_t
+{
+public:
+    typedef enum {
+        share_operation = 0,    // can overlap an interval of the same operation but not start before (fwd) or end after (bwd) it
+        share_start = 1         // can overlap an interval that starts in the same cycle
+    } sharing_t;
+
+    struct interval_t
+    {
+        size_t end;             // busy till cycle end, not inclusive
+        std::string operation;  // with this operation
+    };
+    typedef std::map<size_t, interval_t> intervals_t;
+
+    intervals_t intervals;      // start cycle -> interval
+
+    // is [start,start+duration) free for operation, i.e. each overlapping interval can be shared
+    bool available(size_t start, size_t duration, const std::string & operation,
+        sharing_t sharing, scheduling_direction_t dir)
+    {
+        if (duration == 0)
+        {
+            return true;
+        }
+        size_t end = start + duration;
+        for (auto it = first_overlap(start); it != intervals.end() && it->first < end; ++it)
+        {
+            bool shared;
+            if (share_start == sharing)
+            {
+                shared = (it->first == start);
+            }
+            else
+            {
+                shared = (it->second.operation == operation
+                        && (forward_scheduling == dir ? start >= it->first : end <= it->second.end));
+            }
+            if (!shared)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // occupy [start,start+duration) with operation;
+    // intervals it overlaps (which it shares, see available) are merged with it
+    void reserve(size_t start, size_t duration, const std::string & operation)
+    {
+        if (duration == 0)
+        {
+            return;
+        }
+        size_t end = start + duration;
+        auto it = first_overlap(start);
+        while (it != intervals.end() && it->first < end)
+        {
+            start = std::min(start, it->first);
+            end = std::max(end, it->second.end);
+            it = intervals.erase(it);
+        }
+        intervals.insert(std::make_pair(start, interval_t{end, operation}));
+    }
+
+    // drop the intervals that end at or before cycle;
+    // when forward scheduling never asks for cycles before it, this bounds the number of intervals kept
+    void forget(size_t cycle)
+    {
+        auto it = intervals.begin();
+        while (it != intervals.end() && it->first < cycle)
+        {
+            if (it->second.end <= cycle)
+            {
+                it = intervals.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    std::string to_string() const
+    {
+        std::stringstream ss;
+        for (auto & i : intervals)
+        {
+            ss << " [" << i.first << "," << i.second.end << "):" << i.second.operation;
+        }
+        return ss.str();
+    }
+
+private:
+    // first interval that ends after cycle start
+    intervals_t::iterator first_overlap(size_t start)
+    {
+        auto it = intervals.upper_bound(start);
+        if (it != intervals.begin() && std::prev(it)->second.end > start)
+        {
+            --it;
+        }
+        return it;
+    }
+};
+
 class ql::arch::resource_t
 {
 public:
@@ -43,6 +159,8 @@ public:
         std::string & operation_type, std::string & instruction_type, size_t operation_duration) = 0;
     virtual void reserve(size_t op_start_cycle, ql::gate * ins, std::string & operation_name,
         std::string & operation_type, std::string & instruction_type, size_t operation_duration) = 0;
+    // forward scheduling will not ask for cycles before cycle anymore, so what is kept for those can go
+    virtual void forget(size_t cycle) {}
     virtual ~resource_t() {}
     virtual resource_t* clone() const & = 0;
     virtual resource_t* clone() && = 0;
@@ -138,6 +256,14 @@ public:
         // DOUT("all resources reserved for: " << ins->qasm());
     }
 
+    void forget(size_t cycle)
+    {
+        for(auto rptr : resource_ptrs)
+        {
+            rptr->forget(cycle);
+        }
+    }
+
     // destructor destroying deep resource_t's
     // runs before shallow destruction which is done by synthesized resource_manager_t destructor
     ~resource_manager_t()
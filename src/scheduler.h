@@ -66,6 +66,10 @@
 #include <lemon/dijkstra.h>
 #include <lemon/connectivity.h>
 
+#include <deque>
+#include <set>
+#include <functional>
+
 #include "utils.h"
 #include "gate.h"
 #include "circuit.h"
@@ -79,6 +83,10 @@ using namespace lemon;
 enum DepTypes{RAW, WAW, WAR, RAR, RAD, DAR, DAD, WAD, DAW};
 const string DepTypesNames[] = {"RAW", "WAW", "WAR", "RAR", "RAD", "DAR", "DAD", "WAD", "DAW"};
 
+// the W, R and D events a gate has on each of its qubits/cregs
+enum EventTypes{W_EVENT, R_EVENT, D_EVENT};
+const string EventTypesNames[] = {"W", "R", "D"};
+
 class Scheduler
 {
 public:
@@ -105,14 +113,75 @@ public:
     size_t          creg_count;                 // number of cregs, to check/represent creg as cause of dependence
     ql::circuit*    circp;                      // current and result circuit, passed from Init to each scheduler
 
+    // frontier of dependence graph construction, see init; kept so that gates can be added later, see update
+    typedef vector<int> ReadersListType;
+    vector<int>             LastWriter;
+    vector<ReadersListType> LastReaders;
+    vector<ReadersListType> LastDs;
+    vector<int>             LastGroup;          // group of Rs or Ds before the current one, -1 when none
+    std::vector<ListDigraph::Node> gate_nodes;  // nodes of the circuit's gates, in circuit order
+    std::vector<ListDigraph::Node> dep_nodes;   // nodes of the gates and GROUPs, in a topological order
+    std::vector<ql::GROUP*> group_gates;        // GROUP instructions, owned by the scheduler
+    std::string     graph_options;              // values of the options the dependences depend on
+    bool            graph_built;
+
     // scheduler support
     std::map< std::pair<std::string,std::string>, size_t> buffer_cycles_map;
     std::map<ListDigraph::Node,size_t>  remaining;  // remaining[node] == cycles until end; critical path representation
 
+    // results kept for when gates are added by update; only those of the gates added since are computed then
+    ListDigraph::NodeMap<size_t> asap_cycle;    // cycle as computed by set_cycle forward
+    size_t          asap_count;                 // number of dep_nodes for which asap_cycle is valid
+    ql::scheduling_direction_t remaining_dir;   // direction for which remaining was computed
+    size_t          remaining_count;            // number of dep_nodes for which remaining is valid, 0 when none
+
 
 public:
     Scheduler(): instruction(graph), name(graph), weight(graph),
-        cause(graph), depType(graph) {}
+        cause(graph), depType(graph), graph_built(false), asap_cycle(graph), asap_count(0),
+        remaining_dir(ql::forward_scheduling), remaining_count(0) {}
+
+    ~Scheduler()
+    {
+        delete_dummies();
+    }
+
+    // delete the instructions that the dependence graph created itself
+    void delete_dummies()
+    {
+        if (graph_built)
+        {
+            delete instruction[s];
+            delete instruction[t];
+            for (auto gp : group_gates)
+            {
+                delete gp;
+            }
+            group_gates.clear();
+        }
+    }
+
+    // populate buffer map
+    // 'none' type is a dummy type and 0 buffer cycles will be inserted for
+    // instructions of type 'none'
+    void init_buffer_cycles(const ql::quantum_platform & platform)
+    {
+        std::vector<std::string> buffer_names = {"none", "mw", "flux", "readout"};
+        for(auto & buf1 : buffer_names)
+        {
+            for(auto & buf2 : buffer_names)
+            {
+                auto bpair = std::pair<std::string,std::string>(buf1,buf2);
+                auto bname = buf1+ "_" + buf2 + "_buffer";
+                if(platform.hardware_settings.count(bname) > 0)
+                {
+                    buffer_cycles_map[ bpair ] = std::ceil( 
+                        static_cast<float>(platform.hardware_settings[bname]) / cycle_time);
+                }
+                // DOUT("Initializing " << bname << ": "<< buffer_cycles_map[bpair]);
+            }
+        }
+    }
 
     // factored out code from Init to add a dependence between two nodes
     void add_dep(int srcID, int tgtID, enum DepTypes deptype, int operand)
@@ -126,8 +195,44 @@ public:
         DOUT("... dep " << name[srcNode] << " -> " << name[tgtNode] << " (opnd=" << operand << ", dep=" << DepTypesNames[deptype] << ")");
     }
 
+    // with commutation, make gate consID that has an R (D) event on operand depend on the Ds (Rs) before it;
+    // group is LastDs (LastReaders) of operand: when not empty, the group is closed here and becomes LastGroup;
+    // all gates of the group that the gate starts then depend on LastGroup, and LastGroup stays until a W.
+    // The gates of a group commute and have no dependences among each other, so connecting each gate of a group
+    // to each gate of the group before it would create a number of arcs quadratic in the group sizes;
+    // instead, a group of more than one gate is represented by a GROUP node that depends on each of its gates,
+    // a hyperedge, so that each gate gets a single arc from the group before it
+    void add_group_dep(ReadersListType & group, int consID, enum DepTypes deptype, size_t operand)
+    {
+        if (group.size() == 1)
+        {
+            LastGroup[operand] = group.front();
+        }
+        else if (group.size() > 1)
+        {
+            ListDigraph::Node groupNode = graph.addNode();
+            ql::GROUP* groupp = new ql::GROUP();
+            group_gates.push_back(groupp);
+            instruction[groupNode] = groupp;
+            node[groupp] = groupNode;
+            name[groupNode] = groupp->qasm();
+            dep_nodes.push_back(groupNode);
+            int groupID = graph.id(groupNode);
+            for (auto memberID : group)
+            {
+                add_dep(memberID, groupID, deptype, operand);
+            }
+            LastGroup[operand] = groupID;
+        }
+        group.clear();
+        if (LastGroup[operand] != -1)
+        {
+            add_dep(LastGroup[operand], consID, deptype, operand);
+        }
+    }
+
     // fill the dependence graph ('graph') with nodes from the circuit and adding arcs for their dependences
-    void init(ql::circuit& ckt, ql::quantum_platform platform, size_t qcount, size_t ccount)
+    void init(ql::circuit& ckt, const ql::quantum_platform & platform, size_t qcount, size_t ccount)
     {
         DOUT("Dependence graph creation ...");
         qubit_count = qcount;
@@ -135,42 +240,36 @@ public:
         size_t qubit_creg_count = qubit_count + creg_count;
         cycle_time = platform.cycle_time;
         circp = &ckt;
+        graph_options = get_graph_options();
 
-        // populate buffer map
-        // 'none' type is a dummy type and 0 buffer cycles will be inserted for
-        // instructions of type 'none'
-        //
         // this has nothing to do with dependence graph generation but with scheduling
         // so should be in resource-constrained scheduler constructor
-        std::vector<std::string> buffer_names = {"none", "mw", "flux", "readout"};
-        for(auto & buf1 : buffer_names)
+        init_buffer_cycles(platform);
+
+        // start from scratch when the graph was created before
+        if (graph_built)
         {
-            for(auto & buf2 : buffer_names)
-            {
-                auto bpair = std::pair<std::string,std::string>(buf1,buf2);
-                auto bname = buf1+ "_" + buf2 + "_buffer";
-                if(platform.hardware_settings.count(bname) > 0)
-                {
-                    buffer_cycles_map[ bpair ] = std::ceil( 
-                        static_cast<float>(platform.hardware_settings[bname]) / cycle_time);
-                }
-                // DOUT("Initializing " << bname << ": "<< buffer_cycles_map[bpair]);
-            }
+            delete_dummies();
+            graph.clear();
+            node.clear();
+            gate_nodes.clear();
+            dep_nodes.clear();
         }
+        graph_built = true;
+        asap_count = 0;
+        remaining.clear();
+        remaining_count = 0;
 
         // dependences are created with a current gate as target
         // and with those previous gates as source that have an operand match:
         // - the previous gates that Read r in LastReaders[r]; this is a list
         // - the previous gates that D qubit q in LastDs[q]; this is a list
         // - the previous gate that Wrote r in LastWriter[r]; this can only be one
+        // - with commutation, the previous group of Rs or Ds in LastGroup[r], see add_group_dep
         // operands can be a qubit or a classical register
-        typedef vector<int> ReadersListType;
-
-        vector<ReadersListType> LastReaders;
-        LastReaders.resize(qubit_creg_count);
-
-        vector<ReadersListType> LastDs;
-        LastDs.resize(qubit_creg_count);
+        LastReaders.assign(qubit_creg_count, ReadersListType());
+        LastDs.assign(qubit_creg_count, ReadersListType());
+        LastGroup.assign(qubit_creg_count, -1);
 
         // start filling the dependence graph by creating the s node, the top of the graph
         {
@@ -182,438 +281,624 @@ public:
             s=srcNode;
         }
         int srcID = graph.id(s);
-        vector<int> LastWriter(qubit_creg_count,srcID);     // it implicitly writes to all qubits and class. regs
+        LastWriter.assign(qubit_creg_count,srcID);          // it implicitly writes to all qubits and class. regs
 
         // for each gate pointer ins in the circuit, add a node and add dependences from previous gates to it
         for( auto ins : ckt )
         {
-            DOUT("Current instruction : " << ins->qasm());
+            add_node(ins);
+        }
 
-            // Add node
-            ListDigraph::Node consNode = graph.addNode();
-            int consID = graph.id(consNode);
-            instruction[consNode] = ins;
-            node[ins] = consNode;
-            name[consNode] = ins->qasm();
+        // finish filling the dependence graph by creating the t node, the bottom of the graph
+        add_sink(new ql::SINK());
 
-            // Add edges (arcs)
-            // In quantum computing there are no real Reads and Writes on qubits because they cannot be cloned.
-            // Every qubit use influences the qubit, updates it, so would be considered a Read+Write at the same time.
-            // In dependence graph construction, this leads to WAW-dependence chains of all uses of the same qubit,
-            // and hence in a scheduler using this graph to a sequentialization of those uses in the original program order.
-            //
-            // For a scheduler, only the presence of a dependence counts, not its type (RAW/WAW/etc.).
-            // A dependence graph also has other uses apart from the scheduler: e.g. to find chains of live qubits,
-            // from their creation (Prep etc.) to their destruction (Measure, etc.) in allocation of virtual to real qubits.
-            // For those uses it makes sense to make a difference with a gate doing a Read+Write, just a Write or just a Read:
-            // a Prep creates a new 'value' (Write); wait, display, x, swap, cnot, all pass this value on (so Read+Write),
-            // while a Measure 'destroys' the 'value' (Read+Write of the qubit, Write of the creg),
-            // the destruction aspect of a Measure being implied by it being followed by a Prep (Write only) on the same qubit.
-            // Furthermore Writes can model barriers on a qubit (see Wait, Display, etc.), because Writes sequentialize.
-            // The dependence graph creation below models a graph suitable for all functions, including chains of live qubits.
+        // useless because by construction, there cannot be cycles
+        // but when afterwards dependences are added, cycles may be created,
+        // and after doing so (a copy of) this test should certainly be done because
+        // a cyclic dependence graph cannot be scheduled;
+        // this test here is a kind of debugging aid whether dependence creation was done well
+        if( !dag(graph) )
+        {
+            DOUT("The dependence graph is not a DAG.");
+            EOUT("The dependence graph is not a DAG.");
+        }
+        DOUT("Dependence graph creation Done.");
+    }
 
-            if (ql::options::get("scheduler_post179") == "yes")
+    // as init, but when the dependence graph was created by init/update from a circuit of which ckt is an extension,
+    // and with the same parameters, only the gates appended since are added to it, with their dependences;
+    // this is what happens when gates are added to a kernel that was compiled before;
+    // the gates need not be the same objects, but must have the same qasm and duration;
+    // the asap cycles and remaining values computed by the schedulers are then updated incrementally as well
+    void update(ql::circuit& ckt, const ql::quantum_platform & platform, size_t qcount, size_t ccount)
+    {
+        if (!graph_built
+            || qcount != qubit_count
+            || ccount != creg_count
+            || platform.cycle_time != cycle_time
+            || get_graph_options() != graph_options
+            || ckt.size() < gate_nodes.size()
+           )
+        {
+            init(ckt, platform, qcount, ccount);
+            return;
+        }
+        std::vector<size_t> rebound;    // indices of the gates that are other objects than before
+        for (size_t i = 0; i < gate_nodes.size(); i++)
+        {
+            ListDigraph::Node   n = gate_nodes[i];
+            ql::gate*           gp = ckt[i];
+            if (gp->qasm() != name[n] || gp->duration != instruction[n]->duration)
             {
-            // Control-operands of Controlled Unitaries commute, independent of the Unitary,
-            // i.e. these gates need not be kept in order.
-            // But, of course, those qubit uses should be ordered after (/before) the last (/next) non-control use of the qubit.
-            // In this way, those control-operand qubit uses would be like pure Reads in dependence graph construction.
-            // A problem might be that the gates with the same control-operands might be scheduled in parallel then.
-            // In a non-resource scheduler that will happen but it doesn't do harm because it is not a real machine.
-            // In a resource-constrained scheduler the resource constraint that prohibits more than one use
-            // of the same qubit being active at the same time, will prevent this parallelism.
-            // So ignoring Read After Read (RAR) dependences enables the scheduler to take advantage
-            // of the commutation property of Controlled Unitaries without disadvantages.
-            //
-            // In more detail:
-            // 1. CU1(a,b) and CU2(a,c) commute (for any U1, U2, so also can be equal and/or be CNOT and/or be CZ)
-            // 2. CNOT(a,b) and CNOT(c,b) commute (property of CNOT only).
-            // 3. CZ(a,b) and CZ(b,a) are identical (property of CZ only).
-            // 4. CNOT(a,b) commutes with CZ(a,c) (from 1.) and thus with CZ(c,a) (from 3.)
-            // 5. CNOT(a,b) does not commute with CZ(c,b) (and thus not with CZ(b,c), from 3.)
-            // To support this, next to R and W a D (for controlleD operand :-) is introduced for the target operand of CNOT.
-            // The events (instead of just Read and Write) become then:
-            // - Both operands of CZ are just Read.
-            // - The control operand of CNOT is Read, the target operand is D.
-            // - Of any other Control Unitary, the control operand is Read and the target operand is Write (not D!)
-            // - Of any other gate the operands are Read+Write or just Write (as usual to represent flow).
-            // With this, we effectively get the following table of event transitions (from left-bottom to right-up),
-            // in which 'no' indicates no dependence from left event to top event and '/' indicates a dependence from left to top.
-            //
-            //             W   R   D                  w   R   D
-            //        W    /   /   /              W   WAW RAW DAW
-            //        R    /   no  /              R   WAR RAR DAR
-            //        D    /   /   no             D   WAD RAD DAD
-            //
-            // In addition to LastReaders, we introduce LastDs.
-            // Either one is cleared when dependences are generated from them, and extended otherwise.
-            // From the table it can be seen that the D 'behaves' as a Write to Read, and as a Read to Write,
-            // that there is no order among Ds nor among Rs, but D after R and R after D sequentialize.
-            // With this, the dependence graph is claimed to represent the commutations as above.
-            //
-            // The post179 schedulers are list schedulers, i.e. they maintain a list of gates in their algorithm,
-            // of gates available for being scheduled because they are not blocked by dependences on non-scheduled gates.
-            // Therefore, the post179 schedulers are able to select the best one from a set of commutable gates.
+                DOUT("Dependence graph update: circuit differs at gate " << i << ", recreating it");
+                init(ckt, platform, qcount, ccount);
+                return;
+            }
+            if (gp != instruction[n])
+            {
+                rebound.push_back(i);
             }
+        }
+        for (auto i : rebound)
+        {
+            node.erase(instruction[gate_nodes[i]]);
+        }
+        for (auto i : rebound)
+        {
+            instruction[gate_nodes[i]] = ckt[i];
+            node[ckt[i]] = gate_nodes[i];
+        }
+
+        DOUT("Dependence graph update with " << ckt.size() - gate_nodes.size() << " gates ...");
+        circp = &ckt;
+        init_buffer_cycles(platform);
+
+        // the deps to SINK are those of the old frontier, so SINK is recreated after the new gates;
+        // this also keeps it the last node, as the pre179 schedulers' topological sort expects
+        ql::gate* sinkp = instruction[t];
+        graph.erase(t);
+        for (size_t i = gate_nodes.size(); i < ckt.size(); i++)
+        {
+            add_node(ckt[i]);
+        }
+        add_sink(sinkp);
+        DOUT("Dependence graph update Done.");
+    }
+
+    // the options that dependence graph creation depends on
+    std::string get_graph_options()
+    {
+        return ql::options::get("scheduler_post179") + ql::options::get("scheduler_commute");
+    }
 
-            // each type of gate has a different 'signature' of events; switch out to each one
+    // with commutation, a custom gate can define the event on each of its qubit operands
+    // in the "operand_access" attribute of its instruction in the hardware configuration:
+    // "W" (the default of any gate), "R" (commutes with other Rs, as the operands of CZ and the control of CNOT)
+    // or "D" (commutes with other Ds, as the target of CNOT); see add_node for the events;
+    // return whether ins has such an attribute and then its events in access
+    bool get_operand_access(ql::gate* ins, std::vector<EventTypes> & access)
+    {
+        access.clear();
+        if (ins->type() != ql::gate_type_t::__custom_gate__
+        ||  ql::options::get("scheduler_post179") != "yes"
+        ||  ql::options::get("scheduler_commute") != "yes")
+        {
+            return false;
+        }
+        ql::strings_t & operand_access = ((ql::custom_gate*)ins)->operand_access;
+        if (operand_access.empty())
+        {
+            return false;
+        }
+        if (operand_access.size() != ins->operands.size())
+        {
+            EOUT("gate " << ins->qasm() << " has " << ins->operands.size() << " qubit operands but 'operand_access' has " << operand_access.size() << " accesses");
+            throw ql::exception("[x] error : ql::scheduler : the 'operand_access' of gate '" + ins->qasm() + "' does not match its qubit operands !",false);
+        }
+        for (auto & a : operand_access)
+        {
+            access.push_back(a == "R" ? R_EVENT : (a == "D" ? D_EVENT : W_EVENT));
+        }
+        return true;
+    }
 
-            // TODO: define signature in .json file similar to how gcc defines instructions
-            // and then have a signature interpreter here; then we don't have this long if-chain
-            // and, more importantly, we don't have the knowledge of particular gates here;
-            // the default signature would be that of a default gate, modifying each qubit operand;
-            // that also solves
-            if(ins->name == "measure")
+    // add a node for gate ins and dependences to it from the previous gates, given the current frontier;
+    // and update the frontier
+    void add_node(ql::gate* ins)
+    {
+        size_t qubit_creg_count = qubit_count + creg_count;
+        DOUT("Current instruction : " << ins->qasm());
+
+        // Add node
+        ListDigraph::Node consNode = graph.addNode();
+        int consID = graph.id(consNode);
+        instruction[consNode] = ins;
+        node[ins] = consNode;
+        name[consNode] = ins->qasm();
+
+        // Add edges (arcs)
+        // In quantum computing there are no real Reads and Writes on qubits because they cannot be cloned.
+        // Every qubit use influences the qubit, updates it, so would be considered a Read+Write at the same time.
+        // In dependence graph construction, this leads to WAW-dependence chains of all uses of the same qubit,
+        // and hence in a scheduler using this graph to a sequentialization of those uses in the original program order.
+        //
+        // For a scheduler, only the presence of a dependence counts, not its type (RAW/WAW/etc.).
+        // A dependence graph also has other uses apart from the scheduler: e.g. to find chains of live qubits,
+        // from their creation (Prep etc.) to their destruction (Measure, etc.) in allocation of virtual to real qubits.
+        // For those uses it makes sense to make a difference with a gate doing a Read+Write, just a Write or just a Read:
+        // a Prep creates a new 'value' (Write); wait, display, x, swap, cnot, all pass this value on (so Read+Write),
+        // while a Measure 'destroys' the 'value' (Read+Write of the qubit, Write of the creg),
+        // the destruction aspect of a Measure being implied by it being followed by a Prep (Write only) on the same qubit.
+        // Furthermore Writes can model barriers on a qubit (see Wait, Display, etc.), because Writes sequentialize.
+        // The dependence graph creation below models a graph suitable for all functions, including chains of live qubits.
+
+        if (ql::options::get("scheduler_post179") == "yes")
+        {
+        // Control-operands of Controlled Unitaries commute, independent of the Unitary,
+        // i.e. these gates need not be kept in order.
+        // But, of course, those qubit uses should be ordered after (/before) the last (/next) non-control use of the qubit.
+        // In this way, those control-operand qubit uses would be like pure Reads in dependence graph construction.
+        // A problem might be that the gates with the same control-operands might be scheduled in parallel then.
+        // In a non-resource scheduler that will happen but it doesn't do harm because it is not a real machine.
+        // In a resource-constrained scheduler the resource constraint that prohibits more than one use
+        // of the same qubit being active at the same time, will prevent this parallelism.
+        // So ignoring Read After Read (RAR) dependences enables the scheduler to take advantage
+        // of the commutation property of Controlled Unitaries without disadvantages.
+        //
+        // In more detail:
+        // 1. CU1(a,b) and CU2(a,c) commute (for any U1, U2, so also can be equal and/or be CNOT and/or be CZ)
+        // 2. CNOT(a,b) and CNOT(c,b) commute (property of CNOT only).
+        // 3. CZ(a,b) and CZ(b,a) are identical (property of CZ only).
+        // 4. CNOT(a,b) commutes with CZ(a,c) (from 1.) and thus with CZ(c,a) (from 3.)
+        // 5. CNOT(a,b) does not commute with CZ(c,b) (and thus not with CZ(b,c), from 3.)
+        // To support this, next to R and W a D (for controlleD operand :-) is introduced for the target operand of CNOT.
+        // The events (instead of just Read and Write) become then:
+        // - Both operands of CZ are just Read.
+        // - The control operand of CNOT is Read, the target operand is D.
+        // - Of any other Control Unitary, the control operand is Read and the target operand is Write (not D!)
+        // - Of any other gate the operands are Read+Write or just Write (as usual to represent flow).
+        // With this, we effectively get the following table of event transitions (from left-bottom to right-up),
+        // in which 'no' indicates no dependence from left event to top event and '/' indicates a dependence from left to top.
+        //
+        //             W   R   D                  w   R   D
+        //        W    /   /   /              W   WAW RAW DAW
+        //        R    /   no  /              R   WAR RAR DAR
+        //        D    /   /   no             D   WAD RAD DAD
+        //
+        // In addition to LastReaders, we introduce LastDs.
+        // Either one is cleared when dependences are generated from them, and extended otherwise.
+        // With commutation, the one cleared by a commuting gate is kept as LastGroup, see add_group_dep.
+        // From the table it can be seen that the D 'behaves' as a Write to Read, and as a Read to Write,
+        // that there is no order among Ds nor among Rs, but D after R and R after D sequentialize.
+        // With this, the dependence graph is claimed to represent the commutations as above.
+        //
+        // The post179 schedulers are list schedulers, i.e. they maintain a list of gates in their algorithm,
+        // of gates available for being scheduled because they are not blocked by dependences on non-scheduled gates.
+        // Therefore, the post179 schedulers are able to select the best one from a set of commutable gates.
+        }
+
+        // each type of gate has a different 'signature' of events; switch out to each one
+
+        // TODO: define signature in .json file similar to how gcc defines instructions
+        // and then have a signature interpreter here; then we don't have this long if-chain
+        // and, more importantly, we don't have the knowledge of particular gates here;
+        // the default signature would be that of a default gate, modifying each qubit operand;
+        // that also solves
+        // With commutation, custom gates can already define the events on their qubit operands,
+        // in the "operand_access" attribute of their instruction, see get_operand_access.
+        std::vector<EventTypes> access;
+        if (get_operand_access(ins, access))
+        {
+            DOUT(". considering " << name[consNode] << " by its operand access");
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            for( auto operand : operands )
             {
-                DOUT(". considering " << name[consNode] << " as measure");
-                // Read+Write each qubit operand + Write corresponding creg
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                DOUT(".. Operand: " << operand << " (" << EventTypesNames[access[operandNo]] << ")");
+                if (access[operandNo] == R_EVENT)
+                {
+                    add_dep(LastWriter[operand], consID, RAW, operand);
+                    add_group_dep(LastDs[operand], consID, RAD, operand);
+                }
+                else if (access[operandNo] == D_EVENT)
+                {
+                    add_dep(LastWriter[operand], consID, DAW, operand);
+                    add_group_dep(LastReaders[operand], consID, DAR, operand);
+                }
+                else
                 {
-                    DOUT(".. Operand: " << operand);
                     add_dep(LastWriter[operand], consID, WAW, operand);
                     for(auto & readerID : LastReaders[operand])
                     {
                         add_dep(readerID, consID, WAR, operand);
                     }
-                    if (ql::options::get("scheduler_post179") == "yes")
+                    for(auto & readerID : LastDs[operand])
                     {
-                        for(auto & readerID : LastDs[operand])
-                        {
-                            add_dep(readerID, consID, WAD, operand);
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
                 }
+                operandNo++;
+            } // end of operand for
 
-                ql::measure * mins = (ql::measure*)ins;
-                for( auto operand : mins->creg_operands )
+            // classical register operands are Written
+            for( auto operand : ins->creg_operands )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[qubit_count+operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[qubit_count+operand])
                 {
-                    DOUT(".. Operand: " << operand);
-                    add_dep(LastWriter[qubit_count+operand], consID, WAW, operand);
-                    for(auto & readerID : LastReaders[qubit_count+operand])
-                    {
-                        add_dep(readerID, consID, WAR, operand);
-                    }
+                    add_dep(readerID, consID, WAR, operand);
                 }
+            }
 
-                // update LastWriter and so clear LastReaders
-                for( auto operand : operands )
+            // update LastWriter/LastReaders/LastDs
+            operandNo=0;
+            for( auto operand : operands )
+            {
+                if (access[operandNo] == R_EVENT)
                 {
-                    LastWriter[operand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        LastReaders[operand].clear();
-                        LastDs[operand].clear();
-                    }
+                    LastDs[operand].clear();
+                    LastReaders[operand].push_back(consID);
                 }
-                for( auto operand : mins->creg_operands )
+                else if (access[operandNo] == D_EVENT)
+                {
+                    LastReaders[operand].clear();
+                    LastDs[operand].push_back(consID);
+                }
+                else
                 {
                     LastWriter[operand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        LastReaders[operand].clear();
-                    }
+                    LastReaders[operand].clear();
+                    LastDs[operand].clear();
+                    LastGroup[operand] = -1;
                 }
+                operandNo++;
             }
-            else if(ins->name == "display")
+            for( auto operand : ins->creg_operands )
+            {
+                LastWriter[qubit_count+operand] = consID;
+                LastReaders[qubit_count+operand].clear();
+            }
+        }
+        else if(ins->name == "measure")
+        {
+            DOUT(". considering " << name[consNode] << " as measure");
+            // Read+Write each qubit operand + Write corresponding creg
+            auto operands = ins->operands;
+            for( auto operand : operands )
             {
-                DOUT(". considering " << name[consNode] << " as display");
-                // no operands, display all qubits and cregs
-                // Read+Write each operand
-                std::vector<size_t> qubits(qubit_creg_count);
-                std::iota(qubits.begin(), qubits.end(), 0);
-                for( auto operand : qubits )
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[operand])
                 {
-                    DOUT(".. Operand: " << operand);
-                    add_dep(LastWriter[operand], consID, WAW, operand);
-                    for(auto & readerID : LastReaders[operand])
-                    {
-                        add_dep(readerID, consID, WAR, operand);
-                    }
-                    if (ql::options::get("scheduler_post179") == "yes")
+                    add_dep(readerID, consID, WAR, operand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        for(auto & readerID : LastDs[operand])
-                        {
-                            add_dep(readerID, consID, WAD, operand);
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
                 }
+            }
+
+            ql::measure * mins = (ql::measure*)ins;
+            for( auto operand : mins->creg_operands )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[qubit_count+operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[qubit_count+operand])
+                {
+                    add_dep(readerID, consID, WAR, operand);
+                }
+            }
 
-                // now update LastWriter and so clear LastReaders/LastDs
-                for( auto operand : qubits )
+            // update LastWriter and so clear LastReaders
+            for( auto operand : operands )
+            {
+                LastWriter[operand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
                 {
-                    LastWriter[operand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        LastReaders[operand].clear();
-                        LastDs[operand].clear();
-                    }
+                    LastReaders[operand].clear();
+                    LastDs[operand].clear();
+                    LastGroup[operand] = -1;
                 }
             }
-            else if(ins->type() == ql::gate_type_t::__classical_gate__)
+            for( auto operand : mins->creg_operands )
             {
-                DOUT(". considering " << name[consNode] << " as classical gate");
-                std::vector<size_t> all_operands(qubit_creg_count);
-                std::iota(all_operands.begin(), all_operands.end(), 0);
-                for( auto operand : all_operands )
+                LastWriter[operand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
                 {
-                    DOUT(".. Operand: " << operand);
-                    add_dep(LastWriter[operand], consID, WAW, operand);
-                    for(auto & readerID : LastReaders[operand])
+                    LastReaders[operand].clear();
+                }
+            }
+        }
+        else if(ins->name == "display")
+        {
+            DOUT(". considering " << name[consNode] << " as display");
+            // no operands, display all qubits and cregs
+            // Read+Write each operand
+            std::vector<size_t> qubits(qubit_creg_count);
+            std::iota(qubits.begin(), qubits.end(), 0);
+            for( auto operand : qubits )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[operand])
+                {
+                    add_dep(readerID, consID, WAR, operand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        add_dep(readerID, consID, WAR, operand);
-                    }
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        for(auto & readerID : LastDs[operand])
-                        {
-                            add_dep(readerID, consID, WAD, operand);
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
                 }
+            }
 
-                // now update LastWriter and so clear LastReaders/LastDs
-                for( auto operand : all_operands )
+            // now update LastWriter and so clear LastReaders/LastDs
+            for( auto operand : qubits )
+            {
+                LastWriter[operand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
                 {
-                    LastWriter[operand] = consID;
-                    if (ql::options::get("scheduler_post179") == "yes")
-                    {
-                        LastReaders[operand].clear();
-                        LastDs[operand].clear();
-                    }
+                    LastReaders[operand].clear();
+                    LastDs[operand].clear();
+                    LastGroup[operand] = -1;
                 }
             }
-            else if (  ins->name == "cnot"
-                    )
+        }
+        else if(ins->type() == ql::gate_type_t::__classical_gate__)
+        {
+            DOUT(". considering " << name[consNode] << " as classical gate");
+            std::vector<size_t> all_operands(qubit_creg_count);
+            std::iota(all_operands.begin(), all_operands.end(), 0);
+            for( auto operand : all_operands )
             {
-                DOUT(". considering " << name[consNode] << " as cnot");
-                // CNOTs Read the first operands, and Ds the second operand
-                size_t operandNo=0;
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[operand])
                 {
-                    DOUT(".. Operand: " << operand);
-                    if( operandNo == 0)
+                    add_dep(readerID, consID, WAR, operand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        add_dep(LastWriter[operand], consID, RAW, operand);
-	                    if (ql::options::get("scheduler_post179") == "no"
-	                    ||  ql::options::get("scheduler_commute") == "no")
-                        {
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, RAR, operand);
-                            }
-                        }
-                        if (ql::options::get("scheduler_post179") == "yes")
-                        {
-                            for(auto & readerID : LastDs[operand])
-                            {
-                                add_dep(readerID, consID, RAD, operand);
-                            }
-                        }
+                        add_dep(readerID, consID, WAD, operand);
                     }
-                    else
-                    {
-	                    if (ql::options::get("scheduler_post179") == "no")
-                        {
-                            add_dep(LastWriter[operand], consID, WAW, operand);
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, WAR, operand);
-                            }
-                        }
-                        else
-                        {
-                            add_dep(LastWriter[operand], consID, DAW, operand);
-	                        if (ql::options::get("scheduler_commute") == "no")
-                            {
-                                for(auto & readerID : LastDs[operand])
-                                {
-                                    add_dep(readerID, consID, DAD, operand);
-                                }
-                            }
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, DAR, operand);
-                            }
-                        }
-                    }
-                    operandNo++;
-                } // end of operand for
+                }
+            }
 
-                // now update LastWriter and so clear LastReaders
-                operandNo=0;
-                for( auto operand : operands )
+            // now update LastWriter and so clear LastReaders/LastDs
+            for( auto operand : all_operands )
+            {
+                LastWriter[operand] = consID;
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    LastReaders[operand].clear();
+                    LastDs[operand].clear();
+                    LastGroup[operand] = -1;
+                }
+            }
+        }
+        else if (  ins->name == "cnot"
+                )
+        {
+            DOUT(". considering " << name[consNode] << " as cnot");
+            // CNOTs Read the first operands, and Ds the second operand
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                if( operandNo == 0)
                 {
-                    if( operandNo == 0)
+                    add_dep(LastWriter[operand], consID, RAW, operand);
+	                if (ql::options::get("scheduler_post179") == "no"
+	                ||  ql::options::get("scheduler_commute") == "no")
                     {
-                        // update LastReaders for this operand 0
-                        LastReaders[operand].push_back(consID);
-                        if (ql::options::get("scheduler_post179") == "yes")
+                        for(auto & readerID : LastReaders[operand])
                         {
-                            LastDs[operand].clear();
+                            add_dep(readerID, consID, RAR, operand);
                         }
                     }
-                    else
+                    if (ql::options::get("scheduler_post179") == "yes")
                     {
-	                    if (ql::options::get("scheduler_post179") == "no")
+	                    if (ql::options::get("scheduler_commute") == "yes")
                         {
-	                        LastWriter[operand] = consID;
+                            add_group_dep(LastDs[operand], consID, RAD, operand);
                         }
                         else
                         {
-                            LastDs[operand].push_back(consID);
+                            for(auto & readerID : LastDs[operand])
+                            {
+                                add_dep(readerID, consID, RAD, operand);
+                            }
                         }
-	                    LastReaders[operand].clear();
                     }
-                    operandNo++;
                 }
-            }
-            else if (  ins->name == "cz"
-                    || ins->name == "cphase"
-                    )
-            {
-                DOUT(". considering " << name[consNode] << " as cz");
-                // CZs Read all operands for post179
-                // CZs Read all operands and write last one for pre179 
-                size_t operandNo=0;
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                else
                 {
-                    DOUT(".. Operand: " << operand);
-                    if (ql::options::get("scheduler_post179") == "no")
+	                if (ql::options::get("scheduler_post179") == "no")
                     {
-                        add_dep(LastWriter[operand], consID, RAW, operand);
+                        add_dep(LastWriter[operand], consID, WAW, operand);
                         for(auto & readerID : LastReaders[operand])
                         {
-                            add_dep(readerID, consID, RAR, operand);
+                            add_dep(readerID, consID, WAR, operand);
                         }
-	                    if( operandNo != 0)
-	                    {
-                            add_dep(LastWriter[operand], consID, WAW, operand);
-                            for(auto & readerID : LastReaders[operand])
-                            {
-                                add_dep(readerID, consID, WAR, operand);
-                            }
-	                    }
                     }
                     else
                     {
-                        if (ql::options::get("scheduler_commute") == "no")
+                        add_dep(LastWriter[operand], consID, DAW, operand);
+	                    if (ql::options::get("scheduler_commute") == "no")
                         {
+                            for(auto & readerID : LastDs[operand])
+                            {
+                                add_dep(readerID, consID, DAD, operand);
+                            }
                             for(auto & readerID : LastReaders[operand])
                             {
-                                add_dep(readerID, consID, RAR, operand);
+                                add_dep(readerID, consID, DAR, operand);
                             }
                         }
-                        add_dep(LastWriter[operand], consID, RAW, operand);
-                        for(auto & readerID : LastDs[operand])
+                        else
                         {
-                            add_dep(readerID, consID, RAD, operand);
+                            add_group_dep(LastReaders[operand], consID, DAR, operand);
                         }
                     }
-                    operandNo++;
-                } // end of operand for
+                }
+                operandNo++;
+            } // end of operand for
 
-                // update LastReaders etc.
-                operandNo=0;
-                for( auto operand : operands )
+            // now update LastWriter and so clear LastReaders
+            operandNo=0;
+            for( auto operand : operands )
+            {
+                if( operandNo == 0)
+                {
+                    // update LastReaders for this operand 0
+                    LastReaders[operand].push_back(consID);
+                    if (ql::options::get("scheduler_post179") == "yes")
+                    {
+                        LastDs[operand].clear();
+                    }
+                }
+                else
                 {
-                    if (ql::options::get("scheduler_post179") == "no")
+	                if (ql::options::get("scheduler_post179") == "no")
                     {
-	                    if( operandNo == 0)
-	                    {
-	                        LastReaders[operand].push_back(consID);
-	                    }
-	                    else
-	                    {
-	                        LastWriter[operand] = consID;
-	                        LastReaders[operand].clear();
-	                    }
+	                    LastWriter[operand] = consID;
                     }
                     else
                     {
-                        LastDs[operand].clear();
-                        LastReaders[operand].push_back(consID);
+                        LastDs[operand].push_back(consID);
                     }
-                    operandNo++;
+	                LastReaders[operand].clear();
                 }
+                operandNo++;
             }
-#ifdef HAVEGENERALCONTROLUNITARIES
-            else if (
-                    // or is a Control Unitary in general
-                    // Read on all operands, Write on last operand
-                    // before implementing it, check whether all commutativity on Reads above hold for this Control Unitary
-                    )
-            {
-                DOUT(". considering " << name[consNode] << " as Control Unitary");
-                // Control Unitaries Read all operands, and Write the last operand
-                size_t operandNo=0;
-                auto operands = ins->operands;
-                size_t op_count = operands.size();
-                for( auto operand : operands )
-                {
-                    DOUT(".. Operand: " << operand);
+        }
+        else if (  ins->name == "cz"
+                || ins->name == "cphase"
+                )
+        {
+            DOUT(". considering " << name[consNode] << " as cz");
+            // CZs Read all operands for post179
+            // CZs Read all operands and write last one for pre179 
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                if (ql::options::get("scheduler_post179") == "no")
+                {
                     add_dep(LastWriter[operand], consID, RAW, operand);
-                    if (ql::options::get("scheduler_post179") == "no"
-                    ||  ql::options::get("scheduler_commute") == "no")
+                    for(auto & readerID : LastReaders[operand])
+                    {
+                        add_dep(readerID, consID, RAR, operand);
+                    }
+	                if( operandNo != 0)
+	                {
+                        add_dep(LastWriter[operand], consID, WAW, operand);
+                        for(auto & readerID : LastReaders[operand])
+                        {
+                            add_dep(readerID, consID, WAR, operand);
+                        }
+	                }
+                }
+                else
+                {
+                    if (ql::options::get("scheduler_commute") == "no")
                     {
                         for(auto & readerID : LastReaders[operand])
                         {
                             add_dep(readerID, consID, RAR, operand);
                         }
                     }
-                    if (ql::options::get("scheduler_post179") == "yes")
+                    add_dep(LastWriter[operand], consID, RAW, operand);
+                    if (ql::options::get("scheduler_commute") == "yes")
+                    {
+                        add_group_dep(LastDs[operand], consID, RAD, operand);
+                    }
+                    else
                     {
                         for(auto & readerID : LastDs[operand])
                         {
                             add_dep(readerID, consID, RAD, operand);
                         }
                     }
+                }
+                operandNo++;
+            } // end of operand for
 
-                    if( operandNo < op_count-1 )
+            // update LastReaders etc.
+            operandNo=0;
+            for( auto operand : operands )
+            {
+                if (ql::options::get("scheduler_post179") == "no")
+                {
+	                if( operandNo == 0)
+	                {
+	                    LastReaders[operand].push_back(consID);
+	                }
+	                else
+	                {
+	                    LastWriter[operand] = consID;
+	                    LastReaders[operand].clear();
+	                }
+                }
+                else
+                {
+                    LastDs[operand].clear();
+                    LastReaders[operand].push_back(consID);
+                }
+                operandNo++;
+            }
+        }
+#ifdef HAVEGENERALCONTROLUNITARIES
+        else if (
+                // or is a Control Unitary in general
+                // Read on all operands, Write on last operand
+                // before implementing it, check whether all commutativity on Reads above hold for this Control Unitary
+                )
+        {
+            DOUT(". considering " << name[consNode] << " as Control Unitary");
+            // Control Unitaries Read all operands, and Write the last operand
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            size_t op_count = operands.size();
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, RAW, operand);
+                if (ql::options::get("scheduler_post179") == "no"
+                ||  ql::options::get("scheduler_commute") == "no")
+                {
+                    for(auto & readerID : LastReaders[operand])
                     {
-                        LastReaders[operand].push_back(consID);
-                        if (ql::options::get("scheduler_post179") == "yes")
-                        {
-                            LastDs[operand].clear();
-                        }
+                        add_dep(readerID, consID, RAR, operand);
                     }
-                    else
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
                     {
-                        add_dep(LastWriter[operand], consID, WAW, operand);
-                        for(auto & readerID : LastReaders[operand])
-                        {
-                            add_dep(readerID, consID, WAR, operand);
-                        }
-                        if (ql::options::get("scheduler_post179") == "yes")
-                        {
-                            for(auto & readerID : LastDs[operand])
-                            {
-                                add_dep(readerID, consID, WAD, operand);
-                            }
-                        }
+                        add_dep(readerID, consID, RAD, operand);
+                    }
+                }
 
-                        LastWriter[operand] = consID;
-                        LastReaders[operand].clear();
-                        if (ql::options::get("scheduler_post179") == "yes")
-                        {
-                            LastDs[operand].clear();
-                        }
+                if( operandNo < op_count-1 )
+                {
+                    LastReaders[operand].push_back(consID);
+                    if (ql::options::get("scheduler_post179") == "yes")
+                    {
+                        LastDs[operand].clear();
                     }
-                    operandNo++;
-                } // end of operand for
-            }
-#endif  // HAVEGENERALCONTROLUNITARIES
-            else
-            {
-                DOUT(". considering " << name[consNode] << " as general quantum gate");
-                // general quantum gate, Read+Write on each operand
-                size_t operandNo=0;
-                auto operands = ins->operands;
-                for( auto operand : operands )
+                }
+                else
                 {
-                    DOUT(".. Operand: " << operand);
                     add_dep(LastWriter[operand], consID, WAW, operand);
                     for(auto & readerID : LastReaders[operand])
                     {
@@ -633,76 +918,88 @@ public:
                     {
                         LastDs[operand].clear();
                     }
-                    
-                    operandNo++;
-                } // end of operand for
-            } // end of if/else
-        } // end of instruction for
-
-        // finish filling the dependence graph by creating the t node, the bottom of the graph
-        {
-	        // add dummy target node
-	        ListDigraph::Node consNode = graph.addNode();
-	        int consID = graph.id(consNode);
-	        instruction[consNode] = new ql::SINK();
-	        node[instruction[consNode]] = consNode;
-	        name[consNode] = instruction[consNode]->qasm();
-	        t=consNode;
-	
-	        DOUT("adding deps to SINK");
-	        // add deps to the dummy target node to close the dependence chains
-	        // it behaves as a W to every qubit and creg
-	        //
-	        // to guarantee that exactly at start of execution of dummy SINK,
-	        // all still executing nodes complete, give arc weight of those nodes;
-	        // this is relevant for ALAP (which starts backward from SINK for all these nodes);
-	        // also for accurately computing the circuit's depth (which includes full completion);
-	        // and also for implementing scheduling and mapping across control-flow (so that it is
-	        // guaranteed that on a jump and on start of target circuit, the source circuit completed).
-            //
-            // note that there always is a LastWriter: the dummy source node wrote to every qubit and class. reg
-	        std::vector<size_t> qubits(qubit_creg_count);
-	        std::iota(qubits.begin(), qubits.end(), 0);
-	        for( auto operand : qubits )
-	        {
-	            DOUT(".. Operand: " << operand);
-	            add_dep(LastWriter[operand], consID, WAW, operand);
-	            for(auto & readerID : LastReaders[operand])
-	            {
-	                add_dep(readerID, consID, WAR, operand);
-	            }
-	            if (ql::options::get("scheduler_post179") == "yes")
-	            {
-	                for(auto & readerID : LastDs[operand])
-	                {
-	                    add_dep(readerID, consID, WAD, operand);
-	                }
-	            }
-	        }
-	
-            // useless because there is nothing after t but destruction
-	        for( auto operand : qubits )
-	        {
-	            LastWriter[operand] = consID;
-	            LastReaders[operand].clear();
-	            if (ql::options::get("scheduler_post179") == "yes")
-	            {
-	                LastDs[operand].clear();
-	            }
-	        }
+                }
+                operandNo++;
+            } // end of operand for
         }
+#endif  // HAVEGENERALCONTROLUNITARIES
+        else
+        {
+            DOUT(". considering " << name[consNode] << " as general quantum gate");
+            // general quantum gate, Read+Write on each operand
+            size_t operandNo=0;
+            auto operands = ins->operands;
+            for( auto operand : operands )
+            {
+                DOUT(".. Operand: " << operand);
+                add_dep(LastWriter[operand], consID, WAW, operand);
+                for(auto & readerID : LastReaders[operand])
+                {
+                    add_dep(readerID, consID, WAR, operand);
+                }
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    for(auto & readerID : LastDs[operand])
+                    {
+                        add_dep(readerID, consID, WAD, operand);
+                    }
+                }
 
-        // useless as well because by construction, there cannot be cycles
-        // but when afterwards dependences are added, cycles may be created,
-        // and after doing so (a copy of) this test should certainly be done because
-        // a cyclic dependence graph cannot be scheduled;
-        // this test here is a kind of debugging aid whether dependence creation was done well
-        if( !dag(graph) )
+                LastWriter[operand] = consID;
+                LastReaders[operand].clear();
+                if (ql::options::get("scheduler_post179") == "yes")
+                {
+                    LastDs[operand].clear();
+                    LastGroup[operand] = -1;
+                }
+                
+                operandNo++;
+            } // end of operand for
+        } // end of if/else
+        gate_nodes.push_back(consNode);
+        dep_nodes.push_back(consNode);
+    }
+
+    // add the dummy target node t with SINK instruction sinkp, and its deps from the current frontier
+    void add_sink(ql::gate* sinkp)
+    {
+        size_t qubit_creg_count = qubit_count + creg_count;
+        ListDigraph::Node consNode = graph.addNode();
+        instruction[consNode] = sinkp;
+        node[sinkp] = consNode;
+        name[consNode] = sinkp->qasm();
+        t = consNode;
+        int consID = graph.id(t);
+
+        DOUT("adding deps to SINK");
+        // add deps to the dummy target node to close the dependence chains
+        // it behaves as a W to every qubit and creg
+        //
+        // to guarantee that exactly at start of execution of dummy SINK,
+        // all still executing nodes complete, give arc weight of those nodes;
+        // this is relevant for ALAP (which starts backward from SINK for all these nodes);
+        // also for accurately computing the circuit's depth (which includes full completion);
+        // and also for implementing scheduling and mapping across control-flow (so that it is
+        // guaranteed that on a jump and on start of target circuit, the source circuit completed).
+        //
+        // note that there always is a LastWriter: the dummy source node wrote to every qubit and class. reg;
+        // the frontier is not updated, so that gates can be added later, see update
+        for( size_t operand = 0; operand < qubit_creg_count; operand++ )
         {
-            DOUT("The dependence graph is not a DAG.");
-            EOUT("The dependence graph is not a DAG.");
+            DOUT(".. Operand: " << operand);
+            add_dep(LastWriter[operand], consID, WAW, operand);
+            for(auto & readerID : LastReaders[operand])
+            {
+                add_dep(readerID, consID, WAR, operand);
+            }
+            if (ql::options::get("scheduler_post179") == "yes")
+            {
+                for(auto & readerID : LastDs[operand])
+                {
+                    add_dep(readerID, consID, WAD, operand);
+                }
+            }
         }
-        DOUT("Dependence graph creation Done.");
     }
 
     void print()
@@ -2123,22 +2420,33 @@ private:
         {
             instruction[s]->cycle = 0;
             DOUT("... set_cycle of " << instruction[s]->qasm() << " cycles " << instruction[s]->cycle);
-            // *circp is by definition in a topological order of the dependence graph
-            for ( ql::circuit::iterator gpit = circp->begin(); gpit != circp->end(); gpit++)
+            // dep_nodes is in a topological order of the dependence graph;
+            // nodes added to the graph since the previous call are the only ones of which the cycle can change
+            for (size_t i = 0; i < dep_nodes.size(); i++)
             {
-                set_cycle_gate(*gpit, dir);
-                DOUT("... set_cycle of " << (*gpit)->qasm() << " cycles " << (*gpit)->cycle);
+                ql::gate* gp = instruction[dep_nodes[i]];
+                if (i < asap_count)
+                {
+                    gp->cycle = asap_cycle[dep_nodes[i]];
+                }
+                else
+                {
+                    set_cycle_gate(gp, dir);
+                    asap_cycle[dep_nodes[i]] = gp->cycle;
+                }
+                DOUT("... set_cycle of " << gp->qasm() << " cycles " << gp->cycle);
             }
+            asap_count = dep_nodes.size();
             set_cycle_gate(instruction[t], dir);
             DOUT("... set_cycle of " << instruction[t]->qasm() << " cycles " << instruction[t]->cycle);
         }
         else
         {
             instruction[t]->cycle = ALAP_SINK_CYCLE;
-            // *circp is by definition in a topological order of the dependence graph
-            for ( ql::circuit::reverse_iterator gpit = circp->rbegin(); gpit != circp->rend(); gpit++)
+            // dep_nodes is in a topological order of the dependence graph
+            for (size_t i = dep_nodes.size(); i-- > 0; )
             {
-                set_cycle_gate(*gpit, dir);
+                set_cycle_gate(instruction[dep_nodes[i]], dir);
             }
             set_cycle_gate(instruction[s], dir);
 
@@ -2313,18 +2621,12 @@ private:
             // DOUT("Latency compensating instruction: " << id);
             long latency_cycles=0;
 
-            if(platform.instruction_settings.count(id) > 0)
+            if (get_latency_cycles(id, platform, latency_cycles))
             {
-                if(platform.instruction_settings[id].count("latency") > 0)
-                {
-                    float latency_ns = platform.instruction_settings[id]["latency"];
-                    latency_cycles = (std::ceil( static_cast<float>(std::abs(latency_ns)) / cycle_time)) *
-                                            ql::utils::sign_of(latency_ns);
-                    compensated_one = true;
+                compensated_one = true;
 
-                    gp->cycle = gp->cycle + latency_cycles;
-                    DOUT( "... compensated to @" << gp->cycle << " <- " << id << " with " << latency_cycles );
-                }
+                gp->cycle = gp->cycle + latency_cycles;
+                DOUT( "... compensated to @" << gp->cycle << " <- " << id << " with " << latency_cycles );
             }
         }
 
@@ -2346,6 +2648,22 @@ private:
         DOUT("Latency compensation [DONE]");
     }
 
+    // latency of instruction id in cycles, when it has one
+    bool get_latency_cycles(const std::string & id, const ql::quantum_platform & platform, long & latency_cycles)
+    {
+        if(platform.instruction_settings.count(id) > 0)
+        {
+            if(platform.instruction_settings[id].count("latency") > 0)
+            {
+                float latency_ns = platform.instruction_settings[id]["latency"];
+                latency_cycles = (std::ceil( static_cast<float>(std::abs(latency_ns)) / cycle_time)) *
+                                        ql::utils::sign_of(latency_ns);
+                return true;
+            }
+        }
+        return false;
+    }
+
     // insert buffer - buffer delays
     void insert_buffer_delays(ql::ir::bundles_t& bundles, const ql::quantum_platform& platform)
     {
@@ -2354,40 +2672,48 @@ private:
         size_t buffer_cycles_accum = 0;
         for(ql::ir::bundle_t & abundle : bundles)
         {
-            std::vector<std::string> operations_curr_bundle;
-            for( auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt )
+            insert_buffer_delay(abundle, platform, operations_prev_bundle, buffer_cycles_accum);
+        }
+        DOUT("Buffer-buffer delay insertion [DONE] ");
+    }
+
+    // delay abundle by the buffer cycles required after the operations of the previous bundle,
+    // accumulated with those of the earlier bundles in buffer_cycles_accum
+    void insert_buffer_delay(ql::ir::bundle_t & abundle, const ql::quantum_platform & platform,
+        std::vector<std::string> & operations_prev_bundle, size_t & buffer_cycles_accum)
+    {
+        std::vector<std::string> operations_curr_bundle;
+        for( auto secIt = abundle.parallel_sections.begin(); secIt != abundle.parallel_sections.end(); ++secIt )
+        {
+            for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
             {
-                for(auto insIt = secIt->begin(); insIt != secIt->end(); ++insIt )
+                auto & id = (*insIt)->name;
+                std::string op_type("none");
+                if(platform.instruction_settings.count(id) > 0)
                 {
-                    auto & id = (*insIt)->name;
-                    std::string op_type("none");
-                    if(platform.instruction_settings.count(id) > 0)
+                    if(platform.instruction_settings[id].count("type") > 0)
                     {
-                        if(platform.instruction_settings[id].count("type") > 0)
-                        {
-                            op_type = platform.instruction_settings[id]["type"];
-                        }
+                        op_type = platform.instruction_settings[id]["type"];
                     }
-                    operations_curr_bundle.push_back(op_type);
                 }
+                operations_curr_bundle.push_back(op_type);
             }
-
-            size_t buffer_cycles = 0;
-            for(auto & op_prev : operations_prev_bundle)
-            {
-                for(auto & op_curr : operations_curr_bundle)
-                {
-                    auto temp_buf_cycles = buffer_cycles_map[ std::pair<std::string,std::string>(op_prev, op_curr) ];
-                    DOUT("... considering buffer_" << op_prev << "_" << op_curr << ": " << temp_buf_cycles);
-                    buffer_cycles = std::max(temp_buf_cycles, buffer_cycles);
-                }
+        }
+
+        size_t buffer_cycles = 0;
+        for(auto & op_prev : operations_prev_bundle)
+        {
+            for(auto & op_curr : operations_curr_bundle)
+            {
+                auto temp_buf_cycles = buffer_cycles_map[ std::pair<std::string,std::string>(op_prev, op_curr) ];
+                DOUT("... considering buffer_" << op_prev << "_" << op_curr << ": " << temp_buf_cycles);
+                buffer_cycles = std::max(temp_buf_cycles, buffer_cycles);
             }
-            DOUT( "... inserting buffer : " << buffer_cycles);
-            buffer_cycles_accum += buffer_cycles;
-            abundle.start_cycle = abundle.start_cycle + buffer_cycles_accum;
-            operations_prev_bundle = operations_curr_bundle;
         }
-        DOUT("Buffer-buffer delay insertion [DONE] ");
+        DOUT( "... inserting buffer : " << buffer_cycles);
+        buffer_cycles_accum += buffer_cycles;
+        abundle.start_cycle = abundle.start_cycle + buffer_cycles_accum;
+        operations_prev_bundle = operations_curr_bundle;
     }
 
     // In critical-path scheduling, usually more-critical instructions are preferred;
@@ -2432,18 +2758,25 @@ private:
 
     void set_remaining(ql::scheduling_direction_t dir)
     {
+        if (remaining_count > 0 && remaining_dir == dir)
+        {
+            update_remaining(dir);
+            return;
+        }
         ql::gate*   gp;
         remaining.clear();
+        remaining_dir = dir;
+        remaining_count = dep_nodes.size();
         if (ql::forward_scheduling == dir)
         {
             // remaining until SINK (i.e. the SINK.cycle-ALAP value)
             remaining[t] = 0;
-            // *circp is by definition in a topological order of the dependence graph
-            for ( ql::circuit::reverse_iterator gpit = circp->rbegin(); gpit != circp->rend(); gpit++)
+            // dep_nodes is in a topological order of the dependence graph
+            for (size_t i = dep_nodes.size(); i-- > 0; )
             {
-                ql::gate*   gp2 = *gpit;
+                ql::gate*   gp2 = instruction[dep_nodes[i]];
                 set_remaining_gate(gp2, dir);
-                DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining[node[gp2]]);
+                DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining[dep_nodes[i]]);
             }
             gp = instruction[s];
             set_remaining_gate(gp, dir);
@@ -2453,12 +2786,12 @@ private:
         {
             // remaining until SOURCE (i.e. the ASAP value)
             remaining[s] = 0;
-            // *circp is by definition in a topological order of the dependence graph
-            for ( ql::circuit::iterator gpit = circp->begin(); gpit != circp->end(); gpit++)
+            // dep_nodes is in a topological order of the dependence graph
+            for (auto n : dep_nodes)
             {
-                ql::gate*   gp2 = *gpit;
+                ql::gate*   gp2 = instruction[n];
                 set_remaining_gate(gp2, dir);
-                DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining[node[gp2]]);
+                DOUT("... remaining at " << gp2->qasm() << " cycles " << remaining[n]);
             }
             gp = instruction[t];
             set_remaining_gate(gp, dir);
@@ -2466,6 +2799,53 @@ private:
         }
     }
 
+    // set_remaining for the nodes added to the dependence graph since the previous call;
+    // forward, the remaining values of the gates before them can grow, and are updated by propagating
+    // the changes backward from the gates that got new successors; backward, those values don't change
+    void update_remaining(ql::scheduling_direction_t dir)
+    {
+        DOUT("... updating remaining for " << dep_nodes.size() - remaining_count << " nodes");
+        if (ql::forward_scheduling == dir)
+        {
+            remaining[t] = 0;
+            for (size_t i = dep_nodes.size(); i-- > remaining_count; )
+            {
+                set_remaining_gate(instruction[dep_nodes[i]], dir);
+            }
+            std::vector<ListDigraph::Node> work;
+            for (size_t i = remaining_count; i < dep_nodes.size(); i++)
+            {
+                for( ListDigraph::InArcIt arc(graph,dep_nodes[i]); arc != INVALID; ++arc )
+                {
+                    work.push_back(graph.source(arc));
+                }
+            }
+            while (!work.empty())
+            {
+                ListDigraph::Node n = work.back();
+                work.pop_back();
+                size_t  oldRemain = remaining[n];
+                set_remaining_gate(instruction[n], dir);
+                if (remaining[n] != oldRemain)
+                {
+                    for( ListDigraph::InArcIt arc(graph,n); arc != INVALID; ++arc )
+                    {
+                        work.push_back(graph.source(arc));
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (size_t i = remaining_count; i < dep_nodes.size(); i++)
+            {
+                set_remaining_gate(instruction[dep_nodes[i]], dir);
+            }
+            set_remaining_gate(instruction[t], dir);
+        }
+        remaining_count = dep_nodes.size();
+    }
+
     // ASAP/ALAP list scheduling support code with RC
     // Uses an "available list" (avlist) as interface between dependence graph and scheduler
     // the avlist contains all nodes that wrt their dependences can be scheduled:
@@ -2652,7 +3032,7 @@ private:
     }
 
     // take node n out of avlist because it has been scheduled;
-    // reflect that the node has been scheduled in the scheduled vector;
+    // reflect that the node has been scheduled in the pending counts of its depending nodes;
     // having scheduled it means that its depending nodes might become available:
     // such a depending node becomes available when all its dependent nodes have been scheduled now
     //
@@ -2665,30 +3045,26 @@ private:
     //   a predecessor node which has a successor which hasn't been scheduled,
     //   will be checked here at least when that successor is scheduled
     //
+    // pending[n] is the number of arcs to n (from n when backward scheduling) from nodes not scheduled yet,
+    // so that this takes time linear in the number of arcs of n, also for nodes with many dependent nodes
+    //
     // update (through MakeAvailable) the cycle attribute of the nodes made available
     // because from then on that value is compared to the curr_cycle to check
     // whether a node has completed execution and thus is available for scheduling in curr_cycle
-    void TakeAvailable(ListDigraph::Node n, std::list<ListDigraph::Node>& avlist, ListDigraph::NodeMap<bool> & scheduled, ql::scheduling_direction_t dir)
+    void TakeAvailable(ListDigraph::Node n, std::list<ListDigraph::Node>& avlist, ListDigraph::NodeMap<size_t> & pending, ql::scheduling_direction_t dir)
     {
-        scheduled[n] = true;
         avlist.remove(n);
 
         if (ql::forward_scheduling == dir)
         {
+            for (ListDigraph::OutArcIt succArc(graph,n); succArc != INVALID; ++succArc)
+            {
+                pending[graph.target(succArc)]--;
+            }
             for (ListDigraph::OutArcIt succArc(graph,n); succArc != INVALID; ++succArc)
             {
                 ListDigraph::Node succNode = graph.target(succArc);
-                bool schedulable = true;
-                for (ListDigraph::InArcIt predArc(graph,succNode); predArc != INVALID; ++predArc)
-                {
-                    ListDigraph::Node predNode = graph.source(predArc);
-                    if (!scheduled[predNode])
-                    {
-                        schedulable = false;
-                        break;
-                    }
-                }
-                if (schedulable)
+                if (pending[succNode] == 0)
                 {
                     MakeAvailable(succNode, avlist, dir);
                 }
@@ -2696,20 +3072,14 @@ private:
         }
         else
         {
+            for (ListDigraph::InArcIt predArc(graph,n); predArc != INVALID; ++predArc)
+            {
+                pending[graph.source(predArc)]--;
+            }
             for (ListDigraph::InArcIt predArc(graph,n); predArc != INVALID; ++predArc)
             {
                 ListDigraph::Node predNode = graph.source(predArc);
-                bool schedulable = true;
-                for (ListDigraph::OutArcIt succArc(graph,predNode); succArc != INVALID; ++succArc)
-                {
-                    ListDigraph::Node succNode = graph.target(succArc);
-                    if (!scheduled[succNode])
-                    {
-                        schedulable = false;
-                        break;
-                    }
-                }
-                if (schedulable)
+                if (pending[predNode] == 0)
                 {
                     MakeAvailable(predNode, avlist, dir);
                 }
@@ -2877,8 +3247,8 @@ private:
     {
         DOUT("Scheduling " << (ql::forward_scheduling == dir?"ASAP":"ALAP") << " with RC ...");
 
-        // scheduled[n] :=: whether node n has been scheduled, init all false
-        ListDigraph::NodeMap<bool>      scheduled(graph);
+        // pending[n] :=: number of dependences of node n on nodes not scheduled yet, init all
+        ListDigraph::NodeMap<size_t>    pending(graph);
         // avlist :=: list of schedulable nodes, initially (see below) just s or t
         std::list<ListDigraph::Node>    avlist;
 
@@ -2887,7 +3257,7 @@ private:
         DOUT("... initialization");
         for (ListDigraph::NodeIt n(graph); n != INVALID; ++n)
         {
-            scheduled[n] = false;   // none were scheduled
+            pending[n] = (ql::forward_scheduling == dir ? countInArcs(graph, n) : countOutArcs(graph, n));
         }
         size_t  curr_cycle;         // current cycle for which instructions are sought
         init_available(avlist, dir, curr_cycle);     // first node (SOURCE/SINK) is made available and curr_cycle set
@@ -2928,7 +3298,7 @@ private:
                 operation_duration = std::ceil( static_cast<float>(gp->duration) / cycle_time);
                 rm.reserve(curr_cycle, gp, operation_name, operation_type, instruction_type, operation_duration);
             }
-            TakeAvailable(selected_node, avlist, scheduled, dir);   // update avlist/scheduled/cycle
+            TakeAvailable(selected_node, avlist, pending, dir);     // update avlist/pending/cycle
             // more nodes that could be scheduled in this cycle, will be found in an other round of the loop
         }
 
@@ -3114,8 +3484,18 @@ private:
                     {
                         for ( ListDigraph::OutArcIt arc(graph,pred_node); arc != INVALID; ++arc )
                         {
-                            ql::gate*   target_gp = instruction[graph.target(arc)];
+                            ListDigraph::Node   target_node = graph.target(arc);
+                            ql::gate*   target_gp = instruction[target_node];
                             size_t target_cycle = target_gp->cycle;
+                            if (target_node != t && target_gp->type() == ql::gate_type_t::__dummy_gate__)
+                            {
+                                // a GROUP takes no time and isn't moved; the gates depending on it are the real successors
+                                target_cycle = MAX_CYCLE;
+                                for ( ListDigraph::OutArcIt arc2(graph,target_node); arc2 != INVALID; ++arc2 )
+                                {
+                                    target_cycle = std::min(target_cycle, instruction[graph.target(arc2)]->cycle);
+                                }
+                            }
                             if(predgp_completion_cycle > target_cycle)
                             {
                                 forward_predgp = false;
@@ -3214,6 +3594,509 @@ private:
         return bundles;
     }
 
+// =========== streaming ASAP scheduler, with and without RC
+    // The schedulers above work on the dependence graph of the whole circuit as created by init,
+    // which for circuits of millions of gates takes far more memory than the circuit itself:
+    // a LEMON node with its qasm string for each gate, the maps between gates and nodes, and the arcs.
+    //
+    // The streaming scheduler below instead reads the circuit once from start to end into a window
+    // of at most window_size gates, and derives the dependences of each gate read from the same
+    // per qubit/creg frontier state as init (the last writer, and the readers and Ds after it).
+    // Dependences on gates in the window are kept as lists of successors;
+    // of gates that left the window, only the cycle in which they completed is kept in the frontier.
+    // It is a forward list scheduler like schedule_post179, filling the cycles one by one with
+    // gates of the window of which all dependences have completed (and for which, with RC, the resources
+    // are available), in circuit order; a gate leaves the window when it and all gates before it were scheduled.
+    // A bundle is complete when the current cycle has advanced past it (with RC: past it and
+    // the largest negative latency); it is then handed out and its gates are written back to the circuit,
+    // which, as with the other schedulers, ends up ordered on cycle value.
+    // So apart from the circuit and the bundles handed out, memory is O(window_size + qubits + cregs),
+    // and resource occupation before the current cycle is forgotten as well.
+    //
+    // Bound on optimality loss:
+    // a gate enters the window at the latest when all gates window_size or more places before it
+    // in the circuit have been scheduled, so it starts no later than the later of the cycle in which
+    // its dependences complete and the cycles of those gates.
+    // Without RC, that is the only difference with schedule_asap_post179: the schedules are equal when no
+    // gate can start before a gate that is window_size places before it in the circuit, which certainly holds when
+    // window_size is at least the number of gates in the circuit.
+    // With RC, moreover the gates in the window are considered in circuit order instead of on criticality,
+    // since the remaining cycles that criticality is based on require the dependence graph of the whole circuit.
+    //
+    // The dependences are those of init for post179, with RAR and DAD as selected by the scheduler_commute option.
+
+    // state of a gate in the window
+    struct window_gate_t
+    {
+        ql::gate*           gp;
+        size_t              ready;      // cycle in which its dependences on scheduled gates have completed
+        size_t              npreds;     // number of its dependences on gates not yet scheduled
+        std::vector<size_t> succs;      // window numbers of the gates depending on it
+        bool                scheduled;
+    };
+
+    // frontier state of a qubit/creg; gates are referred to by their window number, i.e. their index in the circuit
+    struct window_frontier_t
+    {
+        size_t              writer;         // last writer when in the window, window_none otherwise
+        size_t              writer_done;    // cycle in which last writer completed when it left the window
+        std::deque<size_t>  readers;        // readers after last writer that are in the window
+        size_t              readers_done;   // cycle in which the readers that left the window completed
+        std::deque<size_t>  ds;             // same for Ds
+        size_t              ds_done;
+        std::deque<size_t>  group;          // same for the group of Rs or Ds before, with commutation
+        size_t              group_done;
+    };
+
+    static const size_t window_none = size_t(-1);
+
+    size_t dep_weight(ql::gate* gp)
+    {
+        return std::ceil( static_cast<float>(gp->duration) / cycle_time);
+    }
+
+    // the events of gate ins on each qubit/creg it uses, as distinguished by init for post179
+    void get_events(ql::gate* ins, std::vector<std::pair<size_t,EventTypes>> & events)
+    {
+        events.clear();
+        std::vector<EventTypes> access;
+        if (get_operand_access(ins, access))
+        {
+            for (size_t operandNo = 0; operandNo < ins->operands.size(); operandNo++)
+            {
+                events.push_back(std::make_pair(ins->operands[operandNo], access[operandNo]));
+            }
+            for (auto operand : ins->creg_operands)
+            {
+                events.push_back(std::make_pair(qubit_count+operand, W_EVENT));
+            }
+        }
+        else if (ins->name == "measure")
+        {
+            for (auto operand : ins->operands)
+            {
+                events.push_back(std::make_pair(operand, W_EVENT));
+            }
+            for (auto operand : ((ql::measure*)ins)->creg_operands)
+            {
+                events.push_back(std::make_pair(qubit_count+operand, W_EVENT));
+            }
+        }
+        else if (ins->name == "display" || ins->type() == ql::gate_type_t::__classical_gate__)
+        {
+            for (size_t operand = 0; operand < qubit_count+creg_count; operand++)
+            {
+                events.push_back(std::make_pair(operand, W_EVENT));
+            }
+        }
+        else if (ins->name == "cnot")
+        {
+            for (size_t operandNo = 0; operandNo < ins->operands.size(); operandNo++)
+            {
+                events.push_back(std::make_pair(ins->operands[operandNo], operandNo == 0 ? R_EVENT : D_EVENT));
+            }
+        }
+        else if (ins->name == "cz" || ins->name == "cphase")
+        {
+            for (auto operand : ins->operands)
+            {
+                events.push_back(std::make_pair(operand, R_EVENT));
+            }
+        }
+        else
+        {
+            for (auto operand : ins->operands)
+            {
+                events.push_back(std::make_pair(operand, W_EVENT));
+            }
+        }
+    }
+
+    // make gate number n depend on gate number k in the window
+    void window_dep(std::deque<window_gate_t> & window, size_t base, size_t k, size_t n)
+    {
+        window_gate_t & src = window[k - base];
+        window_gate_t & tgt = window[n - base];
+        if (src.scheduled)
+        {
+            tgt.ready = std::max(tgt.ready, src.gp->cycle + dep_weight(src.gp));
+        }
+        else
+        {
+            src.succs.push_back(n);
+            tgt.npreds++;
+        }
+    }
+
+    // add gate gp as number n to the window, with its dependences, updating the frontier as init does
+    void window_add(ql::gate* gp, std::deque<window_gate_t> & window, size_t base, size_t n,
+        std::vector<window_frontier_t> & frontier, bool commute, std::set<size_t> & avset)
+    {
+        window.push_back(window_gate_t{gp, 0, 0, std::vector<size_t>(), false});
+        std::vector<std::pair<size_t,EventTypes>> events;
+        get_events(gp, events);
+        for (auto & ev : events)
+        {
+            window_frontier_t & f = frontier[ev.first];
+            size_t & ready = window.back().ready;
+            if (commute && ev.second != W_EVENT)
+            {
+                // the first R after Ds, or D after Rs, closes their group, as add_group_dep does;
+                // a group that has members, also outside the window, has a done cycle of at least 1
+                std::deque<size_t> & closing = (ev.second == R_EVENT ? f.ds : f.readers);
+                size_t & closing_done = (ev.second == R_EVENT ? f.ds_done : f.readers_done);
+                if (!closing.empty() || closing_done > 0)
+                {
+                    f.group.swap(closing);
+                    closing.clear();
+                    f.group_done = closing_done;
+                    closing_done = 0;
+                }
+                ready = std::max(ready, f.group_done);
+                for (auto k : f.group)
+                {
+                    window_dep(window, base, k, n);
+                }
+            }
+            if (f.writer == window_none)
+            {
+                ready = std::max(ready, f.writer_done);
+            }
+            else
+            {
+                window_dep(window, base, f.writer, n);
+            }
+            if (ev.second != R_EVENT || !commute)
+            {
+                ready = std::max(ready, f.readers_done);
+                for (auto k : f.readers)
+                {
+                    window_dep(window, base, k, n);
+                }
+            }
+            if (ev.second != D_EVENT || !commute)
+            {
+                ready = std::max(ready, f.ds_done);
+                for (auto k : f.ds)
+                {
+                    window_dep(window, base, k, n);
+                }
+            }
+        }
+        for (auto & ev : events)
+        {
+            window_frontier_t & f = frontier[ev.first];
+            if (ev.second == W_EVENT)
+            {
+                f.writer = n;
+                f.group.clear();
+                f.group_done = 0;
+            }
+            if (ev.second != R_EVENT)
+            {
+                f.readers.clear();
+                f.readers_done = 0;
+            }
+            else
+            {
+                f.readers.push_back(n);
+            }
+            if (ev.second != D_EVENT)
+            {
+                f.ds.clear();
+                f.ds_done = 0;
+            }
+            else
+            {
+                f.ds.push_back(n);
+            }
+        }
+        if (window.back().npreds == 0)
+        {
+            avset.insert(n);
+        }
+    }
+
+    // gate number n at the front of the window has been scheduled and leaves it;
+    // the frontier keeps of it only the cycle in which it completes
+    void window_remove(std::deque<window_gate_t> & window, size_t n, std::vector<window_frontier_t> & frontier)
+    {
+        ql::gate* gp = window.front().gp;
+        size_t done = gp->cycle + dep_weight(gp);
+        std::vector<std::pair<size_t,EventTypes>> events;
+        get_events(gp, events);
+        for (auto & ev : events)
+        {
+            window_frontier_t & f = frontier[ev.first];
+            if (f.writer == n)
+            {
+                f.writer = window_none;
+                f.writer_done = done;
+            }
+            // readers and Ds are in window order and leave in that order
+            if (!f.readers.empty() && f.readers.front() == n)
+            {
+                f.readers.pop_front();
+                f.readers_done = std::max(f.readers_done, done);
+            }
+            if (!f.ds.empty() && f.ds.front() == n)
+            {
+                f.ds.pop_front();
+                f.ds_done = std::max(f.ds_done, done);
+            }
+            if (!f.group.empty() && f.group.front() == n)
+            {
+                f.group.pop_front();
+                f.group_done = std::max(f.group_done, done);
+            }
+        }
+        window.pop_front();
+    }
+
+    // hand out the bundles of the gates in pending that start before cycle, as bundler would create them;
+    // their gates are written back to the circuit at nout
+    void window_flush(std::map<size_t, std::vector<std::pair<size_t,ql::gate*>>> & pending, size_t cycle,
+        size_t & nout, bool rc, const ql::quantum_platform & platform,
+        std::vector<std::string> & operations_prev_bundle, size_t & buffer_cycles_accum,
+        std::function<void(ql::ir::bundle_t &)> & emit)
+    {
+        while (!pending.empty() && pending.begin()->first < cycle)
+        {
+            auto & gates = pending.begin()->second;
+            // with latency compensation, gates of different scheduling cycles meet here;
+            // order them as sort_by_cycle would have done
+            std::stable_sort(gates.begin(), gates.end(),
+                [](const std::pair<size_t,ql::gate*> & g1, const std::pair<size_t,ql::gate*> & g2) { return g1.first < g2.first; });
+
+            ql::ir::bundle_t abundle;
+            abundle.start_cycle = pending.begin()->first;
+            abundle.duration_in_cycles = 0;
+            for (auto & g : gates)
+            {
+                ql::gate* gp = g.second;
+                (*circp)[nout++] = gp;
+                if ( gp->type() == ql::gate_type_t::__wait_gate__ ||
+                     gp->type() == ql::gate_type_t::__dummy_gate__
+                   )
+                {
+                    continue;
+                }
+                ql::ir::section_t asec;
+                asec.push_back(gp);
+                abundle.parallel_sections.push_back(asec);
+                abundle.duration_in_cycles = std::max(abundle.duration_in_cycles, (gp->duration+cycle_time-1)/cycle_time);
+            }
+            pending.erase(pending.begin());
+
+            if (!abundle.parallel_sections.empty())
+            {
+                if (rc)
+                {
+                    insert_buffer_delay(abundle, platform, operations_prev_bundle, buffer_cycles_accum);
+                }
+                DOUT(".. bundle at cycle " << abundle.start_cycle << " duration in cycles: " << abundle.duration_in_cycles);
+                emit(abundle);
+            }
+        }
+    }
+
+public:
+    // the value of the scheduler_window option: the number of gates in the window of the streaming scheduler,
+    // 0 when the dependence graph schedulers are to be used;
+    // the streaming scheduler only knows the post179 dependences, so without those the graph is used as well
+    static size_t get_window_size()
+    {
+        std::string s = ql::options::get("scheduler_window");
+        size_t window_size;
+        try
+        {
+            window_size = std::stoul(s);
+        }
+        catch (std::exception &e)
+        {
+            EOUT("invalid scheduler_window '" << s << "'");
+            throw ql::exception("[x] error : Scheduler : invalid scheduler_window '" + s + "' !",false);
+        }
+        if (window_size > 0 && ql::options::get("scheduler_post179") == "no")
+        {
+            WOUT("scheduler_window only applies with scheduler_post179; scheduling on the dependence graph");
+            return 0;
+        }
+        return window_size;
+    }
+
+    // streaming ASAP scheduler, with RC when rmp is not null, see above;
+    // sets the cycle attribute of the gates of ckt and reorders ckt on it, like the schedulers above,
+    // and hands out each bundle to emit as soon as it is complete;
+    // init should not be called, the dependence graph is not used
+    void schedule_asap_window(ql::circuit & ckt, const ql::quantum_platform & platform, size_t qcount, size_t ccount,
+        size_t window_size, ql::arch::resource_manager_t* rmp, std::function<void(ql::ir::bundle_t &)> emit)
+    {
+        DOUT("Scheduling ASAP" << (rmp ? " with RC" : "") << " in window of " << window_size << " gates ...");
+        qubit_count = qcount;
+        creg_count = ccount;
+        cycle_time = platform.cycle_time;
+        circp = &ckt;
+        bool rc = (rmp != nullptr);
+        bool commute = (ql::options::get("scheduler_commute") == "yes");
+        if (window_size == 0)
+        {
+            window_size = 1;
+        }
+
+        // the implicit SOURCE in cycle 0 wrote all qubits and cregs
+        ql::SOURCE source;
+        window_frontier_t f0{window_none, dep_weight(&source), std::deque<size_t>(), 0, std::deque<size_t>(), 0, std::deque<size_t>(), 0};
+        std::vector<window_frontier_t> frontier(qubit_count + creg_count, f0);
+
+        // the latencies by which gates are compensated, so the bundles that can still receive gates
+        std::map<std::string, long> latency;
+        long min_latency = 0;
+        if (rc)
+        {
+            init_buffer_cycles(platform);
+            for (auto it = platform.instruction_settings.begin(); it != platform.instruction_settings.end(); ++it)
+            {
+                long latency_cycles;
+                if (get_latency_cycles(it.key(), platform, latency_cycles))
+                {
+                    latency[it.key()] = latency_cycles;
+                    min_latency = std::min(min_latency, latency_cycles);
+                }
+            }
+        }
+
+        std::deque<window_gate_t> window;   // gates base .. base+window.size()-1 of ckt
+        size_t base = 0;
+        std::set<size_t> avset;             // gates in window that are not scheduled but all their predecessors are
+        std::map<size_t, std::vector<std::pair<size_t,ql::gate*>>> pending; // cycle -> gates (with scheduling cycle) of bundle
+        size_t nout = 0;                    // number of gates written back to ckt
+        std::vector<std::string> operations_prev_bundle;
+        size_t buffer_cycles_accum = 0;
+
+        size_t curr_cycle = 0;
+        while (true)
+        {
+            while (!window.empty() && window.front().scheduled)
+            {
+                window_remove(window, base, frontier);
+                base++;
+            }
+            while (window.size() < window_size && base + window.size() < ckt.size())
+            {
+                size_t n = base + window.size();
+                window_add(ckt[n], window, base, n, frontier, commute, avset);
+            }
+            if (window.empty())
+            {
+                break;
+            }
+
+            // schedule what can be scheduled in curr_cycle, in circuit order;
+            // successors that become available are after it, so are considered in the same scan
+            bool    selected = false;
+            bool    waiting_for_resource = false;
+            size_t  min_ready = MAX_CYCLE;
+            for (auto it = avset.begin(); it != avset.end(); )
+            {
+                window_gate_t & wg = window[*it - base];
+                ql::gate* gp = wg.gp;
+                if (wg.ready > curr_cycle)
+                {
+                    min_ready = std::min(min_ready, wg.ready);
+                    ++it;
+                    continue;
+                }
+                bool uses_resources = rc
+                    && gp->type() != ql::gate_type_t::__dummy_gate__
+                    && gp->type() != ql::gate_type_t::__classical_gate__
+                    && gp->type() != ql::gate_type_t::__wait_gate__;
+                std::string operation_name;
+                std::string operation_type;
+                std::string instruction_type;
+                size_t      operation_duration = std::ceil( static_cast<float>(gp->duration) / cycle_time);
+                if (uses_resources)
+                {
+                    GetGateParameters(gp->name, platform, operation_name, operation_type, instruction_type);
+                    if (!rmp->available(curr_cycle, gp, operation_name, operation_type, instruction_type, operation_duration))
+                    {
+                        waiting_for_resource = true;
+                        ++it;
+                        continue;
+                    }
+                    rmp->reserve(curr_cycle, gp, operation_name, operation_type, instruction_type, operation_duration);
+                }
+
+                DOUT("... selected " << gp->qasm() << " in cycle " << curr_cycle);
+                gp->cycle = curr_cycle;
+                wg.scheduled = true;
+                selected = true;
+                for (auto succ : wg.succs)
+                {
+                    window_gate_t & ws = window[succ - base];
+                    ws.ready = std::max(ws.ready, curr_cycle + dep_weight(gp));
+                    if (--ws.npreds == 0)
+                    {
+                        avset.insert(succ);
+                    }
+                }
+                wg.succs.clear();
+                if (rc && latency.count(gp->name))
+                {
+                    gp->cycle = gp->cycle + latency[gp->name];
+                }
+                pending[gp->cycle].push_back(std::make_pair(curr_cycle, gp));
+                it = avset.erase(it);
+            }
+            if (selected)
+            {
+                // refill the window and try again
+                continue;
+            }
+
+            // nothing more in this cycle; when none was waiting for a resource, skip to the first one ready
+            if (!waiting_for_resource && min_ready != MAX_CYCLE)
+            {
+                curr_cycle = min_ready;
+            }
+            else
+            {
+                curr_cycle++;
+            }
+            // gates yet to be scheduled will be in cycles from curr_cycle+min_latency on
+            if (long(curr_cycle) + min_latency > 0)
+            {
+                window_flush(pending, curr_cycle + min_latency, nout, rc, platform,
+                    operations_prev_bundle, buffer_cycles_accum, emit);
+            }
+            if (rc)
+            {
+                rmp->forget(curr_cycle);
+            }
+        }
+        window_flush(pending, size_t(-1), nout, rc, platform, operations_prev_bundle, buffer_cycles_accum, emit);
+
+        DOUT("Scheduling ASAP in window [DONE]");
+    }
+
+    ql::ir::bundles_t schedule_asap_window(ql::circuit & ckt, const ql::quantum_platform & platform,
+        size_t qcount, size_t ccount, size_t window_size)
+    {
+        ql::ir::bundles_t bundles;
+        schedule_asap_window(ckt, platform, qcount, ccount, window_size, nullptr,
+            [&bundles](ql::ir::bundle_t & abundle) { bundles.push_back(abundle); });
+        return bundles;
+    }
+
+    ql::ir::bundles_t schedule_asap_window(ql::circuit & ckt, const ql::quantum_platform & platform,
+        size_t qcount, size_t ccount, size_t window_size, ql::arch::resource_manager_t & rm)
+    {
+        ql::ir::bundles_t bundles;
+        schedule_asap_window(ckt, platform, qcount, ccount, window_size, &rm,
+            [&bundles](ql::ir::bundle_t & abundle) { bundles.push_back(abundle); });
+        return bundles;
+    }
+
 public:
 
 // =========== scheduling entry points switching out to pre179 or post179
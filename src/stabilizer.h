@@ -0,0 +1,391 @@
+/**
+ * @file   stabilizer.h
+ * @date   10/2018
+ * @brief  stabilizer tableau simulation of Clifford circuits
+ */
+
+#ifndef QL_STABILIZER_H
+#define QL_STABILIZER_H
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+#include <cmath>
+
+#include <utils.h>
+#include <exception.h>
+#include <gate.h>
+#include <statevector.h>
+
+namespace ql
+{
+
+/**
+ * stabilizer state of n qubits in the tableau form of Aaronson and
+ * Gottesman (CHP): rows 0..n-1 hold the destabilizers, rows n..2n-1 the
+ * stabilizers and row 2n is scratch space for deterministic measurements
+ *
+ * the x and z bits of a row are packed in 64-bit words, so that the
+ * products of rows in a measurement are word-level xors; a gate touches
+ * one word of every row
+ */
+class stabilizer_state
+{
+private:
+    typedef uint64_t word_t;
+
+    size_t nqubits;
+    size_t nwords;                  // words per row
+    size_t nrows;
+    std::vector<word_t> x;          // nrows * nwords
+    std::vector<word_t> z;
+    std::vector<uint8_t> r;         // sign of each row, 1 for -
+    std::mt19937_64 rng;
+
+public:
+    std::vector<int> outcomes;      // last measurement outcome per qubit, -1 when not measured
+
+public:
+    stabilizer_state(size_t nqubits, unsigned long seed=42) : nqubits(nqubits), rng(seed)
+    {
+        nwords = (nqubits + 63) / 64;
+        nrows = 2 * nqubits + 1;
+        reset();
+    }
+
+    size_t qubit_count() const
+    {
+        return nqubits;
+    }
+
+    void seed(unsigned long s)
+    {
+        rng.seed(s);
+    }
+
+    /**
+     * set all qubits to |0>
+     */
+    void reset()
+    {
+        x.assign(nrows * nwords, 0);
+        z.assign(nrows * nwords, 0);
+        r.assign(nrows, 0);
+        for (size_t q = 0; q < nqubits; q++)
+        {
+            x[q * nwords + q / 64] |= bit(q);
+            z[(q + nqubits) * nwords + q / 64] |= bit(q);
+        }
+        outcomes.assign(nqubits, -1);
+    }
+
+    /**
+     * apply gate g, which must be a Clifford gate; the operation is taken
+     * from its name as in state_vector::apply, rotations must be over a
+     * multiple of pi/2
+     */
+    void apply(ql::gate & g)
+    {
+        if (state_vector::is_idle(g))
+        {
+            return;
+        }
+        std::string name = state_vector::base_name(g);
+        auto & ops = g.operands;
+        for (auto q : ops)
+        {
+            if (q >= nqubits)
+            {
+                EOUT("operand " << q << " of gate '" << g.name << "' exceeds the " << nqubits << " simulated qubits");
+                throw ql::exception("[x] error : ql::stabilizer_state::apply : operand of gate '" + g.name + "' out of range !",false);
+            }
+        }
+
+        if (state_vector::is_measurement(g))
+        {
+            for (auto q : ops)
+                outcomes[q] = measure(q);
+        }
+        else if (state_vector::is_reset(g))
+        {
+            for (auto q : ops)
+                prepz(q);
+        }
+        else if (ops.size() == 1)
+        {
+            size_t q = ops[0];
+            if (name == "x" || name == "x180" || name == "rx180")
+                apply_x(q);
+            else if (name == "y" || name == "y180" || name == "ry180")
+                apply_y(q);
+            else if (name == "z")
+                apply_z(q);
+            else if (name == "h" || name == "hadamard")
+                apply_h(q);
+            else if (name == "s")
+                apply_s(q);
+            else if (name == "sdag")
+                apply_rz(q, 3);
+            else if (name == "x90" || name == "rx90")
+                apply_rx(q, 1);
+            else if (name == "mx90" || name == "xm90" || name == "rxm90")
+                apply_rx(q, 3);
+            else if (name == "y90" || name == "ry90")
+                apply_ry(q, 1);
+            else if (name == "my90" || name == "ym90" || name == "rym90")
+                apply_ry(q, 3);
+            else if (name == "rx")
+                apply_rx(q, quarter_turns(g));
+            else if (name == "ry")
+                apply_ry(q, quarter_turns(g));
+            else if (name == "rz")
+                apply_rz(q, quarter_turns(g));
+            else
+                not_clifford(g);
+        }
+        else if (ops.size() == 2 && (name == "cz" || name == "cphase"))
+            apply_cz(ops[0], ops[1]);
+        else if (ops.size() == 2 && name == "cnot")
+            apply_cnot(ops[0], ops[1]);
+        else if (ops.size() == 2 && name == "swap")
+        {
+            apply_cnot(ops[0], ops[1]);
+            apply_cnot(ops[1], ops[0]);
+            apply_cnot(ops[0], ops[1]);
+        }
+        else
+            not_clifford(g);
+    }
+
+    void apply_h(size_t q)
+    {
+        size_t w = q / 64;
+        word_t m = bit(q);
+        for (size_t i = 0; i < nrows; i++)
+        {
+            word_t & xi = x[i * nwords + w];
+            word_t & zi = z[i * nwords + w];
+            r[i] ^= ((xi & zi & m) != 0);
+            word_t t = (xi ^ zi) & m;
+            xi ^= t;
+            zi ^= t;
+        }
+    }
+
+    void apply_s(size_t q)
+    {
+        size_t w = q / 64;
+        word_t m = bit(q);
+        for (size_t i = 0; i < nrows; i++)
+        {
+            word_t xi = x[i * nwords + w];
+            word_t & zi = z[i * nwords + w];
+            r[i] ^= ((xi & zi & m) != 0);
+            zi ^= (xi & m);
+        }
+    }
+
+    void apply_x(size_t q)
+    {
+        flip_signs(z, q);
+    }
+
+    void apply_z(size_t q)
+    {
+        flip_signs(x, q);
+    }
+
+    void apply_y(size_t q)
+    {
+        size_t w = q / 64;
+        word_t m = bit(q);
+        for (size_t i = 0; i < nrows; i++)
+            r[i] ^= (((x[i * nwords + w] ^ z[i * nwords + w]) & m) != 0);
+    }
+
+    /**
+     * rotations over k quarter turns, up to a global phase
+     */
+    void apply_rz(size_t q, int k)
+    {
+        k &= 3;
+        if (k == 2)
+            apply_z(q);
+        else if (k != 0)
+        {
+            apply_s(q);
+            if (k == 3)
+                apply_z(q);
+        }
+    }
+
+    void apply_rx(size_t q, int k)
+    {
+        apply_h(q);
+        apply_rz(q, k);
+        apply_h(q);
+    }
+
+    void apply_ry(size_t q, int k)
+    {
+        // ry(pi/2) = h.z
+        for (int i = 0; i < (k & 3); i++)
+        {
+            apply_z(q);
+            apply_h(q);
+        }
+    }
+
+    void apply_cnot(size_t control, size_t target)
+    {
+        if (control == target)
+        {
+            throw ql::exception("[x] error : ql::stabilizer_state : gate operands must be distinct qubits !",false);
+        }
+        size_t wc = control / 64, wt = target / 64;
+        size_t sc = control % 64, st = target % 64;
+        for (size_t i = 0; i < nrows; i++)
+        {
+            word_t * xi = &x[i * nwords];
+            word_t * zi = &z[i * nwords];
+            word_t xc = (xi[wc] >> sc) & 1, zc = (zi[wc] >> sc) & 1;
+            word_t xt = (xi[wt] >> st) & 1, zt = (zi[wt] >> st) & 1;
+            r[i] ^= (xc & zt & (xt ^ zc ^ 1));
+            xi[wt] ^= (xc << st);
+            zi[wc] ^= (zt << sc);
+        }
+    }
+
+    void apply_cz(size_t q0, size_t q1)
+    {
+        apply_h(q1);
+        apply_cnot(q0, q1);
+        apply_h(q1);
+    }
+
+    /**
+     * measure qubit q in the z basis, collapsing the state, and return the outcome
+     */
+    int measure(size_t q)
+    {
+        size_t w = q / 64;
+        word_t m = bit(q);
+        size_t p = nqubits;
+        while (p < 2 * nqubits && !(x[p * nwords + w] & m))
+            p++;
+
+        if (p < 2 * nqubits)
+        {
+            // random outcome: p anticommutes with z on q
+            for (size_t i = 0; i < 2 * nqubits; i++)
+            {
+                if (i != p && (x[i * nwords + w] & m))
+                    rowsum(i, p);
+            }
+            copy_row(p - nqubits, p);
+            std::fill(&x[p * nwords], &x[(p + 1) * nwords], 0);
+            std::fill(&z[p * nwords], &z[(p + 1) * nwords], 0);
+            z[p * nwords + w] = m;
+            r[p] = (rng() >> 63);
+            return r[p];
+        }
+
+        // deterministic outcome: the product of the stabilizers whose
+        // destabilizers anticommute with z on q
+        size_t s = 2 * nqubits;
+        std::fill(&x[s * nwords], &x[(s + 1) * nwords], 0);
+        std::fill(&z[s * nwords], &z[(s + 1) * nwords], 0);
+        r[s] = 0;
+        for (size_t i = 0; i < nqubits; i++)
+        {
+            if (x[i * nwords + w] & m)
+                rowsum(s, i + nqubits);
+        }
+        return r[s];
+    }
+
+    /**
+     * measure qubit q and flip it to |0> when the outcome is 1
+     */
+    void prepz(size_t q)
+    {
+        if (measure(q))
+            apply_x(q);
+    }
+
+private:
+    static word_t bit(size_t q)
+    {
+        return word_t(1) << (q % 64);
+    }
+
+    static int popcount(word_t w)
+    {
+        return __builtin_popcountll(w);
+    }
+
+    void not_clifford(ql::gate & g)
+    {
+        EOUT("gate '" << g.name << "' is not a Clifford gate supported by the stabilizer simulator");
+        throw ql::exception("[x] error : ql::stabilizer_state::apply : gate '" + g.name + "' is not supported !",false);
+    }
+
+    /**
+     * the angle of a rotation in quarter turns, which must be integral
+     */
+    int quarter_turns(ql::gate & g)
+    {
+        double k = g.angle / (M_PI / 2);
+        double rk = std::round(k);
+        if (std::fabs(k - rk) > 1e-9)
+            not_clifford(g);
+        return int(((long long)rk % 4 + 4) % 4);
+    }
+
+    /**
+     * flip the sign of the rows that have bit q set in bits
+     */
+    void flip_signs(const std::vector<word_t> & bits, size_t q)
+    {
+        size_t w = q / 64;
+        word_t m = bit(q);
+        for (size_t i = 0; i < nrows; i++)
+            r[i] ^= ((bits[i * nwords + w] & m) != 0);
+    }
+
+    void copy_row(size_t to, size_t from)
+    {
+        std::copy(&x[from * nwords], &x[(from + 1) * nwords], &x[to * nwords]);
+        std::copy(&z[from * nwords], &z[(from + 1) * nwords], &z[to * nwords]);
+        r[to] = r[from];
+    }
+
+    /**
+     * row h becomes the product of rows i and h; the phase of the product
+     * is counted 64 qubits at a time, as the number of qubits contributing
+     * a factor i minus those contributing -i
+     */
+    void rowsum(size_t h, size_t i)
+    {
+        word_t * xh = &x[h * nwords];
+        word_t * zh = &z[h * nwords];
+        const word_t * xi = &x[i * nwords];
+        const word_t * zi = &z[i * nwords];
+        long phase = 2 * r[h] + 2 * r[i];
+        for (size_t w = 0; w < nwords; w++)
+        {
+            word_t x1 = xi[w], z1 = zi[w], x2 = xh[w], z2 = zh[w];
+            word_t plus  = (x1 & z1 & z2 & ~x2) | (x1 & ~z1 & z2 & x2) | (~x1 & z1 & x2 & ~z2);
+            word_t minus = (x1 & z1 & x2 & ~z2) | (x1 & ~z1 & z2 & ~x2) | (~x1 & z1 & x2 & z2);
+            phase += popcount(plus) - popcount(minus);
+            xh[w] = x2 ^ x1;
+            zh[w] = z2 ^ z1;
+        }
+        r[h] = (((phase % 4) + 4) % 4 == 2);
+    }
+};
+
+} // namespace ql
+
+#endif // QL_STABILIZER_H
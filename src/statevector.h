@@ -0,0 +1,610 @@
+/**
+ * @file   statevector.h
+ * @date   10/2018
+ * @brief  state-vector simulation of circuits
+ */
+
+#ifndef QL_STATEVECTOR_H
+#define QL_STATEVECTOR_H
+
+#include <vector>
+#include <string>
+#include <complex>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+
+#include <utils.h>
+#include <exception.h>
+#include <gate.h>
+
+// the restrict qualifier for the gate kernels, for the compilers that have one
+#if defined(__GNUC__) || defined(__clang__)
+#define QL_RESTRICT __restrict__
+#elif defined(_MSC_VER)
+#define QL_RESTRICT __restrict
+#else
+#define QL_RESTRICT
+#endif
+
+namespace ql
+{
+
+/**
+ * state vector of n qubits, qubit q being bit q of the amplitude index
+ *
+ * amplitudes are stored as separate arrays of real and imaginary parts so
+ * that the inner loops of the gate kernels are contiguous and vectorize;
+ * states of at least min_parallel amplitudes are split over threads
+ */
+class state_vector
+{
+public:
+    static const size_t max_qubits = 32;
+    static const size_t min_parallel = (1 << 14);
+
+private:
+    size_t nqubits;
+    size_t size;
+    std::vector<double> re;
+    std::vector<double> im;
+    size_t nthreads;
+    std::mt19937_64 rng;
+
+public:
+    std::vector<int> outcomes;    // last measurement outcome per qubit, -1 when not measured
+
+    state_vector(size_t nqubits, unsigned long seed=42) : nqubits(nqubits), rng(seed)
+    {
+        if (nqubits > max_qubits)
+        {
+            EOUT("cannot simulate " << nqubits << " qubits, at most " << max_qubits << " are supported");
+            throw ql::exception("[x] error : ql::state_vector : cannot simulate " + std::to_string(nqubits) + " qubits !",false);
+        }
+        size = (size_t(1) << nqubits);
+        re.assign(size, 0.0);
+        im.assign(size, 0.0);
+        re[0] = 1.0;
+        outcomes.assign(nqubits, -1);
+        nthreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    size_t qubit_count() const
+    {
+        return nqubits;
+    }
+
+    void seed(unsigned long s)
+    {
+        rng.seed(s);
+    }
+
+    /**
+     * set all qubits to |0>
+     */
+    void reset()
+    {
+        std::fill(re.begin(), re.end(), 0.0);
+        std::fill(im.begin(), im.end(), 0.0);
+        re[0] = 1.0;
+        std::fill(outcomes.begin(), outcomes.end(), -1);
+    }
+
+    std::complex<double> amplitude(size_t i) const
+    {
+        return std::complex<double>(re[i], im[i]);
+    }
+
+    /**
+     * set the state to computational basis state i
+     */
+    void set_basis_state(size_t i)
+    {
+        std::fill(re.begin(), re.end(), 0.0);
+        std::fill(im.begin(), im.end(), 0.0);
+        re[i] = 1.0;
+    }
+
+    /**
+     * set the state to a random state, uniformly distributed over the unit sphere
+     */
+    void set_random_state()
+    {
+        std::normal_distribution<double> normal(0.0, 1.0);
+        double norm = 0.0;
+        for (size_t i = 0; i < size; i++)
+        {
+            re[i] = normal(rng);
+            im[i] = normal(rng);
+            norm += re[i]*re[i] + im[i]*im[i];
+        }
+        norm = 1.0 / std::sqrt(norm);
+        for (size_t i = 0; i < size; i++)
+        {
+            re[i] *= norm;
+            im[i] *= norm;
+        }
+    }
+
+    /**
+     * inner product <this|other> of states of the same number of qubits
+     */
+    std::complex<double> inner_product(const state_vector & other) const
+    {
+        double pr = 0.0, pi = 0.0;
+        for (size_t i = 0; i < size; i++)
+        {
+            pr += re[i]*other.re[i] + im[i]*other.im[i];
+            pi += re[i]*other.im[i] - im[i]*other.re[i];
+        }
+        return std::complex<double>(pr, pi);
+    }
+
+    /**
+     * name of gate g in lower case, without the operands that follow the
+     * name of a specialized custom gate
+     */
+    static std::string base_name(ql::gate & g)
+    {
+        std::string name = g.name.substr(0, g.name.find(' '));
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        return name;
+    }
+
+    /**
+     * gates that leave the state unchanged: waits, barriers, identities,
+     * classical and display instructions and the flux pulses (sqf) that
+     * park qubits next to a two-qubit gate
+     */
+    static bool is_idle(ql::gate & g)
+    {
+        auto type = g.type();
+        std::string name = base_name(g);
+        return (type == __wait_gate__ || type == __classical_gate__ || type == __display__ || type == __display_binary__ ||
+                type == __nop_gate__ || name == "i" || name == "identity" || name == "wait" || name == "barrier" ||
+                name == "nop" || name == "display" || name == "sqf");
+    }
+
+    static bool is_measurement(ql::gate & g)
+    {
+        std::string name = base_name(g);
+        return (g.type() == __measure_gate__ || name == "measure" || name == "measz" || name == "measure_z");
+    }
+
+    static bool is_reset(ql::gate & g)
+    {
+        std::string name = base_name(g);
+        return (g.type() == __prepz_gate__ || name == "prepz" || name == "prep_z");
+    }
+
+    /**
+     * apply gate g: the operation is taken from its base_name;
+     * single-qubit gates of any other name are applied through their matrix.
+     * The outcome of a measurement of qubit q is kept in outcomes[q]
+     */
+    void apply(ql::gate & g)
+    {
+        apply(g, g.operands);
+    }
+
+    /**
+     * apply gate g to the qubits ops instead of its own operands
+     */
+    void apply(ql::gate & g, const std::vector<size_t> & ops)
+    {
+        if (is_idle(g))
+        {
+            return;
+        }
+        std::string name = base_name(g);
+        for (auto q : ops)
+        {
+            if (q >= nqubits)
+            {
+                EOUT("operand " << q << " of gate '" << g.name << "' exceeds the " << nqubits << " simulated qubits");
+                throw ql::exception("[x] error : ql::state_vector::apply : operand of gate '" + g.name + "' out of range !",false);
+            }
+        }
+
+        const double h = 0.7071067811865475244;
+        const double pi = M_PI;
+        if (is_measurement(g))
+        {
+            for (auto q : ops)
+                outcomes[q] = measure(q);
+        }
+        else if (is_reset(g))
+        {
+            for (auto q : ops)
+                prepz(q);
+        }
+        else if (ops.size() == 1)
+        {
+            size_t q = ops[0];
+            if (name == "x" || name == "x180" || name == "rx180")
+                apply_matrix(q, {0,0, 1,0, 1,0, 0,0});
+            else if (name == "y" || name == "y180" || name == "ry180")
+                apply_matrix(q, {0,0, 0,-1, 0,1, 0,0});
+            else if (name == "z")
+                apply_phase(q, pi);
+            else if (name == "h" || name == "hadamard")
+                apply_matrix(q, {h,0, h,0, h,0, -h,0});
+            else if (name == "s")
+                apply_phase(q, pi/2);
+            else if (name == "sdag")
+                apply_phase(q, -pi/2);
+            else if (name == "t")
+                apply_phase(q, pi/4);
+            else if (name == "tdag")
+                apply_phase(q, -pi/4);
+            else if (name == "x90" || name == "rx90")
+                apply_rx(q, pi/2);
+            else if (name == "mx90" || name == "xm90" || name == "rxm90")
+                apply_rx(q, -pi/2);
+            else if (name == "x45")
+                apply_rx(q, pi/4);
+            else if (name == "xm45")
+                apply_rx(q, -pi/4);
+            else if (name == "y90" || name == "ry90")
+                apply_ry(q, pi/2);
+            else if (name == "my90" || name == "ym90" || name == "rym90")
+                apply_ry(q, -pi/2);
+            else if (name == "rx")
+                apply_rx(q, g.angle);
+            else if (name == "ry")
+                apply_ry(q, g.angle);
+            else if (name == "rz")
+                apply_rz(q, g.angle);
+            else
+            {
+                DOUT("applying gate '" << g.name << "' through its matrix");
+                cmat_t m = g.mat();
+                apply_matrix(q, { m.m[0].real(), m.m[0].imag(), m.m[1].real(), m.m[1].imag(),
+                                  m.m[2].real(), m.m[2].imag(), m.m[3].real(), m.m[3].imag() });
+            }
+        }
+        else if (ops.size() == 2 && (name == "cz" || name == "cphase"))
+            apply_cz(ops[0], ops[1]);
+        else if (ops.size() == 2 && name == "cnot")
+            apply_cnot(ops[0], ops[1]);
+        else if (ops.size() == 2 && name == "swap")
+            apply_swap(ops[0], ops[1]);
+        else if (ops.size() == 3 && name == "toffoli")
+            apply_toffoli(ops[0], ops[1], ops[2]);
+        else
+        {
+            EOUT("gate '" << g.name << "' is not supported by the state-vector simulator");
+            throw ql::exception("[x] error : ql::state_vector::apply : gate '" + g.name + "' is not supported !",false);
+        }
+    }
+
+    /**
+     * apply the 2x2 matrix m, given as real and imaginary parts in row-major
+     * order, to qubit q
+     */
+    void apply_matrix(size_t q, std::vector<double> m)
+    {
+        size_t stride = (size_t(1) << q);
+        const double * mm = m.data();
+        for_each_pair(q, [this, stride, mm](size_t i0, size_t len)
+        {
+            rotate(&re[i0], &im[i0], &re[i0+stride], &im[i0+stride], len, mm);
+        });
+    }
+
+    /**
+     * multiply the amplitudes in which qubit q is 1 by exp(i*phi)
+     */
+    void apply_phase(size_t q, double phi)
+    {
+        size_t stride = (size_t(1) << q);
+        double c = std::cos(phi), s = std::sin(phi);
+        for_each_pair(q, [this, stride, c, s](size_t i0, size_t len)
+        {
+            phase(&re[i0+stride], &im[i0+stride], len, c, s);
+        });
+    }
+
+    void apply_rx(size_t q, double theta)
+    {
+        double c = std::cos(theta/2), s = std::sin(theta/2);
+        apply_matrix(q, {c,0, 0,-s, 0,-s, c,0});
+    }
+
+    void apply_ry(size_t q, double theta)
+    {
+        double c = std::cos(theta/2), s = std::sin(theta/2);
+        apply_matrix(q, {c,0, -s,0, s,0, c,0});
+    }
+
+    void apply_rz(size_t q, double theta)
+    {
+        double c = std::cos(theta/2), s = std::sin(theta/2);
+        apply_matrix(q, {c,-s, 0,0, 0,0, c,s});
+    }
+
+    void apply_cz(size_t q0, size_t q1)
+    {
+        std::vector<size_t> bits = sorted_bits({q0, q1});
+        size_t mask = (size_t(1) << q0) | (size_t(1) << q1);
+        parallel_for(size >> 2, [&](size_t lo, size_t hi)
+        {
+            for (size_t k = lo; k < hi; k++)
+            {
+                size_t i = insert_zeros(k, bits) | mask;
+                re[i] = -re[i];
+                im[i] = -im[i];
+            }
+        });
+    }
+
+    void apply_cnot(size_t control, size_t target)
+    {
+        std::vector<size_t> bits = sorted_bits({control, target});
+        size_t c = (size_t(1) << control), t = (size_t(1) << target);
+        parallel_for(size >> 2, [&](size_t lo, size_t hi)
+        {
+            for (size_t k = lo; k < hi; k++)
+            {
+                size_t i = insert_zeros(k, bits) | c;
+                std::swap(re[i], re[i|t]);
+                std::swap(im[i], im[i|t]);
+            }
+        });
+    }
+
+    void apply_swap(size_t q0, size_t q1)
+    {
+        std::vector<size_t> bits = sorted_bits({q0, q1});
+        size_t b0 = (size_t(1) << q0), b1 = (size_t(1) << q1);
+        parallel_for(size >> 2, [&](size_t lo, size_t hi)
+        {
+            for (size_t k = lo; k < hi; k++)
+            {
+                size_t i = insert_zeros(k, bits);
+                std::swap(re[i|b0], re[i|b1]);
+                std::swap(im[i|b0], im[i|b1]);
+            }
+        });
+    }
+
+    void apply_toffoli(size_t control0, size_t control1, size_t target)
+    {
+        std::vector<size_t> bits = sorted_bits({control0, control1, target});
+        size_t c = (size_t(1) << control0) | (size_t(1) << control1), t = (size_t(1) << target);
+        parallel_for(size >> 3, [&](size_t lo, size_t hi)
+        {
+            for (size_t k = lo; k < hi; k++)
+            {
+                size_t i = insert_zeros(k, bits) | c;
+                std::swap(re[i], re[i|t]);
+                std::swap(im[i], im[i|t]);
+            }
+        });
+    }
+
+    /**
+     * probability of measuring 1 on qubit q
+     */
+    double probability(size_t q)
+    {
+        size_t stride = (size_t(1) << q);
+        double p = parallel_sum(size >> 1, [&](size_t lo, size_t hi)
+        {
+            double p = 0.0;
+            for_each_run(q, lo, hi, [&](size_t i0, size_t len)
+            {
+                const double * r = &re[i0+stride];
+                const double * m = &im[i0+stride];
+                for (size_t i = 0; i < len; i++)
+                    p += r[i]*r[i] + m[i]*m[i];
+            });
+            return p;
+        });
+        return std::min(1.0, p);
+    }
+
+    /**
+     * measure qubit q in the z basis, collapsing the state, and return the outcome
+     */
+    int measure(size_t q)
+    {
+        double p1 = probability(q);
+        int outcome = (std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p1 ? 1 : 0);
+        double norm = 1.0 / std::sqrt(outcome ? p1 : 1.0 - p1);
+        size_t stride = (size_t(1) << q);
+        for_each_pair(q, [this, stride, outcome, norm](size_t i0, size_t len)
+        {
+            size_t keep = (outcome ? i0 + stride : i0);
+            size_t drop = (outcome ? i0 : i0 + stride);
+            std::fill(&re[drop], &re[drop] + len, 0.0);
+            std::fill(&im[drop], &im[drop] + len, 0.0);
+            double * r = &re[keep];
+            double * m = &im[keep];
+            for (size_t i = 0; i < len; i++)
+            {
+                r[i] *= norm;
+                m[i] *= norm;
+            }
+        });
+        return outcome;
+    }
+
+    /**
+     * measure qubit q and flip it to |0> when the outcome is 1
+     */
+    void prepz(size_t q)
+    {
+        if (measure(q))
+            apply_matrix(q, {0,0, 1,0, 1,0, 0,0});
+    }
+
+    /**
+     * draw shots samples of the computational basis state without collapsing
+     * the state, returned as amplitude indices in ascending order
+     */
+    std::vector<size_t> sample(size_t shots)
+    {
+        std::vector<double> r(shots);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (auto & x : r)
+            x = uniform(rng);
+        std::sort(r.begin(), r.end());
+
+        std::vector<size_t> samples;
+        samples.reserve(shots);
+        double cumulative = 0.0;
+        size_t last = 0;
+        for (size_t i = 0; i < size && samples.size() < shots; i++)
+        {
+            double p = re[i]*re[i] + im[i]*im[i];
+            if (p == 0.0)
+                continue;
+            cumulative += p;
+            last = i;
+            while (samples.size() < shots && r[samples.size()] < cumulative)
+                samples.push_back(i);
+        }
+        // rounding may leave the sum of probabilities just below 1
+        while (samples.size() < shots)
+            samples.push_back(last);
+        return samples;
+    }
+
+private:
+    static void rotate(double * QL_RESTRICT r0, double * QL_RESTRICT i0,
+                       double * QL_RESTRICT r1, double * QL_RESTRICT i1,
+                       size_t len, const double * m)
+    {
+        const double ar = m[0], ai = m[1], br = m[2], bi = m[3];
+        const double cr = m[4], ci = m[5], dr = m[6], di = m[7];
+        for (size_t i = 0; i < len; i++)
+        {
+            double xr = r0[i], xi = i0[i], yr = r1[i], yi = i1[i];
+            r0[i] = ar*xr - ai*xi + br*yr - bi*yi;
+            i0[i] = ar*xi + ai*xr + br*yi + bi*yr;
+            r1[i] = cr*xr - ci*xi + dr*yr - di*yi;
+            i1[i] = cr*xi + ci*xr + dr*yi + di*yr;
+        }
+    }
+
+    static void phase(double * QL_RESTRICT r, double * QL_RESTRICT m, size_t len, double c, double s)
+    {
+        for (size_t i = 0; i < len; i++)
+        {
+            double xr = r[i], xi = m[i];
+            r[i] = c*xr - s*xi;
+            m[i] = c*xi + s*xr;
+        }
+    }
+
+    /**
+     * the operands of a gate in ascending order, which must be distinct
+     */
+    static std::vector<size_t> sorted_bits(std::vector<size_t> qubits)
+    {
+        std::sort(qubits.begin(), qubits.end());
+        if (std::adjacent_find(qubits.begin(), qubits.end()) != qubits.end())
+        {
+            throw ql::exception("[x] error : ql::state_vector : gate operands must be distinct qubits !",false);
+        }
+        return qubits;
+    }
+
+    /**
+     * spread index k over the amplitude index with zeros at the given bits,
+     * which are in ascending order
+     */
+    static size_t insert_zeros(size_t k, const std::vector<size_t> & bits)
+    {
+        for (auto b : bits)
+        {
+            k = ((k >> b) << (b + 1)) | (k & ((size_t(1) << b) - 1));
+        }
+        return k;
+    }
+
+    /**
+     * call f(i0, len) for the runs of pair indices [lo, hi) of qubit q, where
+     * the amplitudes [i0, i0+len) have q equal to 0 and their partners are at
+     * i0 + 2^q; runs are contiguous so the loops in f vectorize
+     */
+    template<typename F>
+    static void for_each_run(size_t q, size_t lo, size_t hi, F f)
+    {
+        size_t stride = (size_t(1) << q);
+        for (size_t k = lo; k < hi; )
+        {
+            size_t offset = k & (stride - 1);
+            size_t len = std::min(stride - offset, hi - k);
+            f(((k >> q) << (q + 1)) | offset, len);
+            k += len;
+        }
+    }
+
+    template<typename F>
+    void for_each_pair(size_t q, F f)
+    {
+        parallel_for(size >> 1, [q, &f](size_t lo, size_t hi)
+        {
+            for_each_run(q, lo, hi, f);
+        });
+    }
+
+    /**
+     * call f(lo, hi) on the blocks of [0, n), one block per thread
+     */
+    template<typename F>
+    void parallel_for(size_t n, F f)
+    {
+        if (n < min_parallel || nthreads == 1)
+        {
+            f(0, n);
+            return;
+        }
+        std::vector<std::thread> threads;
+        size_t block = n / nthreads;
+        for (size_t t = 1; t < nthreads; t++)
+        {
+            size_t lo = t * block;
+            size_t hi = (t + 1 == nthreads ? n : lo + block);
+            threads.push_back(std::thread([&f, lo, hi]() { f(lo, hi); }));
+        }
+        f(0, block);
+        for (auto & t : threads)
+            t.join();
+    }
+
+    /**
+     * sum of f(lo, hi) over the blocks of [0, n), one block per thread
+     */
+    template<typename F>
+    double parallel_sum(size_t n, F f)
+    {
+        if (n < min_parallel || nthreads == 1)
+        {
+            return f(0, n);
+        }
+        std::vector<double> partial(nthreads, 0.0);
+        std::vector<std::thread> threads;
+        size_t block = n / nthreads;
+        for (size_t t = 1; t < nthreads; t++)
+        {
+            size_t lo = t * block;
+            size_t hi = (t + 1 == nthreads ? n : lo + block);
+            threads.push_back(std::thread([&f, &partial, t, lo, hi]() { partial[t] = f(lo, hi); }));
+        }
+        partial[0] = f(0, block);
+        for (auto & t : threads)
+            t.join();
+        double sum = 0.0;
+        for (auto x : partial)
+            sum += x;
+        return sum;
+    }
+};
+
+} // namespace ql
+
+#endif // QL_STATEVECTOR_H
@@ -0,0 +1,244 @@
+/**
+ * @file   topology.h
+ * @date   10/2018
+ * @brief  tables derived from the platform topology and edge resources
+ */
+
+#ifndef QL_TOPOLOGY_H
+#define QL_TOPOLOGY_H
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include <json.h>
+#include <utils.h>
+#include <exception.h>
+
+namespace ql
+{
+
+/**
+ * immutable tables derived once per platform from topology["edges"] and the
+ * "edges" and "detuned_qubits" resources; shared by the cc_light resources,
+ * the post-schedule decomposition and the mapper instead of re-parsing the
+ * json each time
+ */
+class topology_tables_t
+{
+public:
+    /**
+     * range over a row of a compressed sparse row table, usable in range-for
+     */
+    class range_t
+    {
+    public:
+        range_t(const size_t * b, const size_t * e) : b(b), e(e) {}
+        const size_t * begin() const { return b; }
+        const size_t * end() const { return e; }
+        size_t size() const { return e-b; }
+    private:
+        const size_t * b;
+        const size_t * e;
+    };
+
+    size_t qubit_count;                     // dimension of the qubit pair table
+    size_t edge_count;                      // edge ids are smaller than edge_count
+
+    topology_tables_t(const json & topology, const json & resources, size_t qubit_number)
+        : qubit_count(qubit_number), edge_count(0)
+    {
+        // dimension the tables after the largest qubit and edge found
+        bool has_edges = JSON_EXISTS(topology, "edges");
+        if (has_edges)
+        {
+            for(auto & anedge : topology["edges"])
+            {
+                size_t s = anedge["src"];
+                size_t d = anedge["dst"];
+                size_t e = anedge["id"];
+                qubit_count = std::max(qubit_count, std::max(s, d)+1);
+                edge_count = std::max(edge_count, e+1);
+            }
+        }
+        const json * edges_map = connection_map(resources, "edges");
+        const json * detuned_map = connection_map(resources, "detuned_qubits");
+        for (const json * cmap : { edges_map, detuned_map })
+        {
+            if (cmap == NULL)
+                continue;
+            for (auto it = cmap->begin(); it != cmap->end(); ++it)
+                edge_count = std::max(edge_count, (size_t)stoi(it.key())+1);
+        }
+        if (edges_map != NULL)
+        {
+            for (auto it = edges_map->begin(); it != edges_map->end(); ++it)
+                for (auto & e : it.value())
+                    edge_count = std::max(edge_count, (size_t)e+1);
+        }
+
+        // dense qubit pair to edge table
+        pair2edge.assign(qubit_count*qubit_count, -1);
+        if (has_edges)
+        {
+            for(auto & anedge : topology["edges"])
+            {
+                size_t s = anedge["src"];
+                size_t d = anedge["dst"];
+                size_t e = anedge["id"];
+                if (pair2edge[s*qubit_count+d] >= 0)
+                {
+                    FATAL("re-defining edge " << s <<"->" << d << " !");
+                }
+                pair2edge[s*qubit_count+d] = e;
+            }
+        }
+
+        // edge to edges: the connection_map of the edges resource lists per edge the
+        // edges it conflicts with, we store for each edge the edges that list it
+        std::vector<std::vector<size_t>> edge2edges(edge_count);
+        if (edges_map != NULL)
+        {
+            for (auto it = edges_map->begin(); it != edges_map->end(); ++it)
+            {
+                size_t edgeNo = stoi( it.key() );
+                for(auto & e : it.value())
+                    edge2edges[e].push_back(edgeNo);
+            }
+        }
+        to_csr(edge2edges, edge2edges_offset, edge2edges_list);
+
+        // edge to the qubits it detunes
+        std::vector<std::vector<size_t>> edge_detunes_qubits(edge_count);
+        if (detuned_map != NULL)
+        {
+            for (auto it = detuned_map->begin(); it != detuned_map->end(); ++it)
+            {
+                size_t edgeNo = stoi( it.key() );
+                for(auto & q : it.value())
+                    edge_detunes_qubits[edgeNo].push_back(q);
+            }
+        }
+        to_csr(edge_detunes_qubits, edge_detunes_offset, edge_detunes_list);
+
+        // qubit to the qubits it shares an edge with, in either direction
+        std::vector<std::vector<size_t>> qubit_neighbours(qubit_count);
+        for (size_t q0=0; q0<qubit_count; q0++)
+        {
+            for (size_t q1=0; q1<qubit_count; q1++)
+            {
+                if (q0 != q1 && (edge(q0, q1) >= 0 || edge(q1, q0) >= 0))
+                    qubit_neighbours[q0].push_back(q1);
+            }
+        }
+        to_csr(qubit_neighbours, neighbours_offset, neighbours_list);
+
+        // all pairs distances, by a breadth first search from each qubit
+        pair2distance.assign(qubit_count*qubit_count, qubit_count);
+        std::vector<size_t> queue;
+        for (size_t src=0; src<qubit_count; src++)
+        {
+            size_t * dist = &pair2distance[src*qubit_count];
+            dist[src] = 0;
+            queue.assign(1, src);
+            for (size_t i=0; i<queue.size(); i++)
+            {
+                for (auto n : neighbours(queue[i]))
+                {
+                    if (dist[n] == qubit_count)
+                    {
+                        dist[n] = dist[queue[i]]+1;
+                        queue.push_back(n);
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * edge from qubit q0 to qubit q1, -1 if there is none
+     */
+    int edge(size_t q0, size_t q1) const
+    {
+        if (q0 >= qubit_count || q1 >= qubit_count)
+            return -1;
+        return pair2edge[q0*qubit_count+q1];
+    }
+
+    /**
+     * edges that cannot be used while edge e is used
+     */
+    range_t edge2edges(size_t e) const
+    {
+        return row(edge2edges_offset, edge2edges_list, e);
+    }
+
+    /**
+     * qubits detuned by a two-qubit flux gate on edge e
+     */
+    range_t edge_detunes_qubits(size_t e) const
+    {
+        return row(edge_detunes_offset, edge_detunes_list, e);
+    }
+
+    /**
+     * qubits that share an edge with qubit q, in either direction
+     */
+    range_t neighbours(size_t q) const
+    {
+        if (q >= qubit_count)
+            return range_t(NULL, NULL);
+        return range_t(neighbours_list.data()+neighbours_offset[q], neighbours_list.data()+neighbours_offset[q+1]);
+    }
+
+    /**
+     * number of edges on a shortest path from qubit q0 to qubit q1, ignoring the
+     * direction of the edges; qubit_count when there is no such path
+     */
+    size_t distance(size_t q0, size_t q1) const
+    {
+        if (q0 >= qubit_count || q1 >= qubit_count)
+            return qubit_count;
+        return pair2distance[q0*qubit_count+q1];
+    }
+
+private:
+    std::vector<int> pair2edge;             // [q0*qubit_count+q1]: edge, -1 if none
+    std::vector<size_t> edge2edges_offset;  // csr: row e is [offset[e], offset[e+1])
+    std::vector<size_t> edge2edges_list;
+    std::vector<size_t> edge_detunes_offset;
+    std::vector<size_t> edge_detunes_list;
+    std::vector<size_t> neighbours_offset;  // csr: row q is [offset[q], offset[q+1])
+    std::vector<size_t> neighbours_list;
+    std::vector<size_t> pair2distance;      // [q0*qubit_count+q1]: distance, qubit_count if not connected
+
+    static const json * connection_map(const json & resources, std::string name)
+    {
+        if (JSON_EXISTS(resources, name) && JSON_EXISTS(resources[name], "connection_map"))
+            return &resources[name]["connection_map"];
+        return NULL;
+    }
+
+    static void to_csr(const std::vector<std::vector<size_t>> & rows,
+        std::vector<size_t> & offset, std::vector<size_t> & list)
+    {
+        offset.assign(1, 0);
+        list.clear();
+        for (auto & r : rows)
+        {
+            list.insert(list.end(), r.begin(), r.end());
+            offset.push_back(list.size());
+        }
+    }
+
+    range_t row(const std::vector<size_t> & offset, const std::vector<size_t> & list, size_t e) const
+    {
+        if (e >= edge_count)
+            return range_t(NULL, NULL);
+        return range_t(list.data()+offset[e], list.data()+offset[e+1]);
+    }
+};
+
+} // ql
+
+#endif // QL_TOPOLOGY_H
@@ -12,6 +12,7 @@
 %include "std_vector.i"
 %include "exception.i"
 %include "std_string.i"
+%include "stdint.i"
 
 namespace std {
    %template(vectori) vector<int>;
@@ -24,6 +25,46 @@ namespace std {
 #include "openql_i.h"
 %}
 
+/*
+ * one-dimensional C-contiguous arrays, such as NumPy arrays, passed as
+ * pointer and size through the buffer protocol, without copying them
+ */
+%define %buffer_typemap(TYPE, ITEMSIZE, FORMATS)
+%typemap(in) (const TYPE * IN_ARRAY, size_t IN_SIZE) (Py_buffer view, int has_view = 0)
+{
+    if (PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+    {
+        SWIG_exception_fail(SWIG_TypeError, "in method '$symname', argument $argnum does not support the buffer protocol");
+    }
+    has_view = 1;
+    const char * format = (view.format == NULL ? "B" : view.format);
+    if (*format == '<' || *format == '=' || *format == '@')
+    {
+        format++;
+    }
+    if (view.ndim != 1 || view.itemsize != ITEMSIZE || strlen(format) != 1 || strchr(FORMATS, *format) == NULL)
+    {
+        SWIG_exception_fail(SWIG_TypeError, "in method '$symname', argument $argnum must be a one-dimensional array of " #TYPE);
+    }
+    $1 = (const TYPE *) view.buf;
+    $2 = (size_t) view.shape[0];
+}
+%typemap(freearg) (const TYPE * IN_ARRAY, size_t IN_SIZE)
+{
+    if (has_view$argnum) PyBuffer_Release(&view$argnum);
+}
+%enddef
+
+%buffer_typemap(int64_t, 8, "lq")
+%buffer_typemap(double, 8, "d")
+
+%apply (const int64_t * IN_ARRAY, size_t IN_SIZE) {
+    (const int64_t * ids, size_t nids),
+    (const int64_t * q0, size_t nq0),
+    (const int64_t * q1, size_t nq1)
+};
+%apply (const double * IN_ARRAY, size_t IN_SIZE) { (const double * angles, size_t nangles) };
+
 
 /*
 %pythoncode %{
@@ -126,6 +167,18 @@ str
 
 """
 
+%feature("docstring") write_platform_image
+""" Precompiles a hardware configuration file into a binary platform image,
+written next to it with extension '.img'. With option 'use_platform_image'
+set to 'yes', a Platform is loaded from this image instead of from the json,
+as long as the json file is not modified.
+
+Parameters
+----------
+arg1 : str
+    name of the configuration file
+"""
+
 
 
 %feature("docstring") Platform
@@ -144,6 +197,21 @@ arg2 : str
 """
 
 
+%feature("docstring") Platform::loaded_from_image
+""" returns whether the platform was loaded from its platform image, see
+write_platform_image, instead of from the json configuration file.
+
+Parameters
+----------
+None
+
+Returns
+-------
+bool
+    True when loaded from the image
+"""
+
+
 %feature("docstring") Platform::get_qubit_number
 """ returns number of qubits in the platform.
 
@@ -435,6 +503,28 @@ The ids and the corresponding operations are:
 23: ['X90', 'Y90', 'mX90']
 """
 
+%feature("docstring") Kernel::randomized_benchmarking
+""" Adds a randomized benchmarking sequence: random cliffords on each of the
+qubits, followed by the recovery that returns them to their initial state.
+
+Parameters
+----------
+arg1 : []
+    list of qubits
+arg2 : int
+    number of random cliffords per qubit
+arg3 : []
+    optional flat list of qubit pairs, e.g. [0, 2, 1, 3]; a cz is applied on
+    each pair after every round of cliffords (interleaved RB). The recovery
+    is then computed on the stabilizer tableau of the sequence.
+arg4 : int
+    seed of the random number generator, default 0
+arg5 : bool
+    when True (default), the single qubit gates of a multi-qubit recovery are
+    merged into cliffords of native pulses, otherwise they are added as
+    hadamard, s, x and z gates
+"""
+
 %feature("docstring") Kernel::wait
 """ inserts explicit wait on specified qubits. wait with duration '0'
     is equivalent to barrier on specified list of qubits. If no qubits
@@ -518,6 +608,26 @@ arg3 : CReg
 
 
 
+%feature("docstring") Kernel::gates
+""" adds many gates to kernel in one call, reading the arrays in place.
+Gate i is names[ids[i]] on qubit q0[i] and, when q1[i] is not negative,
+qubit q1[i], with angle angles[i].
+
+Parameters
+----------
+arg1 : []
+    list of gate names
+arg2 : numpy.ndarray of int64
+    gate ids, indices in the list of gate names
+arg3 : numpy.ndarray of int64
+    first qubit of each gate
+arg4 : numpy.ndarray of int64
+    second qubit of each gate, -1 for single qubit gates
+arg5 : numpy.ndarray of float64
+    angle of each gate, used for rotations only
+"""
+
+
 %feature("docstring") Kernel::classical
 """ adds classical operation kernel.
 
@@ -39,6 +39,11 @@ void print_options()
     ql::options::print();
 }
 
+void write_platform_image(std::string config_file)
+{
+    ql::platform_image::write(config_file, ql::platform_image::image_file_name(config_file));
+}
+
 /**
  * quantum program interface
  */
@@ -47,17 +52,21 @@ class Platform
 public:
     std::string            name;
     std::string            config_file;
-    ql::quantum_platform * platform;
+    std::shared_ptr<const ql::quantum_platform> platform;
 
     Platform() {}
     Platform(std::string name, std::string config_file) : name(name), config_file(config_file)
     {
-        platform = new ql::quantum_platform(name, config_file);
+        platform = ql::quantum_platform::get(name, config_file);
     }
     size_t get_qubit_number()
     {
         return platform->get_qubit_number();
     }
+    bool loaded_from_image()
+    {
+        return platform->loaded_from_image;
+    }
 };
 
 class CReg
@@ -218,6 +227,11 @@ public:
     {
         kernel->clifford(id, q0);
     }
+    void randomized_benchmarking(std::vector<size_t> qubits, size_t num_cliffords,
+        std::vector<size_t> cz_qubits = std::vector<size_t>(), size_t seed=0, bool merge=true)
+    {
+        kernel->randomized_benchmarking(qubits, num_cliffords, cz_qubits, seed, merge);
+    }
     void wait(std::vector<size_t> qubits, size_t duration)
     {
         kernel->wait(qubits, duration);
@@ -246,6 +260,17 @@ public:
         kernel->gate(name, qubits, {(destination.creg)->id} );
     }
 
+    void gates(std::vector<std::string> names,
+        const int64_t * ids, size_t nids, const int64_t * q0, size_t nq0,
+        const int64_t * q1, size_t nq1, const double * angles, size_t nangles)
+    {
+        if (nq0 != nids || nq1 != nids || nangles != nids)
+        {
+            throw ql::exception("[x] error : Kernel.gates() : ids, q0, q1 and angles must have the same length !",false);
+        }
+        kernel->gates(names, nids, ids, q0, q1, angles);
+    }
+
     void classical(CReg & destination, Operation& operation)
     {
         kernel->classical(*(destination.creg), *(operation.operation));
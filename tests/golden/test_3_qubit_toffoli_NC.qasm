@@ -0,0 +1,65 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 3
+
+.aKernel
+    prepz q[0]
+    prepz q[1]
+    prepz q[2]
+    h q[2]
+    h q[2]
+    cz q[1],q[2]
+    h q[2]
+    tdag q[2]
+    h q[2]
+    cz q[0],q[2]
+    h q[2]
+    t q[2]
+    h q[2]
+    cz q[1],q[2]
+    h q[2]
+    tdag q[2]
+    h q[2]
+    cz q[0],q[2]
+    h q[2]
+    tdag q[1]
+    t q[2]
+    h q[1]
+    cz q[0],q[1]
+    h q[1]
+    h q[2]
+    tdag q[1]
+    h q[1]
+    cz q[0],q[1]
+    h q[1]
+    t q[0]
+    s q[1]
+    h q[1]
+    h q[1]
+    cz q[0],q[1]
+    h q[1]
+    tdag q[1]
+    h q[1]
+    cz q[2],q[1]
+    h q[1]
+    t q[1]
+    h q[1]
+    cz q[0],q[1]
+    h q[1]
+    tdag q[1]
+    h q[1]
+    cz q[2],q[1]
+    h q[1]
+    tdag q[0]
+    t q[1]
+    h q[0]
+    cz q[2],q[0]
+    h q[0]
+    h q[1]
+    tdag q[0]
+    h q[0]
+    cz q[2],q[0]
+    h q[0]
+    t q[2]
+    s q[0]
+    measure q[2]
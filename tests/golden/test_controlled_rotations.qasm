@@ -0,0 +1,22 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 3
+
+.kernel1
+    rx q[0], 0.785398
+    ry q[0], 0.785398
+    rz q[0], 0.785398
+
+.controlled_kernel1
+    rx q[0], 0.392699
+    cz q[1],q[0]
+    rx q[0], -0.392699
+    cz q[1],q[0]
+    ry q[0], 0.392699
+    cnot q[1],q[0]
+    ry q[0], -0.392699
+    cnot q[1],q[0]
+    rz q[0], 0.392699
+    cnot q[1],q[0]
+    rz q[0], -0.392699
+    cnot q[1],q[0]
@@ -0,0 +1,60 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 3
+
+.kernel1
+    x q[0]
+    y q[0]
+    z q[0]
+    h q[0]
+    i q[0]
+    s q[0]
+    t q[0]
+
+.controlled_kernel1
+    cnot q[1],q[0]
+    sdag q[0]
+    cnot q[1],q[0]
+    s q[0]
+    h q[0]
+    cnot q[1],q[0]
+    h q[0]
+    s q[0]
+    h q[0]
+    t q[0]
+    cnot q[1],q[0]
+    tdag q[0]
+    h q[0]
+    sdag q[0]
+    cnot q[0],q[1]
+    tdag q[1]
+    cnot q[0],q[1]
+    t q[1]
+    t q[0]
+    cnot q[1],q[0]
+    h q[2]
+    sdag q[1]
+    cnot q[0],q[2]
+    cnot q[2],q[1]
+    t q[1]
+    tdag q[2]
+    cnot q[0],q[1]
+    cnot q[0],q[2]
+    t q[1]
+    tdag q[2]
+    cnot q[2],q[1]
+    h q[1]
+    t q[1]
+    h q[1]
+    cnot q[2],q[1]
+    tdag q[1]
+    t q[2]
+    cnot q[0],q[2]
+    cnot q[0],q[1]
+    t q[2]
+    tdag q[1]
+    cnot q[2],q[1]
+    s q[1]
+    cnot q[0],q[2]
+    cnot q[1],q[0]
+    h q[2]
@@ -0,0 +1,12 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 7
+.aKernel
+
+    { x q[0] | park q[3] }
+    cz q[0],q[3]
+    wait 1
+    cnot q[5],q[3]
+    wait 3
+    park q[3]
+
@@ -0,0 +1,19 @@
+version 1.0
+# this file has been automatically generated by the OpenQL compiler please do not modify it manually.
+qubits 12
+
+.kernel1
+    x q[0]
+    cnot q[0],q[1]
+
+.controlled_kernel1
+    toffoli q[2],q[3],q[7]
+    toffoli q[4],q[7],q[8]
+    toffoli q[5],q[8],q[9]
+    toffoli q[6],q[9],q[10]
+    cnot q[10],q[0]
+    toffoli q[0],q[10],q[1]
+    toffoli q[6],q[9],q[10]
+    toffoli q[5],q[8],q[9]
+    toffoli q[4],q[7],q[8]
+    toffoli q[2],q[3],q[7]
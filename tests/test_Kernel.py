@@ -1,5 +1,6 @@
 import os
 import unittest
+import numpy as np
 from openql import openql as ql
 
 curdir = os.path.dirname(__file__)
@@ -111,6 +112,89 @@ class Test_kernel(unittest.TestCase):
 
         p.compile()
 
+    def test_bulk_gates(self):
+        nqubits = 3
+        names = ['x', 'cnot', 'rx', 'measure']
+        ids = np.array([0, 1, 2, 3, 1], dtype=np.int64)
+        q0 = np.array([0, 0, 2, 1, 1], dtype=np.int64)
+        q1 = np.array([-1, 1, -1, -1, 2], dtype=np.int64)
+        angles = np.array([0.0, 0.0, 0.5, 0.0, 0.0])
+
+        k1 = ql.Kernel("kernel1", platf, nqubits)
+        k1.x(0)
+        k1.cnot(0, 1)
+        k1.rx(2, 0.5)
+        k1.measure(1)
+        k1.cnot(1, 2)
+        p1 = ql.Program("bulk1", platf, nqubits)
+        p1.add_kernel(k1)
+
+        k2 = ql.Kernel("kernel1", platf, nqubits)
+        k2.gates(names, ids, q0, q1, angles)
+        p2 = ql.Program("bulk2", platf, nqubits)
+        p2.add_kernel(k2)
+
+        self.assertEqual(p1.qasm(), p2.qasm())
+        self.assertIn('rx q[2], 0.500000', p2.qasm())
+
+        # the angle is kept also by gate()
+        k3 = ql.Kernel("kernel1", platf, nqubits)
+        k3.gate("rx", [2], 0, 0.5)
+        p3 = ql.Program("bulk3", platf, nqubits)
+        p3.add_kernel(k3)
+        self.assertIn('rx q[2], 0.500000', p3.qasm())
+
+        # out of range qubit and mismatching lengths
+        with self.assertRaises(Exception):
+            k2.gates(names, ids, q0, np.array([-1, 1, -1, -1, 3], dtype=np.int64), angles)
+        with self.assertRaises(Exception):
+            k2.gates(names, ids, q0[:2], q1, angles)
+
+    def test_randomized_benchmarking(self):
+        nqubits = 3
+        programs = []
+        for name in ['rb1', 'rb2']:
+            k = ql.Kernel("kernel1", platf, nqubits)
+            k.randomized_benchmarking([0, 1, 2], 16, [0, 1], 5)
+            p = ql.Program(name, platf, nqubits)
+            p.add_kernel(k)
+            programs.append(p)
+
+        # same seed, same sequence
+        self.assertEqual(programs[0].qasm().replace('rb1', 'rb2'), programs[1].qasm())
+
+        # the sequence with its recovery is the identity: on the stabilizer
+        # backend it brings |000> back to |000>, and |+++> back to |+++>
+        stab_platf = ql.Platform('platform_stabilizer', os.path.join(curdir, 'test_cfg_stabilizer.json'))
+        ql.set_option('stabilizer_shots', '20')
+        try:
+            for merge in [True, False]:
+                for basis in ['z', 'x']:
+                    name = 'rb_identity_%s_%s' % (basis, 'merged' if merge else 'unmerged')
+                    k = ql.Kernel("kernel1", stab_platf, nqubits)
+                    for q in range(nqubits):
+                        if basis == 'x':
+                            k.gate('h', [q])
+                    k.randomized_benchmarking([0, 1, 2], 16, [0, 1, 1, 2], 7, merge)
+                    for q in range(nqubits):
+                        if basis == 'x':
+                            k.gate('h', [q])
+                        k.gate('measure', [q])
+                    p = ql.Program(name, stab_platf, nqubits)
+                    p.add_kernel(k)
+                    p.compile()
+                    with open(os.path.join(output_dir, name + '_stabilizer.txt')) as f:
+                        outcomes = [l.split()[0] for l in f if not l.startswith('#')]
+                    self.assertEqual(outcomes, ['000'], name)
+        finally:
+            ql.set_option('stabilizer_shots', '1')
+
+        k = ql.Kernel("kernel1", platf, nqubits)
+        with self.assertRaises(Exception):
+            k.randomized_benchmarking([0, 0], 4)
+        with self.assertRaises(Exception):
+            k.randomized_benchmarking([0, 1], 4, [0, 2])
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -1,4 +1,5 @@
 import os
+import shutil
 import unittest
 from openql import openql as ql
 
@@ -26,5 +27,67 @@ class Test_platform(unittest.TestCase):
         platf = ql.Platform(platf_name, config_fn)
         self.assertEqual(platf.config_file, config_fn)
 
+    def test_platform_cache(self):
+        if not os.path.exists(output_dir):
+            os.makedirs(output_dir)
+        config_fn = os.path.join(output_dir, 'hardware_config_cc_light_cache.json')
+        with open(os.path.join(curdir, 'hardware_config_cc_light.json')) as f:
+            config = f.read()
+        with open(config_fn, 'w') as f:
+            f.write(config)
+        platf = ql.Platform('seven_qubits_chip', config_fn)
+        self.assertEqual(platf.get_qubit_number(), 7)
+
+        # an edit within the same second that keeps the size of the file is seen
+        with open(config_fn, 'w') as f:
+            f.write(config.replace('"qubit_number": 7', '"qubit_number": 9'))
+        platf = ql.Platform('seven_qubits_chip', config_fn)
+        self.assertEqual(platf.get_qubit_number(), 9)
+
+    def test_platform_image(self):
+        if not os.path.exists(output_dir):
+            os.makedirs(output_dir)
+        config_fn = os.path.join(output_dir, 'hardware_config_cc_light_image.json')
+        shutil.copyfile(os.path.join(curdir, 'hardware_config_cc_light.json'), config_fn)
+        ql.write_platform_image(config_fn)
+        self.assertTrue(os.path.isfile(config_fn + '.img'))
+
+        ql.set_option('use_platform_image', 'yes')
+        try:
+            platf = ql.Platform('seven_qubits_chip', config_fn)
+            self.assertTrue(platf.loaded_from_image())
+            self.assertEqual(platf.get_qubit_number(), 7)
+
+            # an image that doesn't match its json anymore is ignored
+            with open(config_fn, 'a') as f:
+                f.write('\n')
+            platf = ql.Platform('seven_qubits_chip', config_fn)
+            self.assertFalse(platf.loaded_from_image())
+            self.assertEqual(platf.get_qubit_number(), 7)
+
+            # so is a corrupt image; the json is changed again to not get the platform from the cache
+            with open(config_fn, 'a') as f:
+                f.write('\n')
+            ql.write_platform_image(config_fn)
+            with open(config_fn + '.img', 'r+b') as f:
+                f.seek(32)
+                f.write(b'\xff' * 16)
+            platf = ql.Platform('seven_qubits_chip', config_fn)
+            self.assertFalse(platf.loaded_from_image())
+            self.assertEqual(platf.get_qubit_number(), 7)
+
+            # and an image of another version
+            with open(config_fn, 'a') as f:
+                f.write('\n')
+            ql.write_platform_image(config_fn)
+            with open(config_fn + '.img', 'r+b') as f:
+                f.seek(8)
+                f.write(b'\x02')
+            platf = ql.Platform('seven_qubits_chip', config_fn)
+            self.assertFalse(platf.loaded_from_image())
+            self.assertEqual(platf.get_qubit_number(), 7)
+        finally:
+            ql.set_option('use_platform_image', 'no')
+
 if __name__ == '__main__':
     unittest.main()
@@ -159,6 +159,27 @@ class Test_program(unittest.TestCase):
 
         p.compile()
 
+    def test_write_interaction_matrix(self):
+        # test_179.json has measure and prepz without qubits, so these can be given two
+        platf_179 = ql.Platform("starmon", os.path.join(curdir, 'test_179.json'))
+        nqubits = 2
+        k = ql.Kernel("interactions", platf_179, nqubits)
+        k.gate('cnot', [0, 1])
+        k.gate('cz', [0, 1])
+        k.gate('x', [0])
+        # only two-qubit unitary gates interact
+        k.gate('measure', [0, 1])
+        k.gate('prepz', [0, 1])
+
+        p = ql.Program("interaction_program", platf_179, nqubits)
+        p.add_kernel(k)
+        p.write_interaction_matrix()
+
+        fname = os.path.join(output_dir, 'interactionsInteractionMatrix.csv')
+        with open(fname) as f:
+            lines = f.read().splitlines()
+        self.assertEqual(lines, ['qubit0,qubit1,interactions', '0,1,2'])
+
 
 if __name__ == '__main__':
     unittest.main()
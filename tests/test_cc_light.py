@@ -1,4 +1,6 @@
 import os
+import re
+import json
 import unittest
 from openql import openql as ql
 from test_QISA_assembler_present import assemble
@@ -10,6 +12,30 @@ curdir = os.path.dirname(__file__)
 output_dir = os.path.join(curdir, 'test_output')
 
 
+def qisa_two_qubit_gates(qisa_fn):
+    """
+    The qubit pairs of the two-qubit gates in a cc-light qisa file, one for each
+    pair in the target register of each gate.
+    """
+    targets = {}
+    pairs = []
+    with open(qisa_fn) as f:
+        for line in f:
+            m = re.match(r'\s*smit (t\d+), \{(.*)\}', line)
+            if m:
+                targets[m.group(1)] = [(int(a), int(b)) for a, b in re.findall(r'\((\d+), (\d+)\)', m.group(2))]
+                continue
+            for t in re.findall(r'\b(t\d+)\b', line):
+                pairs.extend(targets[t])
+    return pairs
+
+
+def topology_edges(config_fn):
+    with open(config_fn) as f:
+        config = json.load(f)
+    return set((e['src'], e['dst']) for e in config['topology']['edges'])
+
+
 class Test_basic(unittest.TestCase):
 
     @classmethod
@@ -693,5 +719,237 @@ class Test_advance(unittest.TestCase):
         p.add_kernel(k)
         p.compile()
 
+    def test_compress_bundles(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+
+        p = ql.Program('test_compress_bundles', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+
+        k.gate('prepz', [0])
+        for i in range(100):
+            k.gate('x', [0])
+            k.gate('y', [0])
+        k.gate('measure', [0])
+
+        p.add_kernel(k)
+        ql.set_option('compress_bundles', 'yes')
+        p.compile()
+        ql.set_option('compress_bundles', 'no')
+
+        qisa_fn = os.path.join(output_dir, p.name+'.qisa')
+        with open(qisa_fn) as f:
+            qisa = f.read()
+        self.assertIn('aKernel_loop0:', qisa)
+        # x and y take 2 cycles each, a loop body lasts at least 8 cycles
+        self.assertEqual(qisa.count('x s0'), 2)
+
+    def test_compress_bundles_cregs(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+        num_cregs = 32
+
+        p = ql.Program('test_compress_bundles_cregs', platform, num_qubits, num_cregs)
+        k = ql.Kernel('aKernel', platform, num_qubits, num_cregs)
+
+        k.gate('prepz', [0])
+        for i in range(100):
+            k.gate('x', [0])
+            k.gate('y', [0])
+        k.gate('measure', [0])
+
+        p.add_kernel(k)
+        ql.set_option('compress_bundles', 'yes')
+        p.compile()
+        ql.set_option('compress_bundles', 'no')
+
+        # the loop registers r25-r27 would overwrite the cregs
+        qisa_fn = os.path.join(output_dir, p.name+'.qisa')
+        with open(qisa_fn) as f:
+            qisa = f.read()
+        self.assertNotIn('aKernel_loop0:', qisa)
+        self.assertEqual(qisa.count('x s0'), 100)
+
+    def test_compress_bundles_mov(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+        num_cregs = 10
+
+        p = ql.Program('test_compress_bundles_mov', platform, num_qubits, num_cregs)
+        k = ql.Kernel('aKernel', platform, num_qubits, num_cregs)
+        rd = ql.CReg()
+        rs = ql.CReg()
+
+        k.gate('prepz', [0])
+        for i in range(100):
+            k.gate('x', [0])
+            k.classical(rd, ql.Operation(rs))
+            k.gate('y', [0])
+        k.gate('measure', [0])
+
+        p.add_kernel(k)
+        ql.set_option('compress_bundles', 'yes')
+        p.compile()
+        ql.set_option('compress_bundles', 'no')
+
+        # the mov is decomposed using a temporary register,
+        # which must not be one of the registers of the loop
+        qisa_fn = os.path.join(output_dir, p.name+'.qisa')
+        with open(qisa_fn) as f:
+            qisa = f.read()
+        m = re.search(r'aKernel_loop0:\n(.*?)    cmp (r\d+), (r\d+)\n    nop\n    br lt, aKernel_loop0', qisa, re.S)
+        self.assertIsNotNone(m)
+        body, counter, bound = m.groups()
+        self.assertIn('    ldi %s, 50\n' % bound, qisa)
+        written = re.findall(r'^\s*(?:ldi|add) (r\d+),', body, re.M)
+        self.assertEqual(written.count(counter), 1)
+        self.assertNotIn(bound, written)
+        self.assertEqual(body.count('x s0'), 2)
+        self.assertEqual(body.count('add'), 3)
+
+    def test_scheduler_cross_kernel(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+
+        p = ql.Program('test_scheduler_cross_kernel', platform, num_qubits)
+        k1 = ql.Kernel('aKernel1', platform, num_qubits)
+        k1.gate('x', [0])
+        k1.gate('measure', [0])
+        k2 = ql.Kernel('aKernel2', platform, num_qubits)
+        k2.gate('x', [1])
+        k2.gate('measure', [1])
+
+        p.add_kernel(k1)
+        p.add_kernel(k2)
+        ql.set_option('scheduler_cross_kernel', 'yes')
+        p.compile()
+        ql.set_option('scheduler_cross_kernel', 'no')
+
+        qisa_fn = os.path.join(output_dir, p.name+'.qisa')
+        with open(qisa_fn) as f:
+            qisa = f.read()
+        self.assertIn('aKernel1:', qisa)
+        self.assertNotIn('aKernel2:', qisa)
+
+        # the x of aKernel2 does not wait for aKernel1 but runs in parallel with its x
+        rc_qasm_fn = os.path.join(output_dir, p.name+'_scheduled_rc.qasm')
+        with open(rc_qasm_fn) as f:
+            x_bundles = [line for line in f if 'x q[0]' in line]
+        self.assertEqual(len(x_bundles), 1)
+        self.assertIn('x q[1]', x_bundles[0])
+
+    def test_identical_kernels(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+
+        p = ql.Program('test_identical_kernels', platform, num_qubits)
+        for i in range(3):
+            k = ql.Kernel('aKernel'+str(i), platform, num_qubits)
+            k.gate('prepz', [0])
+            k.gate('x', [0])
+            k.gate('cz', [0, 2])
+            k.gate('measure', [0])
+            p.add_kernel(k)
+        k = ql.Kernel('bKernel', platform, num_qubits)
+        k.gate('prepz', [0])
+        k.gate('y', [0])
+        k.gate('measure', [0])
+        p.add_kernel(k)
+
+        # the log of the compilation says which kernels reuse a schedule
+        log_fn = os.path.join(output_dir, p.name+'.log')
+        stdout = os.dup(1)
+        with open(log_fn, 'w') as log:
+            os.dup2(log.fileno(), 1)
+            ql.set_option('log_level', 'LOG_DEBUG')
+            try:
+                p.compile()
+            finally:
+                ql.set_option('log_level', 'LOG_WARNING')
+                os.dup2(stdout, 1)
+                os.close(stdout)
+        with open(log_fn) as f:
+            reused = re.findall(r'reusing the bundles of an identical kernel for (\w+)', f.read())
+
+        # the three identical kernels are mapped and scheduled once
+        self.assertEqual(reused, ['aKernel1', 'aKernel2'])
+
+        qisa_fn = os.path.join(output_dir, p.name+'.qisa')
+        with open(qisa_fn) as f:
+            qisa = f.read()
+        qisa = qisa.split('br always')[0]
+        qisa = qisa.split('\nbKernel')[0]
+        bodies = [b.split(':', 1)[1].strip() for b in qisa.split('\naKernel')[1:]]
+        self.assertEqual(len(bodies), 3)
+        self.assertEqual(bodies[0], bodies[1])
+        self.assertEqual(bodies[0], bodies[2])
+
+    def test_mapper(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+
+        p = ql.Program('test_mapper', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+
+        # qubits 0 and 6 are not connected
+        k.gate('x', [0])
+        k.gate('cz', [0, 6])
+        k.gate('measure', [0])
+
+        p.add_kernel(k)
+        ql.set_option('mapper', 'yes')
+        p.compile()
+        ql.set_option('mapper', 'no')
+
+        QISA_fn = os.path.join(output_dir, p.name+'.qisa')
+        assemble(QISA_fn)
+
+        # besides the cz, the swaps there and back add two-qubit gates, all on edges of the topology
+        pairs = qisa_two_qubit_gates(QISA_fn)
+        self.assertGreater(len(pairs), 1)
+        edges = topology_edges(config_fn)
+        for pair in pairs:
+            self.assertIn(pair, edges)
+
+    def test_initial_placement(self):
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform  = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+
+        # qubits 0 and 6, and 1 and 5 are not connected
+        pairs = {}
+        for placement in ['yes', 'no']:
+            p = ql.Program('test_initial_placement_'+placement, platform, num_qubits)
+            k = ql.Kernel('aKernel', platform, num_qubits)
+
+            for i in range(10):
+                k.gate('cz', [0, 6])
+                k.gate('cz', [1, 5])
+            k.gate('measure', [0])
+
+            p.add_kernel(k)
+            ql.set_option('mapper', 'yes')
+            ql.set_option('initial_placement', placement)
+            p.compile()
+            ql.set_option('initial_placement', 'no')
+            ql.set_option('mapper', 'no')
+
+            QISA_fn = os.path.join(output_dir, p.name+'.qisa')
+            assemble(QISA_fn)
+            pairs[placement] = qisa_two_qubit_gates(QISA_fn)
+
+        # placing the interacting qubits on edges saves the swaps of the identity placement
+        self.assertEqual(len(pairs['yes']), 20)
+        self.assertGreater(len(pairs['no']), 20)
+        edges = topology_edges(config_fn)
+        for pair in pairs['yes']:
+            self.assertIn(pair, edges)
+
 if __name__ == '__main__':
     unittest.main()
@@ -1,4 +1,5 @@
 import os
+import json
 from utils import file_compare
 import unittest
 from openql import openql as ql
@@ -173,5 +174,89 @@ class Test_commutation(unittest.TestCase):
         qasm_fn = os.path.join(output_dir, p.name+'_scheduled.qasm')
         self.assertTrue( file_compare(qasm_fn, gold_fn) )
 
+    # the cnots on target 3 commute with each other but not with the czs on 3 before them,
+    # so all of them must wait for all czs, also when they are scheduled in a different order
+    def test_cz_cnot_groups(self):
+        config_fn = os.path.join(curdir, 'test_179.json')
+        platf = ql.Platform("starmon", config_fn)
+        ql.set_option("scheduler", 'ASAP');
+        ql.set_option("scheduler_post179", 'yes');
+        ql.set_option("scheduler_commute", 'yes');
+
+        nqubits = 7
+        k = ql.Kernel("aKernel", platf, nqubits)
+
+        k.gate("cz", [0,3]);
+        k.gate("cz", [1,3]);
+        k.gate("cz", [3,6]);
+        k.gate("cnot", [5,3]);
+        k.gate("cnot", [6,3]);
+        k.gate("cz", [3,0]);
+        k.gate("cz", [3,1]);
+
+        sweep_points = [2]
+
+        p = ql.Program("test_cz_cnot_groups", platf, nqubits)
+        p.set_sweep_points(sweep_points)
+        p.add_kernel(k)
+        p.compile()
+
+        gold_fn = rootDir + '/golden/'+ p.name + '_scheduled.qasm'
+        qasm_fn = os.path.join(output_dir, p.name+'_scheduled.qasm')
+        self.assertTrue( file_compare(qasm_fn, gold_fn) )
+
+    # "park q3" has "operand_access": [ "R" ] in test_179.json, so it commutes with the cz on 3 like a control
+    # and need not wait for it, but it does not commute with the cnot target on 3
+    def test_custom_operand_access(self):
+        config_fn = os.path.join(curdir, 'test_179.json')
+        platf = ql.Platform("starmon", config_fn)
+        ql.set_option("scheduler", 'ASAP');
+        ql.set_option("scheduler_post179", 'yes');
+        ql.set_option("scheduler_commute", 'yes');
+
+        nqubits = 7
+        k = ql.Kernel("aKernel", platf, nqubits)
+
+        k.gate("x", [0]);
+        k.gate("cz", [0,3]);
+        k.gate("park", [3]);
+        k.gate("cnot", [5,3]);
+        k.gate("park", [3]);
+
+        sweep_points = [2]
+
+        p = ql.Program("test_custom_operand_access", platf, nqubits)
+        p.set_sweep_points(sweep_points)
+        p.add_kernel(k)
+        p.compile()
+
+        gold_fn = rootDir + '/golden/'+ p.name + '_scheduled.qasm'
+        qasm_fn = os.path.join(output_dir, p.name+'_scheduled.qasm')
+        self.assertTrue( file_compare(qasm_fn, gold_fn) )
+
+    # an operand_access needs an access for each qubit of the instruction,
+    # so an instruction without "qubits" cannot have one
+    def test_custom_operand_access_length(self):
+        with open(os.path.join(curdir, 'test_179.json')) as f:
+            config = json.load(f)
+        park = config['instructions'].pop('park q3')
+        if not os.path.exists(output_dir):
+            os.makedirs(output_dir)
+        for name, qubits, access in [('park q3', ['q3'], ['R', 'R']),
+                                     ('park q3', ['q3'], []),
+                                     ('park', [], ['R'])]:
+            instr = dict(park, operand_access=access)
+            if qubits:
+                instr['qubits'] = qubits
+            else:
+                del instr['qubits']
+            config['instructions'][name] = instr
+            config_fn = os.path.join(output_dir, 'test_custom_operand_access_length.json')
+            with open(config_fn, 'w') as f:
+                json.dump(config, f)
+            with self.assertRaises(Exception):
+                ql.Platform("starmon", config_fn)
+            del config['instructions'][name]
+
 if __name__ == '__main__':
     unittest.main()
@@ -2,6 +2,7 @@ import os
 import unittest
 from openql import openql as ql
 import numpy as np
+from utils import file_compare
 
 rootDir = os.path.dirname(os.path.realpath(__file__))
 
@@ -15,6 +16,10 @@ ql.set_option('log_level', 'LOG_WARNING')
 
 class Test_controlled_kernel(unittest.TestCase):
 
+    def setUp(self):
+        ql.set_option('decompose_toffoli', 'no')
+        ql.set_option('write_qasm_files', 'yes')
+
     def test_controlled_single_qubit_gates(self):
         config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
         platform  = ql.Platform('platform_none', config_fn)
@@ -42,6 +47,10 @@ class Test_controlled_kernel(unittest.TestCase):
 
         p.compile()
 
+        gold_fn = rootDir + '/golden/' + p.name + '.qasm'
+        qasm_fn = os.path.join(output_dir, p.name + '.qasm')
+        self.assertTrue(file_compare(qasm_fn, gold_fn))
+
     def test_controlled_rotations(self):
         config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
         platform  = ql.Platform('platform_none', config_fn)
@@ -65,6 +74,10 @@ class Test_controlled_kernel(unittest.TestCase):
 
         p.compile()
 
+        gold_fn = rootDir + '/golden/' + p.name + '.qasm'
+        qasm_fn = os.path.join(output_dir, p.name + '.qasm')
+        self.assertTrue(file_compare(qasm_fn, gold_fn))
+
     def test_controlled_two_qubit_gates(self):
         config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
         platform  = ql.Platform('platform_none', config_fn)
@@ -86,6 +99,10 @@ class Test_controlled_kernel(unittest.TestCase):
 
         p.compile()
 
+        gold_fn = rootDir + '/golden/' + p.name + '.qasm'
+        qasm_fn = os.path.join(output_dir, p.name + '.qasm')
+        self.assertTrue(file_compare(qasm_fn, gold_fn))
+
     def test_multi_controlled(self):
         config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
         platform  = ql.Platform('platform_none', config_fn)
@@ -111,6 +128,10 @@ class Test_controlled_kernel(unittest.TestCase):
 
         p.compile()
 
+        gold_fn = rootDir + '/golden/' + p.name + '.qasm'
+        qasm_fn = os.path.join(output_dir, p.name + '.qasm')
+        self.assertTrue(file_compare(qasm_fn, gold_fn))
+
     def test_decompose_toffoli(self):
         config_fn = os.path.join(curdir, 'test_cfg_none_simple.json')
         platform  = ql.Platform('platform_none', config_fn)
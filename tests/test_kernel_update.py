@@ -0,0 +1,62 @@
+import os
+import unittest
+from openql import openql as ql
+
+curdir = os.path.dirname(__file__)
+output_dir = os.path.join(curdir, 'test_output')
+
+class Test_kernel_update(unittest.TestCase):
+
+    def setUp(self):
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('optimize', 'no')
+        ql.set_option('log_level', 'LOG_WARNING')
+        ql.set_option('scheduler_uniform', 'no')
+        ql.set_option('scheduler_post179', 'yes')
+        ql.set_option('write_qasm_files', 'yes')
+
+    def tearDown(self):
+        ql.set_option('scheduler', 'ALAP')
+        ql.set_option('scheduler_commute', 'no')
+
+    def add_gates(self, k, n):
+        for i in range(n):
+            k.gate("cnot", [3, 0])
+            k.gate("x", [1])
+            k.gate("cz", [3, 5])
+            k.gate("h", [0])
+            k.gate("cnot", [2, 0])
+            k.gate("measure", [5])
+
+    def compile(self, name, platf, k):
+        p = ql.Program(name, platf, 7)
+        p.add_kernel(k)
+        p.compile()
+        result = ''
+        for suffix in ['_scheduled.qasm', '_scheduled_rc.qasm', '.qisa']:
+            with open(os.path.join(output_dir, name + suffix)) as f:
+                result += f.read().replace(name, '')
+        return result
+
+    # a kernel that is compiled again after gates were added to it is scheduled
+    # on its extended dependence graph, with the same result as a new kernel
+    def test_extended_kernel(self):
+        config_fn = os.path.join(curdir, 'test_179.json')
+        platf = ql.Platform("starmon", config_fn)
+        for scheduler in ['ASAP', 'ALAP']:
+            for commute in ['no', 'yes']:
+                ql.set_option('scheduler', scheduler)
+                ql.set_option('scheduler_commute', commute)
+                k = ql.Kernel("aKernel", platf, 7)
+                self.add_gates(k, 10)
+                self.compile('test_kernel_update_first', platf, k)
+                self.add_gates(k, 10)
+                extended = self.compile('test_kernel_update_extended', platf, k)
+
+                knew = ql.Kernel("aKernel", platf, 7)
+                self.add_gates(knew, 20)
+                new = self.compile('test_kernel_update_new', platf, knew)
+                self.assertEqual(extended, new)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -41,7 +41,7 @@ class Test_options(unittest.TestCase):
         
         ql.set_option('decompose_toffoli', 'no')
         ql.set_option('decompose_toffoli', 'NC')
-        ql.set_option('decompose_toffoli', 'MA')
+        ql.set_option('decompose_toffoli', 'AM')
 
 
     def test_nok(self):
@@ -41,6 +41,54 @@ class Test_quantumsim(unittest.TestCase):
         # compile the program
         p.compile()
 
+    def test_loop(self):
+        config_fn = os.path.join(curdir, 'test_cfg_quantumsim.json')
+        platform = ql.Platform('platform_quantumsim', config_fn)
+        num_qubits = 2
+        p = ql.Program('aProgramLoop', platform, num_qubits)
+
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate("hadamard",[0])
+        k.gate("cphase", [0, 1])
+        k.gate("measure", [1])
+
+        # the kernel iterations should be emitted as a loop, not unrolled
+        p.add_for(k, 100)
+        p.compile()
+
+        qs_fn = os.path.join(output_dir, 'aProgramLoop_quantumsim.py')
+        with open(qs_fn) as f:
+            qs = f.read()
+        self.assertIn('for i in range(100):', qs)
+        self.assertEqual(qs.count('c.add_cphase('), 1)
+
+    def test_wait(self):
+        config_fn = os.path.join(curdir, 'test_cfg_quantumsim.json')
+        platform = ql.Platform('platform_quantumsim', config_fn)
+        num_qubits = 2
+        p = ql.Program('aProgramWait', platform, num_qubits)
+
+        k1 = ql.Kernel('first', platform, num_qubits)
+        k1.gate("hadamard",[0])
+        k1.wait([0, 1], 100)
+        k2 = ql.Kernel('idle', platform, num_qubits)
+        k2.wait([0, 1], 200)
+        k3 = ql.Kernel('last', platform, num_qubits)
+        k3.gate("hadamard",[1])
+
+        # the trailing wait of first and the iterations of idle take time
+        p.add_kernel(k1)
+        p.add_for(k2, 3)
+        p.add_kernel(k3)
+        p.compile()
+
+        qs_fn = os.path.join(output_dir, 'aProgramWait_quantumsim.py')
+        with open(qs_fn) as f:
+            qs = f.read()
+        self.assertIn('c.add_hadamard("q0", time=1)', qs)
+        # 1 cycle of hadamard, 5 of wait, 3 x 10 of idle
+        self.assertIn('c.add_hadamard("q1", time=37)', qs)
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -20,6 +20,7 @@ class Test_qubits(unittest.TestCase):
         ql.set_option('optimize', 'no')
         ql.set_option('scheduler', 'ALAP')
         ql.set_option('log_level', 'LOG_WARNING')
+        ql.set_option('write_qasm_files', 'yes')
 
     def test_1_qubit(self):
         nqubits = 1
@@ -91,6 +92,40 @@ class Test_qubits(unittest.TestCase):
         gold_fn = rootDir + '/golden/test_3_qubit.qasm'
         qasm_fn = os.path.join(output_dir, p.name+'.qasm')
         self.assertTrue( file_compare(qasm_fn, gold_fn) )
+    def test_3_qubit_toffoli_NC(self):
+        self.toffoli('NC')
+
+    def test_3_qubit_toffoli_AM(self):
+        self.toffoli('AM')
+
+    def toffoli(self, decomposition):
+        nqubits = 3
+        sweep_points = [2]
+
+        k = ql.Kernel("aKernel", platf, nqubits)
+
+        # populate kernel
+        k.prepz(0)
+        k.prepz(1)
+        k.prepz(2)
+        k.toffoli(0, 1, 2)
+        k.toffoli(2, 0, 1)
+        k.measure(2)
+
+        p = ql.Program("3_qubit_toffoli_" + decomposition, platf, nqubits)
+        p.set_sweep_points(sweep_points)
+
+        p.add_kernel(k)  # add kernel to program
+
+        ql.set_option('decompose_toffoli', decomposition)
+        try:
+            p.compile()
+        finally:
+            ql.set_option('decompose_toffoli', 'no')
+
+        gold_fn = rootDir + '/golden/test_3_qubit_toffoli_' + decomposition + '.qasm'
+        qasm_fn = os.path.join(output_dir, p.name+'.qasm')
+        self.assertTrue( file_compare(qasm_fn, gold_fn) )
 
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,110 @@
+import os
+import unittest
+from openql import openql as ql
+
+curdir = os.path.dirname(__file__)
+output_dir = os.path.join(curdir, 'test_output')
+
+class Test_scheduler_window(unittest.TestCase):
+
+    def setUp(self):
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('optimize', 'no')
+        ql.set_option('log_level', 'LOG_WARNING')
+        ql.set_option('scheduler', 'ASAP')
+        ql.set_option('scheduler_uniform', 'no')
+        ql.set_option('scheduler_post179', 'yes')
+        ql.set_option('scheduler_commute', 'yes')
+        ql.set_option('write_qasm_files', 'yes')
+
+    def tearDown(self):
+        ql.set_option('scheduler_window', '0')
+        ql.set_option('scheduler_post179', 'yes')
+        ql.set_option('scheduler_commute', 'no')
+
+    def schedule(self, name, window):
+        config_fn = os.path.join(curdir, 'test_179.json')
+        platf = ql.Platform("starmon", config_fn)
+        ql.set_option('scheduler_window', str(window))
+        nqubits = 7
+        k = ql.Kernel("aKernel", platf, nqubits)
+        for i in range(20):
+            k.gate("cnot", [3, 0])
+            k.gate("x", [1])
+            k.gate("cz", [3, 5])
+            k.gate("h", [0])
+            k.gate("cnot", [2, 0])
+            k.gate("measure", [5])
+        p = ql.Program(name, platf, nqubits)
+        p.add_kernel(k)
+        p.compile()
+        with open(os.path.join(output_dir, name + '_scheduled.qasm')) as f:
+            return f.read().replace(name, '')
+
+    # with a window holding the whole circuit, the streaming scheduler
+    # produces the same schedule as the one on the dependence graph
+    def test_window_equals_graph(self):
+        graph = self.schedule('test_scheduler_window_graph', 0)
+        window = self.schedule('test_scheduler_window_large', 1000)
+        self.assertEqual(graph, window)
+
+    # a smaller window may give a longer schedule, but of the same gates,
+    # and each gate starts after the gates it depends on have completed
+    def test_small_window(self):
+        graph = self.schedule('test_scheduler_window_graph', 0)
+        window = self.schedule('test_scheduler_window_small', 2)
+        graph_cycles = self.cycles(graph)
+        window_cycles = self.cycles(window)
+        self.assertEqual(sorted(graph_cycles.keys()), sorted(window_cycles.keys()))
+        self.assertGreaterEqual(max(max(c) for c in window_cycles.values()),
+                                max(max(c) for c in graph_cycles.values()))
+
+        # the gates of schedule() in circuit order, with their events on
+        # their qubits; Rs and Ds commute among themselves
+        durations = {'cnot': 4, 'x': 1, 'cz': 2, 'h': 2, 'measure': 16}
+        body = [('cnot q[3],q[0]', {3: 'R', 0: 'D'}),
+                ('x q[1]', {1: 'W'}),
+                ('cz q[3],q[5]', {3: 'R', 5: 'R'}),
+                ('h q[0]', {0: 'W'}),
+                ('cnot q[2],q[0]', {2: 'R', 0: 'D'}),
+                ('measure q[5]', {5: 'W'})]
+        gates = []
+        seen = {}
+        for i in range(20):
+            for g, events in body:
+                gates.append((g, seen.get(g, 0), events))
+                seen[g] = seen.get(g, 0) + 1
+        for i, (g1, n1, ev1) in enumerate(gates):
+            for g2, n2, ev2 in gates[i+1:]:
+                dependent = any(q in ev2 and (ev1[q] == 'W' or ev1[q] != ev2[q]) for q in ev1)
+                if dependent:
+                    start1 = window_cycles[g1][n1]
+                    start2 = window_cycles[g2][n2]
+                    self.assertGreaterEqual(start2, start1 + durations[g1.split()[0]],
+                        '%s scheduled before %s completed' % (g2, g1))
+
+    # the streaming scheduler has only the post179 dependences,
+    # without those the dependence graph is used
+    def test_window_pre179(self):
+        ql.set_option('scheduler_post179', 'no')
+        ql.set_option('scheduler_commute', 'no')
+        graph = self.schedule('test_scheduler_window_graph_pre179', 0)
+        window = self.schedule('test_scheduler_window_pre179', 2)
+        self.assertEqual(graph, window)
+
+    # the start cycles of each gate in the scheduled qasm, in schedule order
+    def cycles(self, qasm):
+        cycles = {}
+        cycle = 0
+        for line in qasm.splitlines():
+            line = line.strip()
+            if line.startswith('wait'):
+                cycle += int(line.split()[1])
+            elif line.startswith('{') or line.startswith(('cnot', 'x', 'cz', 'h', 'measure')):
+                cycle += 1
+                for g in line.strip('{}').split('|'):
+                    cycles.setdefault(g.strip(), []).append(cycle)
+        return cycles
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,95 @@
+import os
+import unittest
+from openql import openql as ql
+
+curdir = os.path.dirname(__file__)
+output_dir = os.path.join(curdir, 'test_output')
+
+class Test_stabilizer(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(self):
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('optimize', 'no')
+        ql.set_option('scheduler', 'ASAP')
+        ql.set_option('log_level', 'LOG_WARNING')
+        ql.set_option('stabilizer_shots', '100')
+
+    def histogram(self, prog_name):
+        fn = os.path.join(output_dir, prog_name + '_stabilizer.txt')
+        with open(fn) as f:
+            lines = [l.split() for l in f if not l.startswith('#')]
+        return { outcome: int(count) for outcome, count in lines }
+
+    def test_parity_check(self):
+        # ancilla q2 measures the z0.z1 parity of a bell pair, which is even
+        config_fn = os.path.join(curdir, 'test_cfg_stabilizer.json')
+        platform = ql.Platform('platform_stabilizer', config_fn)
+        num_qubits = 3
+        p = ql.Program('parity_check', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('h', [0])
+        k.gate('cnot', [0, 1])
+        k.gate('cnot', [0, 2])
+        k.gate('cnot', [1, 2])
+        k.gate('measure', [2])
+        k.gate('measure', [0])
+        k.gate('measure', [1])
+        p.add_kernel(k)
+        p.compile()
+
+        h = self.histogram('parity_check')
+        self.assertEqual(sorted(h.keys()), ['000', '011'])
+        self.assertEqual(sum(h.values()), 100)
+
+    def test_ghz(self):
+        config_fn = os.path.join(curdir, 'test_cfg_stabilizer.json')
+        platform = ql.Platform('platform_stabilizer', config_fn)
+        num_qubits = 200
+        p = ql.Program('ghz', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('h', [0])
+        for q in range(1, num_qubits):
+            k.gate('cnot', [q-1, q])
+        for q in range(num_qubits):
+            k.gate('measure', [q])
+        p.add_kernel(k)
+        p.compile()
+
+        h = self.histogram('ghz')
+        self.assertEqual(sorted(h.keys()), ['0'*num_qubits, '1'*num_qubits])
+
+    def test_reset_entangled(self):
+        # the reset of q0 collapses the bell pair, at random in each shot
+        config_fn = os.path.join(curdir, 'test_cfg_stabilizer.json')
+        platform = ql.Platform('platform_stabilizer', config_fn)
+        num_qubits = 2
+        p = ql.Program('reset_entangled', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('h', [0])
+        k.gate('cnot', [0, 1])
+        k.gate('prepz', [0])
+        k.gate('measure', [1])
+        p.add_kernel(k)
+        p.compile()
+
+        h = self.histogram('reset_entangled')
+        self.assertEqual(sorted(h.keys()), ['0', '1'])
+        self.assertEqual(sum(h.values()), 100)
+        self.assertGreater(h['0'], 25)
+        self.assertGreater(h['1'], 25)
+
+    def test_non_clifford(self):
+        config_fn = os.path.join(curdir, 'test_cfg_stabilizer.json')
+        platform = ql.Platform('platform_stabilizer', config_fn)
+        num_qubits = 1
+        p = ql.Program('non_clifford', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('t', [0])
+        p.add_kernel(k)
+        with self.assertRaises(Exception):
+            p.compile()
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,95 @@
+import os
+import unittest
+from openql import openql as ql
+
+curdir = os.path.dirname(__file__)
+output_dir = os.path.join(curdir, 'test_output')
+
+class Test_statevector(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(self):
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('optimize', 'no')
+        ql.set_option('scheduler', 'ASAP')
+        ql.set_option('log_level', 'LOG_WARNING')
+        ql.set_option('statevector_shots', '1000')
+
+    def histogram(self, prog_name):
+        fn = os.path.join(output_dir, prog_name + '_statevector.txt')
+        with open(fn) as f:
+            lines = [l.split() for l in f if not l.startswith('#')]
+        return { outcome: int(count) for outcome, count in lines }
+
+    def test_bell(self):
+        config_fn = os.path.join(curdir, 'test_cfg_statevector.json')
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 2
+        p = ql.Program('bell', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('h', [0])
+        k.gate('cnot', [0, 1])
+        k.gate('measure', [0])
+        k.gate('measure', [1])
+        p.add_kernel(k)
+        p.compile()
+
+        h = self.histogram('bell')
+        self.assertEqual(sorted(h.keys()), ['00', '11'])
+        self.assertEqual(sum(h.values()), 1000)
+
+    def test_measure_feedforward(self):
+        # q1 copies the outcome of the measurement of q0
+        config_fn = os.path.join(curdir, 'test_cfg_statevector.json')
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 2
+        p = ql.Program('measure_cnot', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('h', [0])
+        k.gate('measure', [0])
+        k.gate('cnot', [0, 1])
+        k.gate('measure', [1])
+        p.add_kernel(k)
+        p.compile()
+
+        h = self.histogram('measure_cnot')
+        self.assertEqual(sorted(h.keys()), ['00', '11'])
+
+    def test_loop(self):
+        config_fn = os.path.join(curdir, 'test_cfg_statevector.json')
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 1
+        p = ql.Program('loop', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('x', [0])
+        p.add_for(k, 3)
+        m = ql.Kernel('measure', platform, num_qubits)
+        m.gate('measure', [0])
+        p.add_kernel(m)
+        p.compile()
+
+        self.assertEqual(self.histogram('loop'), {'1': 1000})
+
+    def test_reset_entangled(self):
+        # the reset of q0 collapses the bell pair, at random in each shot
+        config_fn = os.path.join(curdir, 'test_cfg_statevector.json')
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 2
+        p = ql.Program('reset_entangled', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('h', [0])
+        k.gate('cnot', [0, 1])
+        k.gate('prepz', [0])
+        k.gate('measure', [1])
+        p.add_kernel(k)
+        p.compile()
+
+        h = self.histogram('reset_entangled')
+        self.assertEqual(sorted(h.keys()), ['0', '1'])
+        self.assertEqual(sum(h.values()), 1000)
+        self.assertGreater(h['0'], 400)
+        self.assertGreater(h['1'], 400)
+
+
+if __name__ == '__main__':
+    unittest.main()
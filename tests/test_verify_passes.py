@@ -0,0 +1,132 @@
+import os
+import json
+import unittest
+from openql import openql as ql
+
+curdir = os.path.dirname(__file__)
+output_dir = os.path.join(curdir, 'test_output')
+
+class Test_verify_passes(unittest.TestCase):
+
+    @classmethod
+    def setUpClass(self):
+        ql.set_option('output_dir', output_dir)
+        ql.set_option('log_level', 'LOG_WARNING')
+
+    def setUp(self):
+        ql.set_option('verify_passes', 'yes')
+
+    def tearDown(self):
+        ql.set_option('verify_passes', 'no')
+        ql.set_option('optimize', 'no')
+        ql.set_option('decompose_toffoli', 'no')
+
+    def test_decompose_toffoli(self):
+        config_fn = os.path.join(curdir, 'test_cfg_statevector.json')
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 3
+        p = ql.Program('verify_toffoli', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('prepz', [0])
+        k.gate('x', [0])
+        k.gate('h', [1])
+        k.gate('toffoli', [0, 1, 2])
+        k.gate('cz', [2, 0])
+        k.gate('measure', [2])
+        p.add_kernel(k)
+
+        ql.set_option('decompose_toffoli', 'NC')
+        p.compile()
+
+    def test_rotations_merging(self):
+        config_fn = os.path.join(curdir, 'test_cfg_statevector.json')
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 2
+        p = ql.Program('verify_optimize', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('x', [0])
+        k.gate('x', [0])
+        k.gate('ry', [1], 0, 0.3)
+        k.gate('measure', [1])
+        p.add_kernel(k)
+
+        ql.set_option('optimize', 'yes')
+        p.compile()
+
+    def test_rotations_merging_qubits(self):
+        config_fn = os.path.join(curdir, 'test_cfg_statevector.json')
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 2
+        p = ql.Program('verify_optimize_qubits', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        # gates on different qubits are not merged
+        k.gate('x', [0])
+        k.gate('x', [1])
+        k.gate('measure', [0])
+        k.gate('measure', [1])
+        p.add_kernel(k)
+
+        ql.set_option('optimize', 'yes')
+        p.compile()
+
+    def test_wrong_rewrite(self):
+        # the matrix of ry90 is wrong in this config, the optimizer takes
+        # two ry90 for an identity while they are an ry180
+        if not os.path.exists(output_dir):
+            os.makedirs(output_dir)
+        with open(os.path.join(curdir, 'test_cfg_statevector.json')) as f:
+            config = json.load(f)
+        config['instructions']['ry90'] = {
+            'duration': 20,
+            'latency': 0,
+            'qubits': [],
+            'matrix': [ [0.0,0.0], [1.0,0.0],
+                        [1.0,0.0], [0.0,0.0] ],
+            'disable_optimization': False,
+            'type': 'mw'
+        }
+        config_fn = os.path.join(output_dir, 'test_cfg_statevector_wrong.json')
+        with open(config_fn, 'w') as f:
+            json.dump(config, f)
+
+        platform = ql.Platform('platform_statevector', config_fn)
+        num_qubits = 1
+        p = ql.Program('verify_wrong_rewrite', platform, num_qubits)
+        k = ql.Kernel('aKernel', platform, num_qubits)
+        k.gate('ry90', [0])
+        k.gate('ry90', [0])
+        k.gate('measure', [0])
+        p.add_kernel(k)
+
+        ql.set_option('optimize', 'yes')
+        with self.assertRaises(Exception):
+            p.compile()
+
+    def test_cc_light(self):
+        # decompose_pre_schedule and decompose_post_schedule, the latter
+        # adds the sqf gates of the cz
+        config_fn = os.path.join(curdir, 'hardware_config_cc_light.json')
+        platform = ql.Platform('seven_qubits_chip', config_fn)
+        num_qubits = platform.get_qubit_number()
+        num_cregs = 10
+        p = ql.Program('verify_cc_light', platform, num_qubits, num_cregs)
+        k = ql.Kernel('aKernel', platform, num_qubits, num_cregs)
+        k.gate('prepz', [0])
+        k.gate('prepz', [2])
+        k.gate('x', [0])
+        k.gate('ry90', [2])
+        k.gate('cz', [2, 0])
+        k.gate('cnot', [0, 2])
+        k.gate('measure', [0], 0)
+        k.gate('measure', [2], 1)
+        p.add_kernel(k)
+
+        ql.set_option('cz_mode', 'auto')
+        try:
+            p.compile()
+        finally:
+            ql.set_option('cz_mode', 'manual')
+
+
+if __name__ == '__main__':
+    unittest.main()